@@ -0,0 +1,64 @@
+#pragma once
+
+#include <franka/model.h>
+
+#include <array>
+#include <cstddef>
+
+#include "thread_pool.h"
+
+/**
+ * Evaluates libfranka's model for many joint configurations at once, e.g.
+ * along a logged trajectory. The model library's functions are stateless,
+ * so configurations are split into chunks evaluated concurrently on the
+ * process-wide thread pool. Inputs are row-major with 7 columns, outputs
+ * are stacked row-major matrices rather than libfranka's column-major
+ * arrays.
+ */
+class BatchModel {
+ public:
+  /// Configurations evaluated per pool task
+  static constexpr size_t kChunkSize = 256;
+
+  /// @brief Load parameters as expected by libfranka's model
+  struct Load {
+    std::array<double, 9> I_total;
+    double m_total;
+    std::array<double, 3> F_x_Ctotal;
+  };
+
+  explicit BatchModel(const franka::Model &model,
+                      ThreadPool::Priority priority =
+                          ThreadPool::Priority::kNormal);
+
+  /// @brief 4x4 poses of `frame` for `n` joint configurations
+  void pose(franka::Frame frame, const double *q, size_t n,
+            const std::array<double, 16> &F_T_EE,
+            const std::array<double, 16> &EE_T_K, double *poses) const;
+  /// @brief 6x7 Jacobians of `frame` relative to the frame itself
+  void bodyJacobian(franka::Frame frame, const double *q, size_t n,
+                    const std::array<double, 16> &F_T_EE,
+                    const std::array<double, 16> &EE_T_K,
+                    double *jacobians) const;
+  /// @brief 6x7 Jacobians of `frame` relative to the base frame
+  void zeroJacobian(franka::Frame frame, const double *q, size_t n,
+                    const std::array<double, 16> &F_T_EE,
+                    const std::array<double, 16> &EE_T_K,
+                    double *jacobians) const;
+  /// @brief 7x7 joint space inertia matrices
+  void mass(const double *q, size_t n, const Load &load, double *mass) const;
+  /// @brief Coriolis and centrifugal torques
+  void coriolis(const double *q, const double *dq, size_t n, const Load &load,
+                double *coriolis) const;
+  void gravity(const double *q, size_t n, const Load &load,
+               const std::array<double, 3> &gravity_earth,
+               double *gravity) const;
+
+ private:
+  // Call f(i) for all configurations, chunked on the thread pool
+  template <typename Function>
+  void _forEach(size_t n, const Function &f) const;
+
+  const franka::Model &model_;
+  ThreadPool::Priority priority_;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+
+namespace controllers {
+
+/**
+ * Fixed-size QP solver for problems of the form
+ *
+ *   minimize 1/2 x'Px + q'x  subject to  l <= Ax <= u
+ *
+ * using the ADMM iteration of OSQP. The constraint matrix is passed as an
+ * operator providing `apply(x, Ax)` and `applyTranspose(y, A'y)`, so that
+ * structured constraints don't pay for dense products. The caller should
+ * scale the problem such that P and the rows of A are of order one. The
+ * step size rho is rebalanced from the residuals like in OSQP, which
+ * refactorizes the KKT matrix. All storage is fixed size, nothing is
+ * allocated by `setup` or `solve`. Primal and dual variables are kept
+ * between solves to warm-start the next one.
+ */
+template <int N, int M>
+class AdmmQP {
+ public:
+  typedef Eigen::Matrix<double, N, 1> VectorN;
+  typedef Eigen::Matrix<double, M, 1> VectorM;
+  typedef Eigen::Matrix<double, N, N> MatrixNN;
+
+  struct Settings {
+    double rho = 0.1;
+    // Rebalance rho from the residuals when they are this far apart
+    double adaptive_rho_tolerance = 5.0;
+    double sigma = 1e-6;
+    double alpha = 1.6;  // over-relaxation
+    double eps_abs = 1e-3;
+    double eps_rel = 1e-3;
+    int max_iterations = 50;
+    int check_interval = 5;  // iterations between convergence checks
+  };
+
+  AdmmQP() { reset(); }
+  explicit AdmmQP(const Settings &settings) : settings_(settings) { reset(); }
+
+  /// @brief Drop the warm start
+  void reset() {
+    rho_ = settings_.rho;
+    x_.setZero();
+    z_.setZero();
+    y_.setZero();
+  }
+
+  /** @brief Factorize P + sigma I + rho A'A, where `AtA` is A'A of the
+   *  constraint operator used to solve. */
+  void setup(const MatrixNN &P, const MatrixNN &AtA) {
+    P_ = P;
+    AtA_ = AtA;
+    _factorize();
+  }
+
+  /** @brief Solve with the factorized matrices for the given linear cost and
+   *  bounds. Returns the number of iterations, the last iterate is kept if
+   *  the tolerance wasn't reached. */
+  template <typename Operator>
+  int solve(const Operator &A, const VectorN &q, const VectorM &l,
+            const VectorM &u) {
+    // Bounds may have moved since the last solve
+    z_ = z_.cwiseMax(l).cwiseMin(u);
+
+    const double alpha = settings_.alpha;
+    VectorN rhs, x_tilde;
+    VectorM z_tilde, z_relaxed, z_next, w;
+    converged_ = false;
+    int iteration = 0;
+    while (iteration < settings_.max_iterations) {
+      iteration++;
+      const double rho = rho_;
+      w = rho * z_ - y_;
+      A.applyTranspose(w, rhs);
+      rhs += settings_.sigma * x_ - q;
+      x_tilde = llt_.solve(rhs);
+      A.apply(x_tilde, z_tilde);
+      x_ = alpha * x_tilde + (1.0 - alpha) * x_;
+      z_relaxed = alpha * z_tilde + (1.0 - alpha) * z_;
+      z_next = (z_relaxed + y_ / rho).cwiseMax(l).cwiseMin(u);
+      y_ += rho * (z_relaxed - z_next);
+      z_ = z_next;
+      if (iteration % settings_.check_interval == 0 && _converged(A, q)) {
+        converged_ = true;
+        break;
+      }
+    }
+    return iteration;
+  }
+
+  const VectorN &getSolution() const { return x_; }
+
+  bool isConverged() const { return converged_; }
+
+  Settings &getSettings() { return settings_; }
+
+ private:
+  template <typename Operator>
+  bool _converged(const Operator &A, const VectorN &q) {
+    VectorM Ax;
+    VectorN Aty;
+    A.apply(x_, Ax);
+    A.applyTranspose(y_, Aty);
+    const VectorN Px = P_ * x_;
+    const double primal = (Ax - z_).template lpNorm<Eigen::Infinity>();
+    const double dual = (Px + q + Aty).template lpNorm<Eigen::Infinity>();
+    const double primal_scale =
+        std::max(Ax.template lpNorm<Eigen::Infinity>(),
+                 z_.template lpNorm<Eigen::Infinity>());
+    const double dual_scale =
+        std::max({Px.template lpNorm<Eigen::Infinity>(),
+                  Aty.template lpNorm<Eigen::Infinity>(),
+                  q.template lpNorm<Eigen::Infinity>()});
+    if (primal <= settings_.eps_abs + settings_.eps_rel * primal_scale &&
+        dual <= settings_.eps_abs + settings_.eps_rel * dual_scale) {
+      return true;
+    }
+    // Balance the normalized residuals, the new rho is kept for the
+    // following solves
+    const double ratio = std::sqrt((primal / (primal_scale + 1e-10)) /
+                                   (dual / (dual_scale + 1e-10) + 1e-10));
+    const double tolerance = settings_.adaptive_rho_tolerance;
+    if (tolerance > 1.0 && (ratio > tolerance || ratio * tolerance < 1.0)) {
+      rho_ = std::min(std::max(rho_ * ratio, 1e-6), 1e6);
+      _factorize();
+    }
+    return false;
+  }
+
+  void _factorize() {
+    MatrixNN K = P_;
+    K.diagonal().array() += settings_.sigma;
+    K.noalias() += rho_ * AtA_;
+    llt_.compute(K);
+  }
+
+  Settings settings_;
+  double rho_;
+  MatrixNN P_, AtA_;
+  Eigen::LLT<MatrixNN> llt_;
+  VectorN x_;
+  VectorM z_, y_;
+  bool converged_ = false;
+};
+
+}  // namespace controllers
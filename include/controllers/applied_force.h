@@ -19,9 +19,9 @@ class AppliedForce : public TorqueController {
   void setDamping(const Vector7d &damping);
   void setFilter(const double filter_coeff);
   void start(const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override;
+             std::shared_ptr<RobotModel> model) override;
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override;
+            std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
 
@@ -31,7 +31,7 @@ class AppliedForce : public TorqueController {
   double filter_coeff_;
   std::mutex mux_;
   std::atomic<bool> motion_finished_;
-  std::shared_ptr<franka::Model> model_;
+  std::shared_ptr<RobotModel> model_;
 
   void _updateFilter();
 };
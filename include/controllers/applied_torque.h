@@ -19,9 +19,9 @@ class AppliedTorque : public TorqueController {
   void setDamping(const Vector7d &damping);
   void setFilter(const double filter_coeff);
   void start(const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override;
+             std::shared_ptr<RobotModel> model) override;
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override;
+            std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
 
@@ -1,13 +1,26 @@
 #pragma once
 #include <atomic>
 #include <mutex>
+#include <optional>
 
 #include "constants.h"
 #include "controllers/controller.h"
+#include "controllers/setpoint_buffer.h"
+#include "kinematics/manipulability.h"
 #include "utils.h"
 
 class CartesianImpedance : public TorqueController {
  public:
+  /// @brief Objective the nullspace term drives the joints towards
+  enum class NullspaceObjective {
+    /// Nullspace joint positions given with the control target
+    kPosture,
+    /** Ascent of the log-manipulability and the distance to the joint
+     *  limits, keeping the arm in configurations that permit high
+     *  Cartesian speeds */
+    kManipulability
+  };
+
   static const Eigen::Matrix<double, 6, 6> kDefaultImpedance;
   static const double kDefaultDampingRatio;
   static const double kDefaultNullspaceStiffness;
@@ -22,19 +35,34 @@ class CartesianImpedance : public TorqueController {
 
   franka::Torques step(const franka::RobotState &robot_state,
                        franka::Duration &duration) override;
+  /** @brief Set the pose and, if given, the nullspace joint positions.
+   *  Otherwise the nullspace target is kept. */
   void setControl(const Eigen::Vector3d &position,
                   const Eigen::Vector4d &orientation,
-                  const Vector7d &q_nullspace = kJointPositionStart);
+                  const std::optional<Vector7d> &q_nullspace = std::nullopt);
   void setImpedance(const Eigen::Matrix<double, 6, 6> &impedance);
   void setDampingRatio(const double &damping_ratio);
   void setNullspaceStiffness(const double &nullspace_stiffness);
+  void setNullspaceObjective(NullspaceObjective objective,
+                             double manipulability_weight = 1.0,
+                             double joint_limit_weight = 1.0);
+  /** @brief Damping of the nullspace projection once the manipulability
+   *  drops below `manipulability_threshold`, see
+   *  kinematics::dampedPseudoInverse(). A threshold of zero disables it. */
+  void setSingularityDamping(
+      double manipulability_threshold =
+          kinematics::kDefaultManipulabilityThreshold,
+      double max_damping = kinematics::kDefaultMaxDamping);
   void setFilter(const double filter_coeff);
   void start(const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override;
+             std::shared_ptr<RobotModel> model) override;
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override;
+            std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
+  void applySetpoint(const double *setpoint, size_t size) override;
+  bool acceptsSetpoint(size_t size) override;
+  std::shared_ptr<SetpointBuffer> getSetpointBuffer();
 
  private:
   Eigen::Matrix<double, 6, 6> K_p_, K_d_, K_p_target_, K_d_target_;
@@ -43,10 +71,19 @@ class CartesianImpedance : public TorqueController {
   Vector7d q_nullspace_d_, q_nullspace_d_target_;
   double filter_coeff_, nullspace_stiffness_, nullspace_stiffnes_target_,
       damping_ratio_;
+  NullspaceObjective nullspace_objective_ = NullspaceObjective::kPosture;
+  double manipulability_weight_ = 1.0, joint_limit_weight_ = 1.0;
+  double manipulability_threshold_ =
+      kinematics::kDefaultManipulabilityThreshold;
+  double max_damping_ = kinematics::kDefaultMaxDamping;
   std::mutex mux_;
+  std::shared_ptr<SetpointBuffer> setpoint_buffer_;
+  std::array<double, 14> setpoint_;
+  uint64_t setpoint_version_ = 0;
   std::atomic<bool> motion_finished_;
-  std::shared_ptr<franka::Model> model_;
+  std::shared_ptr<RobotModel> model_;
 
   void _updateFilter();
+  void _setSetpoint(const double *setpoint, size_t size);
   void _computeDamping();
 };
@@ -3,17 +3,25 @@
 
 #include <atomic>
 
+#include "robot_model.h"
+
 class TorqueController {
  public:
   virtual franka::Torques step(const franka::RobotState &robot_state,
                                franka::Duration &duration) = 0;
   virtual void start(const franka::RobotState &robot_state,
-                     std::shared_ptr<franka::Model> model) = 0;
+                     std::shared_ptr<RobotModel> model) = 0;
   virtual void stop(const franka::RobotState &robot_state,
-                    std::shared_ptr<franka::Model> model) = 0;
+                    std::shared_ptr<RobotModel> model) = 0;
   virtual bool isRunning() = 0;
   virtual const std::string name() = 0;
 
+  /** @brief Apply one row of a setpoint block streamed through a tick-group
+   *  context. Called from the control thread, the default ignores it. */
+  virtual void applySetpoint(const double *setpoint, size_t size) {}
+  /// @brief Whether setpoint rows of the given size are supported
+  virtual bool acceptsSetpoint(size_t size) { return false; }
+
   void setTime(double time) { time_ = time; }
 
   double getTime() { return time_; }
@@ -28,11 +28,14 @@ class Force : public TorqueController {
   void setDamping(const Vector7d &damping);
   void setFilter(const double &filter_coeff);
   void start(const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override;
+             std::shared_ptr<RobotModel> model) override;
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override;
+            std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
+  /// @brief Setpoint rows hold the desired force
+  void applySetpoint(const double *setpoint, size_t size) override;
+  bool acceptsSetpoint(size_t size) override;
 
  private:
   Vector7d tau_ext_init_, tau_error_integral_, K_d_, K_d_target_;
@@ -41,7 +44,7 @@ class Force : public TorqueController {
       threshold_target_;
   std::mutex mux_;
   std::atomic<bool> motion_finished_;
-  std::shared_ptr<franka::Model> model_;
+  std::shared_ptr<RobotModel> model_;
 
   void _updateFilter();
 };
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+
+#include "constants.h"
+#include "controllers/controller.h"
+#include "kinematics/manipulability.h"
+#include "utils.h"
+
+/**
+ * Hybrid force/impedance controller. A diagonal selection matrix splits the
+ * task space (base frame) into force controlled axes (1) and impedance
+ * controlled axes (0), fractional values blend both. The selection can be
+ * changed at runtime and ramps linearly for a bumpless transfer. Force axes use
+ * feedforward plus PI control on the wrench estimated from joint torques,
+ * the integrator is limited and stops integrating while the output saturates.
+ * Contact transitions happen inside the control loop: an armed transition
+ * switches the selection once the contact force is reached, and exceeding
+ * the displacement limit along force axes falls back to impedance control.
+ */
+class HybridForceImpedance : public TorqueController {
+ public:
+  static const Eigen::Matrix<double, 6, 6> kDefaultImpedance;
+  static const double kDefaultDampingRatio;
+  static const double kDefaultNullspaceStiffness;
+  static const double kDefaultProportionalGain;
+  static const double kDefaultIntegralGain;
+  static const Vector6d kDefaultForceDamping;
+  static const Vector6d kDefaultIntegralLimit;
+  static const Vector6d kDefaultWrenchLimit;
+  static const double kDefaultFilterCoeff;
+  static const double kDefaultSelectionRampTime;
+
+  HybridForceImpedance(
+      const Eigen::Matrix<double, 6, 6> &impedance = kDefaultImpedance,
+      const double &damping_ratio = kDefaultDampingRatio,
+      const double &nullspace_stiffness = kDefaultNullspaceStiffness,
+      const double &k_p = kDefaultProportionalGain,
+      const double &k_i = kDefaultIntegralGain,
+      const Vector6d &force_damping = kDefaultForceDamping,
+      const double &filter_coeff = kDefaultFilterCoeff);
+
+  franka::Torques step(const franka::RobotState &robot_state,
+                       franka::Duration &duration) override;
+  void setControl(const Eigen::Vector3d &position,
+                  const Eigen::Vector4d &orientation, const Vector6d &wrench,
+                  const Vector7d &q_nullspace = kJointPositionStart);
+  void setSelection(const Vector6d &selection);
+  void setFeedforward(const Vector6d &wrench);
+  void setImpedance(const Eigen::Matrix<double, 6, 6> &impedance);
+  void setDampingRatio(const double &damping_ratio);
+  void setNullspaceStiffness(const double &nullspace_stiffness);
+  void setForceGains(const double &k_p, const double &k_i);
+  void setForceDamping(const Vector6d &force_damping);
+  void setIntegralLimit(const Vector6d &limit);
+  void setWrenchLimit(const Vector6d &limit);
+  void setFilter(const double filter_coeff);
+  /** @brief Time in seconds the selection takes to ramp from 0 to 1, zero
+   *  switches immediately. */
+  void setSelectionRampTime(const double &duration);
+  /** @brief Damping of the wrench estimate and the nullspace projection once
+   *  the manipulability drops below `manipulability_threshold`, see
+   *  kinematics::dampedPseudoInverse(). Bounds the estimate close to
+   *  singularities but biases it towards smaller wrenches. A threshold of
+   *  zero disables it. */
+  void setSingularityDamping(
+      double manipulability_threshold =
+          kinematics::kDefaultManipulabilityThreshold,
+      double max_damping = kinematics::kDefaultMaxDamping);
+  /** @brief Arm a transition to `selection` once the measured force along
+   *  its translational axes exceeds `force`. A non-positive force disarms. */
+  void setContactTransition(const Vector6d &selection, const double &force);
+  /** @brief Fall back to impedance control if the end-effector moves further
+   *  than `distance` along force controlled axes. Zero disables. */
+  void setDisplacementLimit(const double &distance);
+  bool isInContact();
+  bool isLimitExceeded();
+  Vector6d getWrench();
+  Vector6d getSelection();
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override;
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override;
+  bool isRunning() override;
+  const std::string name() override;
+
+ private:
+  Eigen::Matrix<double, 6, 6> K_p_, K_d_, K_p_target_, K_d_target_;
+  Eigen::Vector3d position_d_, position_d_target_, position_anchor_;
+  Eigen::Quaterniond orientation_d_, orientation_d_target_;
+  Vector7d q_nullspace_d_, q_nullspace_d_target_, tau_ext_init_;
+  Vector6d S_, S_target_, F_d_, F_d_target_, F_ff_, F_ff_target_, D_f_,
+      D_f_target_, integral_, integral_limit_, wrench_limit_, wrench_,
+      contact_selection_;
+  double filter_coeff_, nullspace_stiffness_, nullspace_stiffness_target_,
+      damping_ratio_, k_p_, k_i_, k_p_target_, k_i_target_, contact_force_,
+      displacement_limit_, selection_ramp_time_;
+  double manipulability_threshold_ =
+      kinematics::kDefaultManipulabilityThreshold;
+  double max_damping_ = kinematics::kDefaultMaxDamping;
+  bool contact_armed_ = false;
+  std::atomic<bool> in_contact_, limit_exceeded_;
+  std::mutex mux_;
+  std::atomic<bool> motion_finished_;
+  std::shared_ptr<RobotModel> model_;
+
+  void _updateFilter();
+  void _updateSelection(double dt);
+  void _updateTransitions(const Eigen::Vector3d &position);
+  void _computeDamping();
+};
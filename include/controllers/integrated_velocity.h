@@ -20,8 +20,8 @@ class IntegratedVelocity : public TorqueController {
   void setControl(const Vector7d &velocity);
   void setStiffness(const Vector7d &stiffness);
   void setDamping(const Vector7d &damping);
-  void start(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) override;
-  void stop(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) override;
+  void start(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) override;
+  void stop(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
 
@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "constants.h"
+#include "controllers/admm_qp.h"
+#include "controllers/controller.h"
+#include "controllers/trajectory_follower.h"
+#include "utils.h"
+
+namespace controllers {
+
+/**
+ * Linear model-predictive joint tracking law. The arm is linearized at the
+ * current state (mass matrix and Coriolis torques frozen over the horizon),
+ * which makes each joint a double integrator driven by the joint
+ * accelerations. The horizon consists of `kBlocks` blocks of constant
+ * acceleration. Deviations from the previewed reference positions and
+ * velocities at the end of each block and from the reference accelerations
+ * are penalized, subject to the joint torque limits (including gravity) and
+ * the torque rate limit. The condensed QP has a fixed size and is solved
+ * with a warm-started ADMM iteration without allocations.
+ */
+class LinearJointMPC {
+ public:
+  static constexpr int kBlocks = 5;
+  static constexpr int kVariables = 7 * kBlocks;
+  static constexpr int kConstraints = 2 * kVariables;
+  static constexpr double kControlPeriod = 1e-3;
+
+  typedef std::array<Vector7d, kBlocks + 1> Preview;
+
+  /// @brief Solve times are binned in 10 µs steps up to 1 ms
+  static constexpr size_t kHistogramBins = 100;
+  static constexpr double kHistogramBinWidth = 1e-5;
+
+  struct SolveStats {
+    uint64_t count = 0, not_converged = 0;
+    double mean = 0.0, max = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0;
+    double mean_iterations = 0.0;
+  };
+
+  LinearJointMPC(double block_duration, double position_weight,
+                 double velocity_weight, double acceleration_weight,
+                 int max_iterations, double torque_margin);
+
+  /** @brief Joint torques to command, without gravity. `positions` and
+   *  `velocities` hold the reference at the start and the end of every
+   *  block. */
+  Vector7d compute(const Vector7d &q, const Vector7d &dq,
+                   const Eigen::Matrix<double, 7, 7> &mass,
+                   const Vector7d &coriolis, const Vector7d &gravity,
+                   const Vector7d &tau_previous, const Preview &positions,
+                   const Preview &velocities);
+
+  /// @brief Drop the warm start, e.g. when restarting
+  void reset();
+
+  double getBlockDuration() const { return block_duration_; }
+
+  SolveStats getSolveStats() const;
+  void resetSolveStats();
+
+ private:
+  void _record(double seconds, int iterations, bool converged);
+
+  double block_duration_, position_weight_, velocity_weight_,
+      acceleration_weight_, torque_margin_;
+  /** Torque bounds and torque changes between blocks, both are the mass
+   *  matrix applied to the block accelerations. Rows are normalized. */
+  struct Constraints {
+    Eigen::Matrix<double, 7, 7> mass;
+
+    void apply(const Eigen::Matrix<double, kVariables, 1> &x,
+               Eigen::Matrix<double, kConstraints, 1> &Ax) const;
+    void applyTranspose(const Eigen::Matrix<double, kConstraints, 1> &y,
+                        Eigen::Matrix<double, kVariables, 1> &Aty) const;
+  };
+
+  // Effect of the block accelerations on positions and velocities at the
+  // end of each block, and the resulting cost in block space
+  Eigen::Matrix<double, kBlocks, kBlocks> G_q_, G_v_, S_;
+  // Gram matrix of the torque change operator in block space
+  Eigen::Matrix<double, kBlocks, kBlocks> E_;
+  Eigen::Matrix<double, kVariables, kVariables> P_, AtA_;
+  double cost_scale_;
+  Constraints constraints_;
+  AdmmQP<kVariables, kConstraints> qp_;
+
+  std::array<std::atomic<uint64_t>, kHistogramBins + 1> histogram_;
+  std::atomic<uint64_t> count_{0}, not_converged_{0}, iterations_{0};
+  std::atomic<double> total_time_{0.0}, max_time_{0.0};
+};
+
+/**
+ * Tracks a joint trajectory with LinearJointMPC. Each tick the reference is
+ * previewed over the horizon and the first block of the optimized torques
+ * is applied.
+ */
+class JointTrajectoryMPC : public TorqueController {
+ public:
+  static const double kDefaultBlockDuration;
+  static const double kDefaultPositionWeight;
+  static const double kDefaultVelocityWeight;
+  static const double kDefaultAccelerationWeight;
+  static const int kDefaultMaxIterations;
+  static const double kDefaultTorqueMargin;
+
+  JointTrajectoryMPC(
+      std::shared_ptr<motion::JointTrajectory> trajectory,
+      const double block_duration = kDefaultBlockDuration,
+      const double position_weight = kDefaultPositionWeight,
+      const double velocity_weight = kDefaultVelocityWeight,
+      const double acceleration_weight = kDefaultAccelerationWeight,
+      const int max_iterations = kDefaultMaxIterations,
+      const double torque_margin = kDefaultTorqueMargin,
+      const double dq_threshold = 1e-3);
+
+  franka::Torques step(const franka::RobotState &robot_state,
+                       franka::Duration &duration) override;
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override;
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override;
+  bool isRunning() override;
+  const std::string name() override;
+
+  LinearJointMPC::SolveStats getSolveStats() const;
+  void resetSolveStats();
+
+ private:
+  JointTrajectorySource source_;
+  LinearJointMPC mpc_;
+  JointReference reference_;
+  LinearJointMPC::Preview positions_, velocities_;
+  std::shared_ptr<RobotModel> model_;
+  double dq_threshold_;
+  std::atomic<bool> motion_finished_{true};
+};
+
+}  // namespace controllers
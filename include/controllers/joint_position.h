@@ -3,6 +3,7 @@
 #include <mutex>
 
 #include "controllers/controller.h"
+#include "controllers/setpoint_buffer.h"
 #include "utils.h"
 
 class JointPosition : public TorqueController {
@@ -22,16 +23,23 @@ class JointPosition : public TorqueController {
   void setStiffness(const Vector7d &stiffness);
   void setDamping(const Vector7d &damping);
   void setFilter(const double filter_coeff);
-  void start(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) override;
-  void stop(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) override;
+  void start(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) override;
+  void stop(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) override;
   bool isRunning() override;
   const std::string name() override;
+  void applySetpoint(const double *setpoint, size_t size) override;
+  bool acceptsSetpoint(size_t size) override;
+  std::shared_ptr<SetpointBuffer> getSetpointBuffer();
 
  private:
   Vector7d K_p_, K_d_, q_d_, dq_d_, K_p_target_, K_d_target_, q_d_target_, dq_d_target_;
   double filter_coeff_;
   std::mutex mux_;
+  std::shared_ptr<SetpointBuffer> setpoint_buffer_;
+  std::array<double, 14> setpoint_;
+  uint64_t setpoint_version_ = 0;
   std::atomic<bool> motion_finished_;
 
   void _updateFilter();
+  void _setSetpoint(const double *setpoint, size_t size);
 };
@@ -1,5 +1,7 @@
 #pragma once
 #include "controllers/joint_position.h"
+#include "controllers/time_scaling.h"
+#include "controllers/trajectory_follower.h"
 #include "motion/generators.h"
 
 namespace controllers {
@@ -16,12 +18,29 @@ class JointTrajectory : public JointPosition {
 
   franka::Torques step(const franka::RobotState &robot_state,
                        franka::Duration &duration) override;
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override;
 
   const std::string name() override;
 
+  /** @brief Follow the clock of `time_scaling` instead of the controller
+   *  time, nullptr disables path following. Attach before starting. */
+  void setTimeScaling(std::shared_ptr<TimeScaling> time_scaling);
+  std::shared_ptr<TimeScaling> getTimeScaling();
+
+  /** @brief Blend `trajectory` into the end of the motion without stopping,
+   *  see JointTrajectorySource::queue. Returns the blend duration. */
+  double queue(std::shared_ptr<motion::JointTrajectory> trajectory);
+
  private:
-  std::shared_ptr<motion::JointTrajectory> traj_;
+  JointTrajectorySource source_;
+  JointReference reference_;
   double dq_threshold_;
+  std::atomic<bool> started_{false};
+  // Accessed from Python threads, use atomic_load/atomic_store
+  std::shared_ptr<TimeScaling> time_scaling_;
+  // Copy taken on start, only read by the control thread
+  std::shared_ptr<TimeScaling> active_time_scaling_;
 };
 
 } // namespace
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/**
+ * Controller-owned setpoint array that Python writes to directly. Python
+ * fills the staging array (exposed as a numpy view without copies) and
+ * calls `commit()`, which publishes it under a sequence counter. The
+ * control thread picks up new versions without locking and never blocks
+ * the writer, a torn read is simply retried on the next tick. Controllers
+ * seed the published values with `reset()` when they start, which leaves
+ * the staging array to Python.
+ */
+class SetpointBuffer {
+ public:
+  explicit SetpointBuffer(size_t size)
+      : size_(size),
+        staging_(new double[size]()),
+        shared_(new std::atomic<double>[size]) {
+    for (size_t i = 0; i < size_; i++) shared_[i].store(0.0);
+  }
+
+  size_t size() const { return size_; }
+
+  /// @brief Writable staging array, only touched by the Python thread
+  double *staging() { return staging_.get(); }
+
+  /// @brief Publish the staging array
+  void commit() { _publish(staging_.get()); }
+
+  /** @brief Publish `values` without touching the staging array, e.g. to
+   *  start from the current state */
+  void reset(const double *values) { _publish(values); }
+
+  /** @brief Control thread: copy the latest version into `out` if it is
+   *  newer than `version`. Returns false if there is nothing new or a
+   *  commit is in progress. */
+  bool read(double *out, uint64_t &version) const {
+    const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+    if (sequence == version || (sequence & 1)) return false;
+    for (size_t i = 0; i < size_; i++) {
+      out[i] = shared_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != sequence) return false;
+    version = sequence;
+    return true;
+  }
+
+  /// @brief Number of commits and resets so far
+  uint64_t getVersion() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  // Writers take turns by moving the sequence from even to odd, readers
+  // retry while it is odd
+  void _publish(const double *values) {
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    for (;;) {
+      if (sequence & 1) {
+        std::this_thread::yield();
+        sequence = sequence_.load(std::memory_order_relaxed);
+      } else if (sequence_.compare_exchange_weak(sequence, sequence + 1,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < size_; i++) {
+      shared_[i].store(values[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  const size_t size_;
+  std::unique_ptr<double[]> staging_;
+  std::unique_ptr<std::atomic<double>[]> shared_;
+  std::atomic<uint64_t> sequence_{0};
+};
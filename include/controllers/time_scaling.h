@@ -0,0 +1,81 @@
+#pragma once
+#include <franka/robot_state.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace controllers {
+
+/**
+ * Trajectory clock for path following. Instead of advancing with wall time,
+ * the trajectory time advances at a rate between `min_rate` and one. The
+ * rate drops smoothly while the tracking error or the estimated external
+ * torque exceed their thresholds, reaching `min_rate` at the limits, and
+ * recovers to nominal speed once they fall back. Rate changes are slew
+ * limited, slowing down is usually configured faster than recovering.
+ *
+ * Every update is recorded in a fixed-size ring buffer, so the time-warp
+ * profile of the last `log_size` ticks can be inspected afterwards. The
+ * buffer has a single writer and is read without locking, readers drop the
+ * samples overwritten while they copied.
+ */
+class TimeScaling {
+ public:
+  struct Sample {
+    double time, trajectory_time, rate, tracking_error, external_torque;
+  };
+
+  static const double kDefaultErrorThreshold;
+  static const double kDefaultErrorLimit;
+  static const double kDefaultTorqueThreshold;
+  static const double kDefaultTorqueLimit;
+  static const double kDefaultMinRate;
+  static const double kDefaultSlowdown;
+  static const double kDefaultRecovery;
+  static const size_t kDefaultLogSize;
+
+  TimeScaling(double error_threshold = kDefaultErrorThreshold,
+              double error_limit = kDefaultErrorLimit,
+              double torque_threshold = kDefaultTorqueThreshold,
+              double torque_limit = kDefaultTorqueLimit,
+              double min_rate = kDefaultMinRate,
+              double slowdown = kDefaultSlowdown,
+              double recovery = kDefaultRecovery,
+              size_t log_size = kDefaultLogSize);
+
+  /// @brief Restart the trajectory clock at nominal speed and clear the log
+  void start();
+
+  /** @brief Advance the trajectory clock to controller time `time` and
+   *  return the trajectory time. Called once per tick from the control
+   *  thread. */
+  double update(double time, double tracking_error, double external_torque);
+
+  double getRate() const { return rate_; }
+  /// @brief Derivative of the rate over the last update
+  double getRateDerivative() const { return rate_derivative_; }
+  double getTrajectoryTime() const { return trajectory_time_; }
+
+  /// @brief Logged samples, oldest first. Never blocks update().
+  std::vector<Sample> getLog() const;
+
+  /// @brief Largest magnitude of the filtered external joint torque estimate
+  static double externalTorque(const franka::RobotState &robot_state);
+
+ private:
+  double _target(double value, double threshold, double limit) const;
+
+  double error_threshold_, error_limit_, torque_threshold_, torque_limit_,
+      min_rate_, slowdown_, recovery_;
+  double last_time_ = 0.0;
+  std::atomic<double> rate_{1.0}, rate_derivative_{0.0},
+      trajectory_time_{0.0};
+
+  std::vector<Sample> log_;
+  // Number of samples ever written, and started, by update(). Samples
+  // logged before log_start_ belong to the previous run.
+  std::atomic<uint64_t> log_head_{0}, log_claim_{0}, log_start_{0};
+};
+
+}  // namespace controllers
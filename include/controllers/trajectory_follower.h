@@ -0,0 +1,305 @@
+#pragma once
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "constants.h"
+#include "controllers/controller.h"
+#include "controllers/time_scaling.h"
+#include "motion/generators.h"
+#include "utils.h"
+
+namespace controllers {
+
+struct JointReference {
+  Vector7d position, velocity, acceleration;
+};
+
+struct CartesianReference {
+  Eigen::Vector3d position;
+  Eigen::Quaterniond orientation;
+  Vector6d velocity, acceleration;  // twist and its derivative, base frame
+};
+
+/// @brief Largest joint position error in rad
+double trackingError(const JointReference &reference,
+                     const franka::RobotState &robot_state);
+/// @brief End effector position error in m
+double trackingError(const CartesianReference &reference,
+                     const franka::RobotState &robot_state);
+
+/**
+ * Trajectory source sampling compiled joint trajectories. Further
+ * trajectories can be queued while the source is evaluated, each one is
+ * blended into the end of the previous one by superposition: during the
+ * blend window the previous trajectory decelerates while the next one
+ * accelerates, so the motion continues without coming to rest.
+ */
+class JointTrajectorySource {
+ public:
+  using Reference = JointReference;
+
+  /// @brief Queued trajectories must start within this distance of the end
+  static const double kQueueTolerance;
+  /// @brief Blends start at least this long after the time passed to queue
+  static const double kQueueLatency;
+
+  explicit JointTrajectorySource(
+      std::shared_ptr<motion::JointTrajectory> trajectory);
+  JointTrajectorySource(const JointTrajectorySource &other);
+
+  void start();
+  double getDuration();
+  void evaluate(double time, Reference &reference);
+
+  /**
+   * @brief Append `trajectory`, which has to start where the queued motion
+   * ends. The blend window is the longest overlap that keeps the blended
+   * joint velocities and accelerations within the peaks of either
+   * trajectory and the positions within the joint limits. Only the last
+   * queued trajectory is blended, and blends don't start before `time` plus
+   * kQueueLatency, where `time` is the current trajectory time. Segments
+   * that ended before `time` are dropped, pass -inf before the source was
+   * evaluated and +inf once the whole schedule was executed, in which case
+   * `trajectory` replaces it and starts at time zero. Safe to call while the
+   * source is evaluated from the control thread. Returns the blend duration
+   * in seconds.
+   */
+  double queue(std::shared_ptr<motion::JointTrajectory> trajectory,
+               double time);
+
+ private:
+  struct Segment {
+    std::shared_ptr<motion::JointTrajectory> trajectory;
+    double start, duration, blend;
+    Vector7d origin;
+    // Resolved outside of the control loop, owned by `trajectory`
+    const motion::time_optimal::PiecewisePolynomial *compiled = nullptr;
+    size_t hint = 0;  // only touched by the control thread
+  };
+  typedef std::vector<std::shared_ptr<Segment>> Schedule;
+
+  static double _blendWindow(const Segment &previous,
+                             motion::JointTrajectory &next, double earliest);
+
+  // Raw pointer read by the control thread, owned by owner_. busy_ is set
+  // while the control thread evaluates, so queue() releases replaced
+  // schedules instead of the control thread.
+  std::atomic<const Schedule *> schedule_{nullptr};
+  std::atomic<bool> busy_{false};
+  std::atomic<double> duration_;
+  std::unique_ptr<const Schedule> owner_;
+  mutable std::mutex mux_;
+  // Only touched by the control thread
+  const Schedule *current_ = nullptr;
+  size_t first_ = 0;
+};
+
+/// @brief Trajectory source sampling a compiled Cartesian trajectory
+class CartesianTrajectorySource {
+ public:
+  using Reference = CartesianReference;
+
+  explicit CartesianTrajectorySource(
+      std::shared_ptr<motion::CartesianTrajectory> trajectory);
+
+  void start();
+  double getDuration() { return traj_->getDuration(); }
+  void evaluate(double time, Reference &reference);
+
+ private:
+  std::shared_ptr<motion::CartesianTrajectory> traj_;
+  // Resolved on start, owned by traj_
+  const motion::time_optimal::PiecewisePolynomial *compiled_ = nullptr;
+  size_t hint_ = 0;
+};
+
+/** @brief Joint space PD tracking law with velocity feedforward and optional
+ *  inverse dynamics feedforward of the reference acceleration. */
+class JointImpedanceLaw {
+ public:
+  using Reference = JointReference;
+
+  JointImpedanceLaw(const Vector7d &stiffness, const Vector7d &damping,
+                    bool feedforward = false);
+
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model);
+  Vector7d compute(const Reference &reference,
+                   const franka::RobotState &robot_state);
+
+ private:
+  Vector7d K_p_, K_d_;
+  bool feedforward_;
+  std::shared_ptr<RobotModel> model_;
+};
+
+/** @brief Cartesian impedance tracking law with twist feedforward in the
+ *  damping term and a nullspace term pulling towards `q_nullspace`. */
+class CartesianImpedanceLaw {
+ public:
+  using Reference = CartesianReference;
+
+  CartesianImpedanceLaw(const Eigen::Matrix<double, 6, 6> &impedance,
+                        double damping_ratio, double nullspace_stiffness,
+                        const Vector7d &q_nullspace);
+
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model);
+  Vector7d compute(const Reference &reference,
+                   const franka::RobotState &robot_state);
+
+ private:
+  Eigen::Matrix<double, 6, 6> K_p_, K_d_;
+  double nullspace_stiffness_;
+  Vector7d q_nullspace_;
+  std::shared_ptr<RobotModel> model_;
+};
+
+/**
+ * Generic trajectory follower. Each tick the trajectory source is evaluated
+ * once for position, velocity and acceleration and the reference is passed
+ * straight to the tracking law, there are no intermediate setpoints or
+ * locks. The reference is sampled at controller time plus time offset plus
+ * preview. The time offset shifts the trajectory as a whole (a negative
+ * offset delays the start), the preview only shifts the reference, e.g. to
+ * compensate for tracking lag, and doesn't affect when the motion finishes.
+ *
+ * With a TimeScaling attached, the trajectory time follows its clock instead
+ * of the controller time and the reference velocity and acceleration are
+ * scaled accordingly (path following).
+ */
+template <typename Source, typename Law>
+class TrajectoryFollower : public TorqueController {
+  static_assert(std::is_same<typename Source::Reference,
+                             typename Law::Reference>::value,
+                "Trajectory source and tracking law use different references.");
+
+ public:
+  using Reference = typename Source::Reference;
+
+  TrajectoryFollower(const Source &source, const Law &law,
+                     double dq_threshold = 1e-3, double time_offset = 0.0,
+                     double preview = 0.0)
+      : source_(source),
+        law_(law),
+        dq_threshold_(dq_threshold),
+        time_offset_(time_offset),
+        preview_(preview) {}
+
+  franka::Torques step(const franka::RobotState &robot_state,
+                       franka::Duration &duration) override {
+    double time = getTime();
+    TimeScaling *time_scaling = active_time_scaling_.get();
+    if (time_scaling) {
+      time = time_scaling->update(time, trackingError(reference_, robot_state),
+                                  TimeScaling::externalTorque(robot_state));
+    }
+    time += time_offset_;
+    source_.evaluate(time + preview_, reference_);
+    if (time_scaling) {
+      // d/dt f(s(t)) with ds/dt = rate
+      const double rate = time_scaling->getRate();
+      reference_.acceleration =
+          rate * rate * reference_.acceleration +
+          time_scaling->getRateDerivative() * reference_.velocity;
+      reference_.velocity *= rate;
+    }
+    franka::Torques torques =
+        VectorToArray(law_.compute(reference_, robot_state));
+    torques.motion_finished = motion_finished_;
+    if (time > source_.getDuration()) {
+      bool at_rest = true;
+      for (auto dq : robot_state.dq) {
+        if (std::abs(dq) > dq_threshold_) {
+          at_rest = false;
+        }
+      }
+      if (at_rest) {
+        torques.motion_finished = true;
+      }
+    }
+    return torques;
+  }
+
+  void start(const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override {
+    motion_finished_ = false;
+    started_ = true;
+    source_.start();
+    law_.start(robot_state, model);
+    // The control thread uses the clock attached at start, released here
+    // on the next start instead of on the control thread
+    active_time_scaling_ = std::atomic_load(&time_scaling_);
+    if (active_time_scaling_) {
+      active_time_scaling_->start();
+    }
+    source_.evaluate(time_offset_ + preview_, reference_);
+  }
+
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override {
+    motion_finished_ = true;
+  }
+
+  bool isRunning() override { return !motion_finished_; }
+
+  const std::string name() override { return "TrajectoryFollower"; }
+
+  void setTimeOffset(double time_offset) { time_offset_ = time_offset; }
+  double getTimeOffset() { return time_offset_; }
+  void setPreview(double preview) { preview_ = preview; }
+  double getPreview() { return preview_; }
+  double getDuration() { return source_.getDuration(); }
+  /** @brief Attach a trajectory clock, nullptr follows the controller time.
+   *  Attach before starting the controller, the clock restarts on start. */
+  void setTimeScaling(std::shared_ptr<TimeScaling> time_scaling) {
+    std::atomic_store(&time_scaling_, time_scaling);
+  }
+  std::shared_ptr<TimeScaling> getTimeScaling() {
+    return std::atomic_load(&time_scaling_);
+  }
+
+  /** @brief Queue `trajectory` to be blended into the end of the current
+   *  motion, see JointTrajectorySource::queue. Only available for sources
+   *  that support queueing. Returns the blend duration. */
+  template <typename Trajectory>
+  double queue(std::shared_ptr<Trajectory> trajectory) {
+    // Before the controller runs, the whole schedule is still ahead, once it
+    // finished the whole schedule was executed
+    double time = started_ ? std::numeric_limits<double>::infinity()
+                           : -std::numeric_limits<double>::infinity();
+    if (!motion_finished_) {
+      time = getTime();
+      if (active_time_scaling_) {
+        time = active_time_scaling_->getTrajectoryTime();
+      }
+      time += time_offset_;
+    }
+    return source_.queue(trajectory, time);
+  }
+
+ private:
+  Source source_;
+  Law law_;
+  Reference reference_;
+  double dq_threshold_;
+  std::atomic<double> time_offset_, preview_;
+  std::atomic<bool> motion_finished_{true};
+  std::atomic<bool> started_{false};
+  // Accessed from Python threads, use atomic_load/atomic_store
+  std::shared_ptr<TimeScaling> time_scaling_;
+  // Copy taken on start, only read by the control thread
+  std::shared_ptr<TimeScaling> active_time_scaling_;
+};
+
+typedef TrajectoryFollower<JointTrajectorySource, JointImpedanceLaw>
+    JointTrajectoryFollower;
+typedef TrajectoryFollower<CartesianTrajectorySource, CartesianImpedanceLaw>
+    CartesianTrajectoryFollower;
+
+}  // namespace controllers
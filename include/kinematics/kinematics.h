@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstddef>
+
+#include "kinematics/ik.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+namespace kinematics {
+
+/// @brief Settings of Kinematics::ikPath()
+struct PathIkSettings {
+  /// Spacing of the q7 values searched by dynamic programming
+  double q7_resolution = 0.1;
+  /// Largest change of q7 between consecutive poses
+  double max_q7_step = 0.2;
+  /** Largest change of any joint between consecutive poses, rejects jumps
+   *  between solution branches */
+  double max_joint_step = 0.5;
+  /// Distance all joints keep from their limits
+  double limit_margin = 0.05;
+  /// Weight of the distance to the joint limits against path smoothness
+  double limit_weight = 1.0;
+  /// Gauss-Newton iterations refining q7 between the grid values
+  size_t refinement_iterations = 10;
+};
+
+/**
+ * Forward and inverse kinematics of the arm with a tool mounted on the
+ * flange. The tool transform is combined with the Franka Hand frame that
+ * fk() and ik() are derived for once on construction, so each call costs a
+ * single extra 4x4 product. Batched variants evaluate many configurations
+ * or poses on the process-wide thread pool.
+ */
+class Kinematics {
+ public:
+  /// Flange to Franka Hand TCP, libfranka's default end effector
+  static const Eigen::Matrix4d kFrankaHand;
+
+  explicit Kinematics(const Eigen::Matrix4d &F_T_EE = kFrankaHand);
+
+  /// @brief Transform from the flange to the tool frame
+  const Eigen::Matrix4d &getTransform() const { return F_T_EE_; }
+
+  /// @brief Pose of the tool frame in the base frame
+  Eigen::Matrix4d fk(const Vector7d &q) const;
+  /** @brief Joint positions placing the tool frame at `O_T_EE`, consistent
+   *  with `q_init`. NaN if there is no solution. */
+  Vector7d ik(const Eigen::Matrix4d &O_T_EE, const Vector7d &q_init = kQDefault,
+              double q7 = M_PI_4) const;
+  /// @brief All four solutions placing the tool frame at `O_T_EE`
+  Eigen::Matrix<double, 4, 7> ikFull(const Eigen::Matrix4d &O_T_EE,
+                                     const Vector7d &q_init = kQDefault,
+                                     double q7 = M_PI_4) const;
+
+  /** @brief fk() of `n` row-major configurations (n x 7), writes row-major
+   *  4x4 poses */
+  void fk(const double *q, size_t n, double *poses,
+          ThreadPool::Priority priority = ThreadPool::Priority::kNormal) const;
+  /** @brief ik() of `n` row-major 4x4 poses, writes row-major joint
+   *  positions (n x 7). `q_init` holds one or `n` rows, `q7` one or `n`
+   *  values, selected by `per_pose_init` and `per_pose_q7`. */
+  void ik(const double *poses, size_t n, const double *q_init,
+          bool per_pose_init, const double *q7, bool per_pose_q7, double *q,
+          ThreadPool::Priority priority = ThreadPool::Priority::kNormal) const;
+  /**
+   * @brief Joint path through `n` row-major 4x4 poses, writes row-major
+   * joint positions (n x 7). Instead of a fixed q7, the q7 profile is
+   * optimized over the whole path: ik() is evaluated on a grid of q7 values
+   * for all poses in parallel, dynamic programming selects the profile
+   * minimizing the mean of `limit_weight` times the normalized squared
+   * distance from the center of the joint ranges plus |dq/ds|^2, with `s`
+   * running from 0 to 1 along the path, and local refinement resolves q7
+   * below the grid spacing. The squared distance of the first solution
+   * from `q_init`, which also selects the solution branch like in ik(), is
+   * added to the cost. Throws std::runtime_error if no path within the
+   * limits exists.
+   */
+  void ikPath(const double *poses, size_t n, const Vector7d &q_init,
+              const PathIkSettings &settings, double *q,
+              ThreadPool::Priority priority =
+                  ThreadPool::Priority::kNormal) const;
+
+ private:
+  // Configurations evaluated per pool task
+  static constexpr size_t kChunkSize = 256;
+
+  Eigen::Matrix4d F_T_EE_;
+  // From the frame fk() computes to the tool
+  Eigen::Matrix4d fk_T_EE_;
+  // From the tool to the frame ik() expects
+  Eigen::Matrix4d EE_T_ik_;
+};
+
+}  // namespace kinematics
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/Dense"
+#include "constants.h"
+#include "utils.h"
+
+namespace kinematics {
+
+/// @brief Yoshikawa's manipulability sqrt(det(J J^T)) of a 6x7 Jacobian
+inline double manipulability(const Eigen::Matrix<double, 6, 7> &jacobian) {
+  return std::sqrt(
+      std::max((jacobian * jacobian.transpose()).determinant(), 0.0));
+}
+
+/**
+ * @brief Gradient of the log-manipulability with respect to the joint
+ * positions. Since all joints are revolute, the derivatives of the
+ * Jacobian's columns follow from cross products of the columns of the
+ * geometric Jacobian (angular part w, linear part v):
+ *
+ *   dJ_j/dq_i = [w_i x v_j; w_i x w_j]  for i <= j
+ *   dJ_j/dq_i = [w_j x v_i; 0]          for i > j
+ *
+ * and d ln(w)/dq_i = trace((J J^T)^-1 dJ/dq_i J^T). Fixed size without
+ * allocations, zero at singularities.
+ */
+inline Vector7d manipulabilityGradient(
+    const Eigen::Matrix<double, 6, 7> &jacobian) {
+  const Eigen::LDLT<Eigen::Matrix<double, 6, 6>> ldlt(jacobian *
+                                                      jacobian.transpose());
+  if (ldlt.info() != Eigen::Success || !(ldlt.vectorD().minCoeff() > 1e-12)) {
+    return Vector7d::Zero();
+  }
+  // trace(A dJ/dq_i J^T) = sum_j (A J)_j . dJ_j/dq_i
+  const Eigen::Matrix<double, 6, 7> weights = ldlt.solve(jacobian);
+  Vector7d gradient;
+  for (int i = 0; i < 7; i++) {
+    const Eigen::Vector3d v_i = jacobian.block<3, 1>(0, i);
+    const Eigen::Vector3d w_i = jacobian.block<3, 1>(3, i);
+    double sum = 0.0;
+    for (int j = 0; j < 7; j++) {
+      const Eigen::Vector3d v_j = jacobian.block<3, 1>(0, j);
+      const Eigen::Vector3d w_j = jacobian.block<3, 1>(3, j);
+      if (i <= j) {
+        sum += weights.block<3, 1>(0, j).dot(w_i.cross(v_j)) +
+               weights.block<3, 1>(3, j).dot(w_i.cross(w_j));
+      } else {
+        sum += weights.block<3, 1>(0, j).dot(w_j.cross(v_i));
+      }
+    }
+    gradient[i] = sum;
+  }
+  return gradient;
+}
+
+/**
+ * @brief Component of the joint space vector `v` in the nullspace of the
+ * Jacobian, (I - J^+ J) v. Slightly regularized to stay bounded close to
+ * singularities.
+ */
+inline Vector7d nullspaceComponent(const Eigen::Matrix<double, 6, 7> &jacobian,
+                                   const Vector7d &v) {
+  const Eigen::Matrix<double, 6, 6> regularized =
+      jacobian * jacobian.transpose() +
+      1e-6 * Eigen::Matrix<double, 6, 6>::Identity();
+  return v - jacobian.transpose() * regularized.ldlt().solve(jacobian * v);
+}
+
+/// Manipulability below which dampedPseudoInverse() starts damping
+constexpr double kDefaultManipulabilityThreshold = 0.05;
+/// Damping of dampedPseudoInverse() at an exact singularity
+constexpr double kDefaultMaxDamping = 0.2;
+
+/**
+ * @brief Damped least-squares inverse J^T (J J^T + lambda^2 I)^-1 of a 6x7
+ * Jacobian, with damping that only switches on close to singularities:
+ *
+ *   lambda^2 = max_damping^2 (1 - w / manipulability_threshold)^2
+ *
+ * for a manipulability w below the threshold, zero otherwise. Away from
+ * singularities the inverse is exact, close to them the singular
+ * directions are attenuated by sigma^2 / (sigma^2 + lambda^2) instead of
+ * amplified. Evaluated on the eigen-decomposition of J J^T, fixed size and
+ * allocation free.
+ *
+ * @return The damping lambda applied.
+ */
+inline double dampedPseudoInverse(const Eigen::Matrix<double, 6, 7> &jacobian,
+                                  Eigen::Matrix<double, 7, 6> &inverse,
+                                  double manipulability_threshold =
+                                      kDefaultManipulabilityThreshold,
+                                  double max_damping = kDefaultMaxDamping) {
+  const Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>> solver(
+      jacobian * jacobian.transpose());
+  // Squared singular values of the Jacobian
+  const Vector6d sigma2 = solver.eigenvalues().cwiseMax(0.0);
+  const double w = std::sqrt(sigma2.prod());
+  double damping = 0.0;
+  if (w < manipulability_threshold) {
+    damping = max_damping * (1.0 - w / manipulability_threshold);
+  }
+  Vector6d scale;
+  for (int i = 0; i < 6; i++) {
+    const double denominator = sigma2[i] + damping * damping;
+    scale[i] = denominator > 1e-12 ? 1.0 / denominator : 0.0;
+  }
+  const Eigen::Matrix<double, 6, 6> &U = solver.eigenvectors();
+  inverse = jacobian.transpose() * (U * scale.asDiagonal() * U.transpose());
+  return damping;
+}
+
+/**
+ * @brief Gradient of the joint-limit distance -1/2 sum(((q - q_mid) /
+ * (q_range / 2))^2), which is zero at the center of the joint ranges and
+ * -1/2 per joint at its limits.
+ */
+inline Vector7d jointLimitGradient(const Vector7d &q) {
+  const Vector7d center = 0.5 * (kUpperJointLimits + kLowerJointLimits);
+  const Vector7d range = kUpperJointLimits - kLowerJointLimits;
+  return -4.0 * (q - center).cwiseQuotient(range.cwiseAbs2());
+}
+
+}  // namespace kinematics
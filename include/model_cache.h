@@ -0,0 +1,77 @@
+#pragma once
+
+#include <franka/model.h>
+#include <franka/robot.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+/**
+ * Process-wide cache of robot models. Loading a model downloads the model
+ * library from the controller, which dominates the connection time. Loaded
+ * models are shared by all Panda instances connected to the same robot
+ * running the same server version. libfranka can't restore a model from a
+ * serialized form, models are therefore only kept within the process.
+ */
+class ModelCache {
+ public:
+  /** @brief Identifies a model. libfranka doesn't report the robot's serial
+   *  number, the robot is identified by its hostname instead. */
+  struct Key {
+    std::string robot;
+    uint16_t server_version;
+
+    bool operator<(const Key &other) const {
+      return std::tie(robot, server_version) <
+             std::tie(other.robot, other.server_version);
+    }
+  };
+
+  /// @brief Where a model came from
+  enum class Source { kRobot, kMemory };
+
+  /// @brief Loads the model of a connected robot
+  using Loader = std::function<std::shared_ptr<franka::Model>(franka::Robot &)>;
+
+  struct Stats {
+    size_t loads = 0, memory_hits = 0;
+  };
+
+  /// @brief The shared cache instance, created on first use
+  static ModelCache &instance();
+
+  /// @brief Loads models over the robot's network connection
+  static Loader defaultLoader();
+
+  /** @brief Get the model for `key`, loading it from `robot` if it isn't
+   *  cached. Stores where the model came from in `source`, if given. */
+  std::shared_ptr<franka::Model> get(franka::Robot &robot, const Key &key,
+                                     Source *source = nullptr);
+
+  /** @brief Replace the loader, e.g. with a stand-in for testing. An empty
+   *  loader restores the default one. Cached models are kept. */
+  void setLoader(const Loader &loader);
+  /// @brief Enable or disable sharing models within the process
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+  /// @brief Drop all models cached in memory
+  void clear();
+  Stats getStats() const;
+
+ private:
+  ModelCache();
+
+  // Serializes loads without blocking the accessors, loaders may need the
+  // GIL held by a thread calling them
+  std::mutex load_mux_;
+  mutable std::mutex mux_;
+  Loader loader_;
+  bool enabled_ = true;
+  std::map<Key, std::shared_ptr<franka::Model>> models_;
+  Stats stats_;
+};
@@ -1,21 +1,27 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <Eigen/Geometry>
 
 #include <franka/duration.h>
+#include <franka/model.h>
 #include <franka/robot_state.h>
 
 #include <ruckig/ruckig.hpp>
 
+#include "kinematics/manipulability.h"
 #include "motion/cartesian_motion.hpp"
 #include "motion/generator.h"
 #include "motion/motion_data.hpp"
@@ -23,8 +29,24 @@
 
 namespace motion {
 
+/**
+ * Moves the end-effector through Cartesian waypoints. The Cartesian limits
+ * are scaled down depending on the configuration, such that the profile
+ * maps to joint velocities, accelerations and jerks within the joint limits
+ * through the Jacobian. The profile is planned per coordinate, the scale also
+ * keeps the norms of its translational and rotational rates within
+ * libfranka's Cartesian limits. Moves run at full speed where the arm allows
+ * it and slow down close to singularities.
+ */
 struct CartesianMotionGenerator : public CartesianGenerator {
 
+  // Fraction of the joint limits the scaled profile may use
+  static constexpr double kJointLimitMargin = 0.9;
+  // Larger scales are only applied after increasing by this fraction, to
+  // avoid replanning every cycle
+  static constexpr double kScaleHysteresis = 0.1;
+  static constexpr double kMinScale = 0.05;
+
   // run base class
   CartesianMotionGenerator(bool keep_running = true,
                            std::function<void()> done_callback = nullptr)
@@ -44,6 +66,42 @@ struct CartesianMotionGenerator : public CartesianGenerator {
     reload_ = true;
   }
 
+  /** @brief Append `count` waypoints from a row-major pose array in one
+   *  pass. Rows hold either a 4x4 homogeneous transform (`row_size` 16) or
+   *  a position followed by a quaternion in x, y, z, w order (`row_size`
+   *  7). Each scale points to one value per row or is null for the default
+   *  of 1. */
+  void addWaypoints(const double *poses, size_t count, size_t row_size,
+                    ReferenceFrame reference_frame = ReferenceFrame::GLOBAL,
+                    const double *velocity_rel = nullptr,
+                    const double *acceleration_rel = nullptr,
+                    const double *jerk_rel = nullptr) {
+    if (row_size != 16 && row_size != 7) {
+      throw std::invalid_argument(
+          "Poses must be 4x4 transforms or positions with quaternions.");
+    }
+    std::scoped_lock lock(mux_);
+    for (size_t i = 0; i < count; i++) {
+      const double *row = poses + row_size * i;
+      Eigen::Isometry3d target;
+      if (row_size == 16) {
+        target.matrix() =
+            Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(row);
+      } else {
+        target.translation() = Eigen::Map<const Eigen::Vector3d>(row);
+        target.linear() = Eigen::Quaterniond(row[6], row[3], row[4], row[5])
+                              .normalized()
+                              .toRotationMatrix();
+      }
+      CartesianMotion waypoint(target, reference_frame);
+      if (velocity_rel) waypoint.velocity_rel = velocity_rel[i];
+      if (acceleration_rel) waypoint.acceleration_rel = acceleration_rel[i];
+      if (jerk_rel) waypoint.jerk_rel = jerk_rel[i];
+      waypoints_.push(waypoint);
+    }
+    reload_ = true;
+  }
+
   void clearWaypoints() {
     std::scoped_lock lock(mux_);
     while (!waypoints_.empty()) {
@@ -53,8 +111,9 @@ struct CartesianMotionGenerator : public CartesianGenerator {
   }
 
   void start(Panda *robot, const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override {
+             std::shared_ptr<RobotModel> model) override {
     panda_ = robot;
+    model_ = model;
     reload_ = true;
     motion_finished_ = false;
     motion_finishing_ = false;
@@ -82,7 +141,7 @@ struct CartesianMotionGenerator : public CartesianGenerator {
   }
 
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override {
+            std::shared_ptr<RobotModel> model) override {
     motion_finishing_ = true;
   }
 
@@ -97,6 +156,7 @@ struct CartesianMotionGenerator : public CartesianGenerator {
       reload_ = false;
       loadNextWaypoint(robot_state);
     }
+    updateScale(robot_state);
     result = trajectory_generator_.update(input_para_, output_para_);
     output_para_.pass_to_input(input_para_);
 
@@ -114,6 +174,9 @@ struct CartesianMotionGenerator : public CartesianGenerator {
 
   bool isRunning() { return !motion_finished_; }
 
+  /// @brief Current scale of the Cartesian velocity limits, in (0, 1]
+  double getSpeedScale() { return scale_; }
+
   const std::string name() { return "Joint Motion Generator"; }
 
 private:
@@ -127,6 +190,10 @@ private:
   ruckig::InputParameter<7> input_para_;
   ruckig::OutputParameter<7> output_para_;
   ruckig::Result result;
+  std::shared_ptr<RobotModel> model_;
+  std::array<double, 7> nominal_velocity_, nominal_acceleration_,
+      nominal_jerk_;
+  std::atomic<double> scale_{1.0};
   bool reload_ = false;
   bool keep_running_ = true;
   const size_t cooldown_iterations{5};
@@ -134,32 +201,99 @@ private:
 
   void setProfile(double velocity_rel, double acceleration_rel,
                   double jerk_rel) {
-    auto translation_factor = 0.4;
-    auto derivative_factor = 0.4;
     for (int dof = 0; dof < 3; dof += 1) {
-      input_para_.max_velocity[dof] = 0.8 * translation_factor *
-                                      Panda::max_translation_velocity *
-                                      panda_->velocity_rel * velocity_rel;
-      input_para_.max_acceleration[dof] =
-          0.3 * translation_factor * derivative_factor *
-          Panda::max_translation_acceleration * panda_->acceleration_rel *
-          acceleration_rel;
-      input_para_.max_jerk[dof] = 0.3 * translation_factor * derivative_factor *
-                                  Panda::max_translation_jerk *
-                                  panda_->jerk_rel * jerk_rel;
+      nominal_velocity_[dof] = Panda::max_translation_velocity *
+                               panda_->velocity_rel * velocity_rel;
+      nominal_acceleration_[dof] = 0.3 * Panda::max_translation_acceleration *
+                                   panda_->acceleration_rel * acceleration_rel;
+      nominal_jerk_[dof] =
+          0.3 * Panda::max_translation_jerk * panda_->jerk_rel * jerk_rel;
     }
     auto quat_factor =
         0.5; // dq/dt = 0.5*w*q (w: angular velocity, q: quaternion)
     for (int dof = 3; dof < 3 + 4; dof += 1) {
-      input_para_.max_velocity[dof] = quat_factor *
-                                      Panda::max_rotation_velocity *
-                                      panda_->velocity_rel * velocity_rel;
-      input_para_.max_acceleration[dof] =
+      nominal_velocity_[dof] = quat_factor * Panda::max_rotation_velocity *
+                               panda_->velocity_rel * velocity_rel;
+      nominal_acceleration_[dof] =
           quat_factor * 0.3 * Panda::max_rotation_acceleration *
           panda_->acceleration_rel * acceleration_rel;
-      input_para_.max_jerk[dof] = quat_factor * 0.3 * Panda::max_rotation_jerk *
-                                  panda_->jerk_rel * jerk_rel;
+      nominal_jerk_[dof] = quat_factor * 0.3 * Panda::max_rotation_jerk *
+                           panda_->jerk_rel * jerk_rel;
+    }
+    setScale(1.0);
+  }
+
+  // Scaling the velocity by s and acceleration and jerk by s² and s³ keeps
+  // the shape of the profile, like slowing down time
+  void setScale(double scale) {
+    for (int dof = 0; dof < 7; dof += 1) {
+      input_para_.max_velocity[dof] = scale * nominal_velocity_[dof];
+      input_para_.max_acceleration[dof] =
+          scale * scale * nominal_acceleration_[dof];
+      input_para_.max_jerk[dof] = scale * scale * scale * nominal_jerk_[dof];
+    }
+    scale_ = scale;
+  }
+
+  void updateScale(const franka::RobotState &robot_state) {
+    Vector7d delta;
+    for (int dof = 0; dof < 7; dof += 1) {
+      delta[dof] =
+          input_para_.target_position[dof] - input_para_.current_position[dof];
     }
+    // Close to the target the direction is meaningless, keep the limits
+    if (!model_ || delta.norm() < 1e-6)
+      return;
+
+    const std::array<double, 42> jacobian_array =
+        model_->zeroJacobian(franka::Frame::kEndEffector, robot_state);
+    const Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(
+        jacobian_array.data());
+    // Undamped, the robot's inverse kinematics follow the pose exactly
+    Eigen::Matrix<double, 7, 6> jacobian_pinv;
+    kinematics::dampedPseudoInverse(jacobian, jacobian_pinv, 0.0);
+    const Eigen::Quaterniond q(
+        input_para_.current_position[6], input_para_.current_position[3],
+        input_para_.current_position[4], input_para_.current_position[5]);
+
+    // The synchronized profile moves along delta, its peak rate is set by
+    // the DOF that takes longest. Returns the largest ratio of the joint
+    // space rate to the joint limits, or of the norm of the translational or
+    // rotational rate to the nominal per-coordinate limit.
+    auto utilization = [&](const std::array<double, 7> &limit,
+                           const std::array<double, 7> &joint_limit) {
+      double rate = std::numeric_limits<double>::infinity();
+      for (int dof = 0; dof < 7; dof += 1) {
+        if (std::abs(delta[dof]) > 1e-9)
+          rate = std::min(rate, limit[dof] / std::abs(delta[dof]));
+      }
+      const Vector7d peak = rate * delta;
+      Vector6d twist;
+      twist.head<3>() = peak.head<3>();
+      const Eigen::Quaterniond dq(peak[6], peak[3], peak[4], peak[5]);
+      twist.tail<3>() = 2.0 * (dq * q.conjugate()).vec();
+      const Vector7d joint = jacobian_pinv * twist;
+      // A diagonal move would otherwise exceed the limits by up to sqrt(3),
+      // the quaternion rate is half the angular rate
+      double ratio = std::max(twist.head<3>().norm() / limit[0],
+                              twist.tail<3>().norm() / (2.0 * limit[3]));
+      for (int dof = 0; dof < 7; dof += 1) {
+        ratio = std::max(ratio, std::abs(joint[dof]) /
+                                    (kJointLimitMargin * joint_limit[dof]));
+      }
+      return ratio;
+    };
+    double scale = 1.0;
+    scale = std::min(scale, 1.0 / utilization(nominal_velocity_,
+                                              Panda::max_joint_velocity));
+    scale = std::min(scale,
+                     1.0 / std::sqrt(utilization(nominal_acceleration_,
+                                                 Panda::max_joint_acceleration)));
+    scale = std::min(scale, 1.0 / std::cbrt(utilization(
+                                      nominal_jerk_, Panda::max_joint_jerk)));
+    scale = std::clamp(scale, kMinScale, 1.0);
+    if (scale < scale_ || scale > (1.0 + kScaleHysteresis) * scale_)
+      setScale(scale);
   }
 
   void setInputCurrent(const franka::RobotState &robot_state) {
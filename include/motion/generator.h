@@ -8,6 +8,7 @@
 
 #include <panda.h>
 #include <pybind11/pybind11.h>
+#include <trace.h>
 
 typedef Callback<franka::JointPositions> JointPositionCallback;
 
@@ -19,10 +20,10 @@ struct Generator {
       : done_callback_(done_callback) {}
 
   virtual void start(Panda *robot, const franka::RobotState &robot_state,
-                     std::shared_ptr<franka::Model> model) = 0;
+                     std::shared_ptr<RobotModel> model) = 0;
 
   virtual void stop(const franka::RobotState &robot_state,
-                    std::shared_ptr<franka::Model> model) = 0;
+                    std::shared_ptr<RobotModel> model) = 0;
   virtual bool isRunning() = 0;
   virtual const std::string name() = 0;
   void setTime(double time) { time_ = time; }
@@ -44,17 +45,24 @@ protected:
       // auto callback = std::bind(&T::step, this, std::placeholders::_1,
       // std::placeholders::_2); cast this to T
       auto my_controller = static_cast<T *>(this);
-      auto callback = std::bind(&T::step, my_controller, std::placeholders::_1,
-                                std::placeholders::_2);
+      auto callback = [my_controller](const franka::RobotState &robot_state,
+                                      franka::Duration period) {
+        TraceScope scope("control", "generator_step");
+        return my_controller->step(robot_state, period);
+      };
+      Tracer::instance().setThreadName("control (" + panda_->name_ + ")");
+      Tracer::instance().prepareRealTimeThread();
       (panda_->getRobot())
           .control(callback, franka::ControllerMode::kJointImpedance, true);
     } catch (const franka::Exception &e) {
+      Tracer::instance().instant("panda", "control_error");
       panda_->_log("error", "Control loop interruped: %s", e.what());
       panda_->last_error_ = std::make_shared<franka::Exception>(e);
     }
     panda_->moving_ = false;
 
     if (done_callback_) {
+      TraceScope scope("callback", "done_callback");
       try {
         done_callback_();
       } catch (const std::exception &e) {
@@ -84,4 +92,26 @@ struct CartesianGenerator : Generator {
   void runController() override { runController_<CartesianGenerator>(); }
 };
 
+struct JointVelocityGenerator : Generator {
+
+  JointVelocityGenerator(std::function<void()> done_callback = nullptr)
+      : Generator(done_callback) {}
+
+  virtual franka::JointVelocities step(const franka::RobotState &robot_state,
+                                       franka::Duration period) = 0;
+  void runController() override { runController_<JointVelocityGenerator>(); }
+};
+
+struct CartesianVelocityGenerator : Generator {
+
+  CartesianVelocityGenerator(std::function<void()> done_callback = nullptr)
+      : Generator(done_callback) {}
+
+  virtual franka::CartesianVelocities
+  step(const franka::RobotState &robot_state, franka::Duration period) = 0;
+  void runController() override {
+    runController_<CartesianVelocityGenerator>();
+  }
+};
+
 } // namespace motion
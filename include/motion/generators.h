@@ -6,15 +6,21 @@
 #include <Eigen/Dense>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 #include "kinematics/ik.h"
+#include "motion/time_optimal/piecewise_polynomial.h"
 #include "motion/time_optimal/trajectory.h"
+#include "trace.h"
 #include "utils.h"
 
 namespace py = pybind11;
 namespace motion {
 
+typedef Eigen::Matrix<double, Eigen::Dynamic, 7, Eigen::RowMajor> MatrixX7d;
+
 const double kDefaultTimeout = 30.0;
 const double kDefaultJointSpeedFactor = 0.2;
 const double kDefaultCartesianSpeedFactor = 0.2;
@@ -23,6 +29,20 @@ class PandaTrajectory {
  public:
   double getDuration() { return traj_->getDuration(); }
 
+  /** @brief Convert the trajectory into its piecewise-polynomial form, which
+   *  sample() and evaluate() use. It interpolates the integration steps of
+   *  the time-optimal trajectory, so its velocities and accelerations differ
+   *  slightly from the getters, which always evaluate the trajectory itself.
+   *  Safe to call concurrently. */
+  void compile();
+
+  bool isCompiled() const { return std::atomic_load(&compiled_) != nullptr; }
+
+  std::shared_ptr<const time_optimal::PiecewisePolynomial> getCompiled() {
+    compile();
+    return std::atomic_load(&compiled_);
+  }
+
  protected:
   bool _computeTrajectory(const time_optimal::Path &path,
                           const Eigen::VectorXd &max_velocity,
@@ -31,12 +51,14 @@ class PandaTrajectory {
 
   template <typename... Args>
   void _log(const std::string level, Args &&...args) {
-    py::gil_scoped_acquire acquire;
+    TracedGilAcquire acquire("log");
     logger_.attr(level.c_str())(args...);
   }
 
   py::object logger_;
   std::shared_ptr<time_optimal::Trajectory> traj_;
+  std::shared_ptr<const time_optimal::PiecewisePolynomial> compiled_;
+  std::mutex compile_mux_;
 };
 
 class JointTrajectory : public PandaTrajectory {
@@ -51,6 +73,17 @@ class JointTrajectory : public PandaTrajectory {
 
   Vector7d getJointAccelerations(double time);
 
+  /** @brief Evaluate positions, velocities and accelerations at all `times`
+   *  in one pass. Compiles the trajectory on first use. */
+  std::tuple<MatrixX7d, MatrixX7d, MatrixX7d> sample(
+      const Eigen::VectorXd &times);
+
+  /** @brief Evaluate position, velocity and acceleration at `time` in one
+   *  pass of the compiled form. Returns the interval index to pass as
+   *  `hint` to the next call. */
+  size_t evaluate(double time, Vector7d &position, Vector7d &velocity,
+                  Vector7d &acceleration, size_t hint = 0);
+
  private:
   time_optimal::Path _convertList(const std::vector<Vector7d> &list,
                                   double maxDeviation = 0.0);
@@ -75,6 +108,20 @@ class CartesianTrajectory : public PandaTrajectory {
 
   Eigen::Vector4d getOrientation(double time);
 
+  /** @brief Evaluate pose, twist and twist derivative at `time` in one pass
+   *  of the compiled form. Returns the interval index to pass as `hint` to
+   *  the next call. */
+  size_t evaluate(double time, Eigen::Vector3d &position,
+                  Eigen::Quaterniond &orientation, Vector6d &velocity,
+                  Vector6d &acceleration, size_t hint = 0);
+
+  /** @brief Same as above on `compiled`, the result of getCompiled(), which
+   *  callers on the control thread resolve once up front. */
+  size_t evaluate(const time_optimal::PiecewisePolynomial &compiled,
+                  double time, Eigen::Vector3d &position,
+                  Eigen::Quaterniond &orientation, Vector6d &velocity,
+                  Vector6d &acceleration, size_t hint = 0);
+
  private:
   std::vector<double> angles_;
   std::vector<Eigen::Vector3d> axes_;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "motion/generators.h"
+#include "motion/time_optimal/piecewise_polynomial.h"
+
+namespace motion {
+
+/**
+ * Jerk-limited version of a time-optimal joint trajectory that can be
+ * executed on the joint position interface. The time-optimal trajectory is
+ * acceleration limited only, its acceleration jumps at switching points and
+ * without blending its velocity jumps at waypoints. Velocity jumps and both
+ * ends become stops. Between stops the path is re-timed to come to rest
+ * within the acceleration limits of the source and then smoothed by a moving
+ * average, which turns every acceleration jump into a jerk ramp. The window
+ * is the shortest one that respects the jerk limits, roughly acceleration
+ * over jerk, and each stop-to-stop segment takes that much longer than its
+ * re-timed version. The result is stored as a C2 quintic spline with knots
+ * at the ends of the ramps. Only if it leaves the given position deviation
+ * from the path or the limits of the robot, the whole trajectory is slowed
+ * down.
+ */
+class JerkLimitedTrajectory {
+ public:
+  static const Vector7d kDefaultMaxJerk;
+  static const double kDefaultMaxDeviation;
+  static const double kDefaultKnotSpacing;
+
+  JerkLimitedTrajectory(std::shared_ptr<JointTrajectory> trajectory,
+                        const Vector7d &max_jerk = kDefaultMaxJerk,
+                        double max_deviation = kDefaultMaxDeviation,
+                        double knot_spacing = kDefaultKnotSpacing);
+
+  JerkLimitedTrajectory(
+      std::shared_ptr<const time_optimal::PiecewisePolynomial> trajectory,
+      const Vector7d &max_jerk = kDefaultMaxJerk,
+      double max_deviation = kDefaultMaxDeviation,
+      double knot_spacing = kDefaultKnotSpacing);
+
+  double getDuration() const { return spline_->getDuration(); }
+
+  /// @brief Factor by which the trajectory was slowed down, 1 if it wasn't
+  double getTimeScale() const { return time_scale_; }
+
+  /// @brief Largest position deviation from the time-optimal path
+  double getDeviation() const { return deviation_; }
+
+  size_t getNumIntervals() const { return spline_->getNumIntervals(); }
+
+  Vector7d getJointPositions(double time) const;
+  Vector7d getJointVelocities(double time) const;
+  Vector7d getJointAccelerations(double time) const;
+
+  /** @brief Evaluate position, velocity and acceleration at `time`. Returns
+   *  the interval index to pass as `hint` to the next call. */
+  size_t evaluate(double time, Vector7d &position, Vector7d &velocity,
+                  Vector7d &acceleration, size_t hint = 0) const;
+
+  std::tuple<MatrixX7d, MatrixX7d, MatrixX7d> sample(
+      const Eigen::VectorXd &times) const;
+
+  std::shared_ptr<const time_optimal::PiecewisePolynomial> getSpline() const {
+    return spline_;
+  }
+
+ private:
+  void _findEvents();
+  bool _fit(double time_scale);
+  bool _fitSegment(double begin, double end, double time_scale);
+
+  std::shared_ptr<const time_optimal::PiecewisePolynomial> source_;
+  std::shared_ptr<time_optimal::PiecewisePolynomial> spline_;
+  std::vector<double> stops_;
+  Vector7d max_jerk_, max_velocity_, max_acceleration_;
+  double max_deviation_, knot_spacing_, time_scale_ = 1.0, deviation_ = 0.0;
+};
+
+}  // namespace motion
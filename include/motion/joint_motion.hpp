@@ -16,6 +16,10 @@ struct JointMotion {
   explicit JointMotion(const std::array<double, 7> target,
                        const std::array<double, 7> target_d = {0.0})
       : target(target.data()), target_d(target_d.data()) {}
+
+  explicit JointMotion(const Vector7d &target,
+                       const Vector7d &target_d = Vector7d::Zero())
+      : target(target), target_d(target_d) {}
 };
 
 } // namespace motion
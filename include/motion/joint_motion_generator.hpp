@@ -42,6 +42,26 @@ struct JointMotionGenerator : public JointGenerator {
     reload_ = true;
   }
 
+  /** @brief Append `count` waypoints from a row-major `count`x7 array of
+   *  joint positions in one pass. Each scale points to one value per row or
+   *  is null for the default of 1. */
+  void addWaypoints(const double *targets, size_t count,
+                    const double *velocity_rel = nullptr,
+                    const double *acceleration_rel = nullptr,
+                    const double *jerk_rel = nullptr) {
+    std::scoped_lock lock(mux_);
+    for (size_t i = 0; i < count; i++) {
+      JointMotion waypoint(
+          JointMotion::Vector7d(Eigen::Map<const JointMotion::Vector7d>(
+              targets + 7 * i)));
+      if (velocity_rel) waypoint.velocity_rel = velocity_rel[i];
+      if (acceleration_rel) waypoint.acceleration_rel = acceleration_rel[i];
+      if (jerk_rel) waypoint.jerk_rel = jerk_rel[i];
+      waypoints_.push(waypoint);
+    }
+    reload_ = true;
+  }
+
   void clearWaypoints() {
     std::scoped_lock lock(mux_);
     while (!waypoints_.empty()) {
@@ -51,7 +71,7 @@ struct JointMotionGenerator : public JointGenerator {
   }
 
   void start(Panda *robot, const franka::RobotState &robot_state,
-             std::shared_ptr<franka::Model> model) override {
+             std::shared_ptr<RobotModel> model) override {
     panda_ = robot;
     reload_ = false;
     motion_finished_ = false;
@@ -62,7 +82,7 @@ struct JointMotionGenerator : public JointGenerator {
   }
 
   void stop(const franka::RobotState &robot_state,
-            std::shared_ptr<franka::Model> model) override {
+            std::shared_ptr<RobotModel> model) override {
     motion_finishing_ = true;
   }
 
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <franka/duration.h>
+#include <franka/robot_state.h>
+
+#include "motion/generator.h"
+#include "motion/jerk_limited_trajectory.h"
+#include "panda.h"
+
+namespace motion {
+
+/**
+ * Executes a jerk-limited trajectory on the joint position interface. The
+ * trajectory has to start close to the commanded joint positions, the
+ * remaining offset is faded out smoothly at the beginning.
+ */
+struct JointTrajectoryGenerator : public JointGenerator {
+
+  // Largest offset to the start of the trajectory that is faded out
+  static constexpr double kStartTolerance = 1e-3;
+  static constexpr double kFadeDuration = 0.1;
+
+  JointTrajectoryGenerator(std::shared_ptr<JerkLimitedTrajectory> trajectory,
+                           std::function<void()> done_callback = nullptr)
+      : trajectory_(trajectory), JointGenerator(done_callback) {}
+
+  void start(Panda *robot, const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override {
+    panda_ = robot;
+    setTime(0.0);
+    hint_ = 0;
+    motion_finished_ = false;
+    motion_finishing_ = false;
+    current_cooldown_iteration = 0;
+    offset_ = Eigen::Map<const Vector7d>(robot_state.q_d.data()) -
+              trajectory_->getJointPositions(0.0);
+    if (offset_.cwiseAbs().maxCoeff() > kStartTolerance) {
+      panda_->_log("error",
+                   "Trajectory does not start at the current joint positions.");
+      motion_finishing_ = true;
+    }
+  }
+
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override {
+    motion_finishing_ = true;
+  }
+
+  franka::JointPositions step(const franka::RobotState &robot_state,
+                              franka::Duration period) override {
+    panda_->_setState(robot_state);
+    setTime(getTime() + period.toSec());
+    if (motion_finishing_)
+      return cooldown(robot_state, period);
+
+    const double time = std::min(getTime(), trajectory_->getDuration());
+    hint_ = trajectory_->evaluate(time, q_, dq_, ddq_, hint_);
+    // Quintic fade, zero velocity and acceleration at both ends
+    const double s = std::min(time / kFadeDuration, 1.0);
+    q_ += (1.0 - s * s * s * (10.0 - 15.0 * s + 6.0 * s * s)) * offset_;
+
+    franka::JointPositions output(toStd(q_));
+    if (getTime() >= trajectory_->getDuration()) {
+      motion_finished_ = true;
+      return franka::MotionFinished(output);
+    }
+    return output;
+  }
+
+  bool isRunning() override { return !motion_finished_; }
+
+  const std::string name() { return "Joint Trajectory Generator"; }
+
+private:
+  std::shared_ptr<JerkLimitedTrajectory> trajectory_;
+  std::atomic<bool> motion_finished_;
+  std::atomic<bool> motion_finishing_;
+  Vector7d q_, dq_, ddq_, offset_;
+  size_t hint_ = 0;
+  const size_t cooldown_iterations{5};
+  size_t current_cooldown_iteration{0};
+
+  franka::JointPositions cooldown(const franka::RobotState &robot_state,
+                                  franka::Duration period) {
+    if (current_cooldown_iteration < cooldown_iterations) {
+      current_cooldown_iteration++;
+      return franka::JointPositions(robot_state.q_d);
+    }
+    motion_finishing_ = false;
+    motion_finished_ = true;
+    return franka::MotionFinished(franka::JointPositions(robot_state.q_d));
+  }
+};
+} // namespace motion
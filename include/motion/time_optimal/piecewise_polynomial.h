@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "motion/time_optimal/trajectory.h"
+
+namespace motion {
+namespace time_optimal {
+
+/**
+ * Compiled representation of a finished time-optimal trajectory.
+ *
+ * The trajectory is converted into contiguous per-interval quintic
+ * polynomials in configuration space. Knots are the integration steps of the
+ * trajectory plus the points where it crosses from one path segment to the
+ * next, so the representation is exact on linear segments and accurate to
+ * machine precision on the circular blends. Position, velocity and
+ * acceleration are evaluated together in a single Horner pass without
+ * touching the path segment list.
+ */
+class PiecewisePolynomial {
+ public:
+  static constexpr int kOrder = 6;  // number of coefficients per interval
+
+  explicit PiecewisePolynomial(const Trajectory &trajectory);
+
+  /// @brief Empty spline starting at time zero, filled with `appendInterval`
+  explicit PiecewisePolynomial(size_t dim);
+
+  /** @brief Append a quintic Hermite interval of length `h` that connects
+   *  the given boundary positions, velocities and accelerations. */
+  void appendInterval(double h, const Eigen::VectorXd &p0,
+                      const Eigen::VectorXd &v0, const Eigen::VectorXd &a0,
+                      const Eigen::VectorXd &p1, const Eigen::VectorXd &v1,
+                      const Eigen::VectorXd &a1);
+
+  /// @brief Number of configuration space dimensions
+  size_t getDimension() const { return dim_; }
+
+  /// @brief Number of polynomial intervals
+  size_t getNumIntervals() const { return breaks_.size() - 1; }
+
+  double getDuration() const { return breaks_.back(); }
+
+  /** @brief Find the interval containing `time`. The search starts from
+   *  `hint`, which makes monotonic sampling amortised constant time. */
+  size_t findInterval(double time, size_t hint = 0) const;
+
+  /** @brief Evaluate position, velocity and acceleration at `time`.
+   *  Output pointers must hold `getDimension()` values, any of them may be
+   *  null. Returns the interval index, which can be passed as hint to the
+   *  next call. */
+  size_t evaluate(double time, double *position, double *velocity,
+                  double *acceleration, size_t hint = 0) const;
+
+  Eigen::VectorXd getPosition(double time) const;
+  Eigen::VectorXd getVelocity(double time) const;
+  Eigen::VectorXd getAcceleration(double time) const;
+
+  /** @brief Evaluate the trajectory at many points in time. Outputs are
+   *  row-major with one row per sample. */
+  void sample(const double *times, size_t num_samples, double *positions,
+              double *velocities, double *accelerations) const;
+
+  /// @brief Largest absolute jerk per dimension within an interval
+  Eigen::VectorXd getMaxJerk(size_t interval) const;
+
+  /// @brief Remove the last interval
+  void popInterval();
+
+ private:
+  size_t dim_;
+  std::vector<double> breaks_;
+  // Interval-major, then coefficient order, then dimension
+  std::vector<double> coeffs_;
+};
+
+}  // namespace time_optimal
+}  // namespace motion
@@ -48,6 +48,8 @@ namespace motion {
 namespace time_optimal {
 
 class Trajectory {
+  friend class PiecewisePolynomial;
+
  public:
   /// @brief Generates a time-optimal trajectory
   Trajectory(const Path& path, const Eigen::VectorXd& max_velocity,
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include "thread_pool.h"
+#include "trace.h"
+
+namespace motion {
+
+/**
+ * Trajectory computed in the background on the shared thread pool, so the
+ * next motion can be planned while the current one executes. Computations
+ * that haven't started yet are skipped when cancelled, which makes
+ * speculative planning of alternatives cheap. A running computation can't
+ * be interrupted, its result is discarded instead.
+ *
+ * Trajectories own Python objects, so workers only drop what may be the
+ * last reference to a result, or to a future holding one, with the GIL.
+ */
+template <typename Trajectory>
+class TrajectoryFuture
+    : public std::enable_shared_from_this<TrajectoryFuture<Trajectory>> {
+ public:
+  enum class State { kPending, kRunning, kFinished, kFailed, kCancelled };
+
+  using Compute = std::function<std::shared_ptr<Trajectory>()>;
+  using Callback = std::function<void()>;
+
+  /// @brief Run `compute` on the shared thread pool
+  static std::shared_ptr<TrajectoryFuture> submit(
+      Compute compute,
+      ThreadPool::Priority priority = ThreadPool::Priority::kNormal) {
+    std::shared_ptr<TrajectoryFuture> future(new TrajectoryFuture(compute));
+    ThreadPool::instance().post(
+        [future]() mutable {
+          future->_run();
+          // Python may have dropped its handle, leaving the last one here
+          if (future->_holdsResult()) _release(future);
+        },
+        priority);
+    return future;
+  }
+
+  /** @brief Cancel the computation. Returns false if it has already
+   *  finished or failed. */
+  bool cancel() {
+    {
+      std::lock_guard<std::mutex> lock(mux_);
+      if (state_ == State::kCancelled) return true;
+      if (state_ == State::kFinished || state_ == State::kFailed)
+        return false;
+    }
+    _finish(State::kCancelled, nullptr, nullptr);
+    return true;
+  }
+
+  bool isCancelled() const { return getState() == State::kCancelled; }
+
+  bool isRunning() const { return getState() == State::kRunning; }
+
+  bool isDone() const {
+    const State state = getState();
+    return state != State::kPending && state != State::kRunning;
+  }
+
+  State getState() const {
+    std::lock_guard<std::mutex> lock(mux_);
+    return state_;
+  }
+
+  /** @brief Block until done or `timeout` seconds have passed, a negative
+   *  timeout waits indefinitely. Returns whether the future is done. */
+  bool wait(double timeout = -1.0) {
+    std::unique_lock<std::mutex> lock(mux_);
+    auto done = [this]() {
+      return state_ != State::kPending && state_ != State::kRunning;
+    };
+    if (timeout < 0.0) {
+      cv_.wait(lock, done);
+      return true;
+    }
+    return cv_.wait_for(lock, std::chrono::duration<double>(timeout), done);
+  }
+
+  /** @brief Wait for the trajectory. Rethrows the computation's exception
+   *  and throws if cancelled or timed out. */
+  std::shared_ptr<Trajectory> get(double timeout = -1.0) {
+    if (!wait(timeout)) {
+      throw std::runtime_error("Timed out waiting for the trajectory.");
+    }
+    std::lock_guard<std::mutex> lock(mux_);
+    if (state_ == State::kCancelled) {
+      throw std::runtime_error("Trajectory computation was cancelled.");
+    }
+    if (error_) std::rethrow_exception(error_);
+    return result_;
+  }
+
+  /** @brief Call `callback` once done, right away if already done.
+   *  Callbacks run on the thread that completes the future. */
+  void addDoneCallback(const Callback &callback) {
+    {
+      std::lock_guard<std::mutex> lock(mux_);
+      if (state_ == State::kPending || state_ == State::kRunning) {
+        callbacks_.push_back(callback);
+        return;
+      }
+    }
+    _call(callback);
+  }
+
+ private:
+  explicit TrajectoryFuture(Compute compute) : compute_(compute) {}
+
+  void _run() {
+    Compute compute;
+    {
+      std::lock_guard<std::mutex> lock(mux_);
+      if (state_ != State::kPending) return;
+      state_ = State::kRunning;
+      compute.swap(compute_);
+    }
+    std::shared_ptr<Trajectory> result;
+    std::exception_ptr error;
+    try {
+      result = compute();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (!_finish(error ? State::kFailed : State::kFinished, result, error)) {
+      // Late result of a cancelled computation
+      _release(result);
+      _release(error);
+    }
+    _release(compute);
+  }
+
+  /** Returns false if the future was already done, in which case it keeps
+   *  neither the result nor the error */
+  bool _finish(State state, const std::shared_ptr<Trajectory> &result,
+               std::exception_ptr error) {
+    std::vector<Callback> callbacks;
+    // Only set if cancelled before running, _run() owns it afterwards
+    Compute compute;
+    {
+      std::lock_guard<std::mutex> lock(mux_);
+      if (state_ != State::kPending && state_ != State::kRunning) return false;
+      state_ = state;
+      result_ = result;
+      error_ = error;
+      compute.swap(compute_);
+      callbacks.swap(callbacks_);
+    }
+    _release(compute);
+    cv_.notify_all();
+    for (const auto &callback : callbacks) _call(callback);
+    return true;
+  }
+
+  bool _holdsResult() const {
+    std::lock_guard<std::mutex> lock(mux_);
+    return result_ != nullptr || error_ != nullptr;
+  }
+
+  // Drop `object` with the GIL held, leaked if the interpreter is gone
+  template <typename Object>
+  static void _release(Object &object) {
+    if (!object) return;
+    if (!Py_IsInitialized()) {
+      new Object(std::move(object));
+      return;
+    }
+    TracedGilAcquire acquire("future_release");
+    object = nullptr;
+  }
+
+  // Errors can't propagate to Python from here, report them like Python
+  // does for callbacks, with the traceback
+  static void _call(const Callback &callback) {
+    TraceScope scope("callback", "done_callback");
+    try {
+      callback();
+    } catch (py::error_already_set &e) {
+      TracedGilAcquire acquire("done_callback_error");
+      e.discard_as_unraisable("TrajectoryFuture done callback");
+    } catch (const std::exception &e) {
+      TracedGilAcquire acquire("done_callback_error");
+      py::module_::import("logging")
+          .attr("getLogger")("motion")
+          .attr("error")("Done callback error: %s", e.what());
+    }
+  }
+
+  mutable std::mutex mux_;
+  std::condition_variable cv_;
+  State state_ = State::kPending;
+  Compute compute_;
+  std::shared_ptr<Trajectory> result_;
+  std::exception_ptr error_;
+  std::vector<Callback> callbacks_;
+};
+
+}  // namespace motion
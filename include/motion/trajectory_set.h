@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "motion/generators.h"
+#include "thread_pool.h"
+
+namespace motion {
+
+/**
+ * Collection of joint trajectories that are queried at common points in
+ * time. Evaluation is parallelised over trajectories on the shared thread
+ * pool, each trajectory is compiled to its piecewise-polynomial form on
+ * first use.
+ */
+class TrajectorySet {
+ public:
+  TrajectorySet(const std::vector<std::shared_ptr<JointTrajectory>>
+                    &trajectories = {},
+                ThreadPool::Priority priority = ThreadPool::Priority::kNormal);
+
+  void add(std::shared_ptr<JointTrajectory> trajectory);
+  void clear();
+  size_t size() const { return trajectories_.size(); }
+  std::shared_ptr<JointTrajectory> get(size_t index) const;
+
+  /// @brief Durations of all trajectories in the set
+  Eigen::VectorXd getDurations() const;
+
+  /// @brief Compile all trajectories that are not compiled yet
+  void compile();
+
+  /** @brief Evaluate all K trajectories at the same M points in time.
+   *  Outputs are row-major K x M x 7 arrays, any of them may be null. */
+  void evaluate(const double *times, size_t num_times, double *positions,
+                double *velocities, double *accelerations);
+
+  void setPriority(ThreadPool::Priority priority) { priority_ = priority; }
+  ThreadPool::Priority getPriority() const { return priority_; }
+
+ private:
+  std::vector<std::shared_ptr<JointTrajectory>> trajectories_;
+  ThreadPool::Priority priority_;
+};
+
+}  // namespace motion
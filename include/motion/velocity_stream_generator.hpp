@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <franka/duration.h>
+#include <franka/robot_state.h>
+
+#include <ruckig/ruckig.hpp>
+
+#include "controllers/setpoint_buffer.h"
+#include "motion/generator.h"
+#include "panda.h"
+
+namespace motion {
+
+/**
+ * Online limiter shared by the velocity streaming generators. The latest
+ * command is picked up from a lock-free buffer at every control tick and
+ * tracked with bounded acceleration and jerk, each axis as fast as
+ * possible unless axes are grouped with setNormGroups(). Without a new
+ * command within the timeout, or while stopping, the target falls back to
+ * zero velocity.
+ */
+template <size_t DOFs> class VelocityStream {
+public:
+  static constexpr double kRestVelocity = 1e-6;
+
+  explicit VelocityStream(double timeout)
+      : buffer_(std::make_shared<SetpointBuffer>(DOFs)), timeout_(timeout),
+        limiter_(Panda::control_rate) {
+    input_.control_interface = ruckig::ControlInterface::Velocity;
+    input_.synchronization = ruckig::Synchronization::None;
+  }
+
+  std::shared_ptr<SetpointBuffer> getBuffer() { return buffer_; }
+
+  /// Publish a command, single writer only
+  void setCommand(const std::array<double, DOFs> &velocity) {
+    std::copy(velocity.begin(), velocity.end(), buffer_->staging());
+    buffer_->commit();
+  }
+
+  /** Limit the norm of each consecutive group of `size` axes instead of
+   *  each axis, e.g. 3 for the translational and angular velocity of a
+   *  twist. The velocity limit of a group is that of its first axis. The
+   *  axes of a group are phase synchronized, so the velocity moves along a
+   *  straight line and its norm stays within that of the current and the
+   *  target velocity. */
+  void setNormGroups(size_t size) {
+    if (size == 0 || DOFs % size != 0) {
+      throw std::invalid_argument("Group size must divide the axes.");
+    }
+    group_size_ = size;
+    input_.synchronization = size > 1 ? ruckig::Synchronization::Phase
+                                      : ruckig::Synchronization::None;
+  }
+
+  void setLimits(const std::array<double, DOFs> &max_velocity,
+                 const std::array<double, DOFs> &max_acceleration,
+                 const std::array<double, DOFs> &max_jerk) {
+    input_.max_velocity = max_velocity;
+    input_.max_acceleration = max_acceleration;
+    input_.max_jerk = max_jerk;
+  }
+
+  /** Start from the given state. Only commands published after the start
+   *  are followed. */
+  void start(const std::array<double, DOFs> &velocity,
+             const std::array<double, DOFs> &acceleration) {
+    input_.current_position.fill(0.0);
+    input_.current_velocity = velocity;
+    input_.current_acceleration = acceleration;
+    input_.target_velocity.fill(0.0);
+    input_.target_acceleration.fill(0.0);
+    command_.fill(0.0);
+    version_ = 0;
+    std::array<double, DOFs> stale;
+    buffer_->read(stale.data(), version_);  // Skip earlier commands
+    last_command_ = 0.0;
+    timed_out_ = true;
+    velocity_ = velocity;
+  }
+
+  /// Velocity to command at `time`
+  const std::array<double, DOFs> &update(double time, bool stopping) {
+    if (buffer_->read(command_.data(), version_)) {
+      last_command_ = time;
+      timed_out_ = false;
+    } else if (time - last_command_ > timeout_) {
+      timed_out_ = true;
+    }
+    for (size_t i = 0; i < DOFs; i++) {
+      input_.target_velocity[i] =
+          stopping || timed_out_ || !std::isfinite(command_[i])
+              ? 0.0
+              : command_[i];
+    }
+    // Scale each group down to its velocity limit, preserving the direction
+    for (size_t group = 0; group < DOFs; group += group_size_) {
+      double norm = 0.0;
+      for (size_t i = group; i < group + group_size_; i++) {
+        norm += input_.target_velocity[i] * input_.target_velocity[i];
+      }
+      norm = std::sqrt(norm);
+      if (norm > input_.max_velocity[group]) {
+        const double scale = input_.max_velocity[group] / norm;
+        for (size_t i = group; i < group + group_size_; i++) {
+          input_.target_velocity[i] *= scale;
+        }
+      }
+    }
+    // On invalid input, keep the last velocity rather than jumping
+    const ruckig::Result result = limiter_.update(input_, output_);
+    if (result == ruckig::Result::Working ||
+        result == ruckig::Result::Finished) {
+      output_.pass_to_input(input_);
+      velocity_ = output_.new_velocity;
+    }
+    return velocity_;
+  }
+
+  bool isTimedOut() const { return timed_out_; }
+
+  bool isAtRest() const {
+    for (size_t i = 0; i < DOFs; i++) {
+      if (std::abs(input_.current_velocity[i]) > kRestVelocity ||
+          std::abs(input_.current_acceleration[i]) > kRestVelocity)
+        return false;
+    }
+    return true;
+  }
+
+private:
+  std::shared_ptr<SetpointBuffer> buffer_;
+  const double timeout_;
+  ruckig::Ruckig<DOFs> limiter_;
+  ruckig::InputParameter<DOFs> input_;
+  ruckig::OutputParameter<DOFs> output_;
+  std::array<double, DOFs> command_, velocity_;
+  uint64_t version_ = 0;
+  size_t group_size_ = 1;
+  double last_command_ = 0.0;
+  std::atomic<bool> timed_out_{true};
+};
+
+/**
+ * Streams joint velocity commands, e.g. for teleoperation. The commanded
+ * velocity is limited online and decays to zero if no new command arrives
+ * within the timeout.
+ */
+struct JointVelocityStreamGenerator : public JointVelocityGenerator {
+
+  static constexpr double kDefaultTimeout = 0.1;
+
+  JointVelocityStreamGenerator(double timeout = kDefaultTimeout,
+                               double velocity_rel = 1.0,
+                               double acceleration_rel = 1.0,
+                               double jerk_rel = 1.0,
+                               std::function<void()> done_callback = nullptr)
+      : stream_(timeout), velocity_rel_(velocity_rel),
+        acceleration_rel_(acceleration_rel), jerk_rel_(jerk_rel),
+        JointVelocityGenerator(done_callback) {}
+
+  void setVelocity(const Vector7d &velocity) {
+    stream_.setCommand(toStd(velocity));
+  }
+
+  std::shared_ptr<SetpointBuffer> getCommandBuffer() {
+    return stream_.getBuffer();
+  }
+
+  bool isTimedOut() { return stream_.isTimedOut(); }
+
+  void start(Panda *robot, const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override {
+    panda_ = robot;
+    setTime(0.0);
+    motion_finished_ = false;
+    motion_finishing_ = false;
+    std::array<double, 7> max_velocity, max_acceleration, max_jerk;
+    for (size_t dof = 0; dof < Panda::degrees_of_freedoms; dof++) {
+      max_velocity[dof] = Panda::max_joint_velocity[dof] *
+                          panda_->velocity_rel * velocity_rel_;
+      max_acceleration[dof] = 0.3 * Panda::max_joint_acceleration[dof] *
+                              panda_->acceleration_rel * acceleration_rel_;
+      max_jerk[dof] =
+          0.3 * Panda::max_joint_jerk[dof] * panda_->jerk_rel * jerk_rel_;
+    }
+    stream_.setLimits(max_velocity, max_acceleration, max_jerk);
+    stream_.start(robot_state.dq_d, robot_state.ddq_d);
+  }
+
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override {
+    motion_finishing_ = true;
+  }
+
+  franka::JointVelocities step(const franka::RobotState &robot_state,
+                               franka::Duration period) override {
+    panda_->_setState(robot_state);
+    setTime(getTime() + period.toSec());
+    franka::JointVelocities output(stream_.update(getTime(), motion_finishing_));
+    if (motion_finishing_ && stream_.isAtRest()) {
+      motion_finished_ = true;
+      return franka::MotionFinished(
+          franka::JointVelocities({0, 0, 0, 0, 0, 0, 0}));
+    }
+    return output;
+  }
+
+  bool isRunning() override { return !motion_finished_; }
+
+  const std::string name() { return "Joint Velocity Stream Generator"; }
+
+private:
+  VelocityStream<7> stream_;
+  double velocity_rel_, acceleration_rel_, jerk_rel_;
+  std::atomic<bool> motion_finished_;
+  std::atomic<bool> motion_finishing_;
+};
+
+/**
+ * Streams end-effector twists in the base frame, translational velocity
+ * followed by angular velocity. Limited and guarded like
+ * JointVelocityStreamGenerator, the translational and angular velocity are
+ * limited by their norms.
+ */
+struct CartesianVelocityStreamGenerator : public CartesianVelocityGenerator {
+
+  static constexpr double kDefaultTimeout = 0.1;
+
+  CartesianVelocityStreamGenerator(
+      double timeout = kDefaultTimeout, double velocity_rel = 1.0,
+      double acceleration_rel = 1.0, double jerk_rel = 1.0,
+      std::function<void()> done_callback = nullptr)
+      : stream_(timeout), velocity_rel_(velocity_rel),
+        acceleration_rel_(acceleration_rel), jerk_rel_(jerk_rel),
+        CartesianVelocityGenerator(done_callback) {}
+
+  void setTwist(const Vector6d &twist) {
+    std::array<double, 6> command;
+    Eigen::Map<Vector6d>(command.data()) = twist;
+    stream_.setCommand(command);
+  }
+
+  std::shared_ptr<SetpointBuffer> getCommandBuffer() {
+    return stream_.getBuffer();
+  }
+
+  bool isTimedOut() { return stream_.isTimedOut(); }
+
+  void start(Panda *robot, const franka::RobotState &robot_state,
+             std::shared_ptr<RobotModel> model) override {
+    panda_ = robot;
+    setTime(0.0);
+    motion_finished_ = false;
+    motion_finishing_ = false;
+    std::array<double, 6> max_velocity, max_acceleration, max_jerk;
+    for (size_t dof = 0; dof < 6; dof++) {
+      const bool translation = dof < 3;
+      max_velocity[dof] = (translation ? Panda::max_translation_velocity
+                                       : Panda::max_rotation_velocity) *
+                          panda_->velocity_rel * velocity_rel_;
+      max_acceleration[dof] = 0.3 *
+                              (translation ? Panda::max_translation_acceleration
+                                           : Panda::max_rotation_acceleration) *
+                              panda_->acceleration_rel * acceleration_rel_;
+      max_jerk[dof] = 0.3 *
+                      (translation ? Panda::max_translation_jerk
+                                   : Panda::max_rotation_jerk) *
+                      panda_->jerk_rel * jerk_rel_;
+    }
+    // libfranka limits the norms of the translational and angular velocity
+    stream_.setNormGroups(3);
+    stream_.setLimits(max_velocity, max_acceleration, max_jerk);
+    stream_.start(robot_state.O_dP_EE_c, robot_state.O_ddP_EE_c);
+  }
+
+  void stop(const franka::RobotState &robot_state,
+            std::shared_ptr<RobotModel> model) override {
+    motion_finishing_ = true;
+  }
+
+  franka::CartesianVelocities step(const franka::RobotState &robot_state,
+                                   franka::Duration period) override {
+    panda_->_setState(robot_state);
+    setTime(getTime() + period.toSec());
+    franka::CartesianVelocities output(
+        stream_.update(getTime(), motion_finishing_));
+    if (motion_finishing_ && stream_.isAtRest()) {
+      motion_finished_ = true;
+      return franka::MotionFinished(
+          franka::CartesianVelocities({0, 0, 0, 0, 0, 0}));
+    }
+    return output;
+  }
+
+  bool isRunning() override { return !motion_finished_; }
+
+  const std::string name() { return "Cartesian Velocity Stream Generator"; }
+
+private:
+  VelocityStream<6> stream_;
+  double velocity_rel_, acceleration_rel_, jerk_rel_;
+  std::atomic<bool> motion_finished_;
+  std::atomic<bool> motion_finishing_;
+};
+} // namespace motion
@@ -21,24 +21,35 @@
 #include "motion/joint_motion.hpp"
 #include "motion/motion_data.hpp"
 
+#include "kinematics/kinematics.h"
+#include "model_cache.h"
+#include "robot_model.h"
+#include "tick_group.h"
 #include "utils.h"
 
 namespace py = pybind11;
 
 class Panda;
+namespace simulation {
+    class StressTest;
+    class CycleTimeBenchmark;
+};
 namespace motion {
     class Generator;
     class JointGenerator;
     class CartesianGenerator;
     class JointMotionGenerator;
     class CartesianMotionGenerator;
+    class JointTrajectoryGenerator;
+    class JointVelocityStreamGenerator;
+    class CartesianVelocityStreamGenerator;
     
 };
 
 class PandaContext {
  public:
   PandaContext(Panda &panda, const double &frequency, const double &t_max = 0,
-               const uint64_t &max_ticks = 0);
+               const uint64_t &max_ticks = 0, const size_t &block_size = 0);
   const PandaContext &enter();
   bool exit(const py::object &type, const py::object &value,
             const py::object &traceback);
@@ -46,11 +57,22 @@ class PandaContext {
   uint64_t getNumTicks();
   double getTime();
 
+  // Tick-group mode, see `block_size`
+  size_t getBlockSize();
+  uint64_t getNumDroppedBlocks();
+  std::map<std::string, TickGroup::RowMatrixXd> getStates();
+  void setSetpoints(const TickGroup::RowMatrixXd &setpoints);
+
  private:
+  bool _okBlock();
+
   double dt_, t_max_;
   uint64_t num_ticks_, max_ticks_;
   std::chrono::high_resolution_clock::time_point t_start_, t_prev_;
   Panda &panda_;
+  std::shared_ptr<TickGroup> tick_group_;
+  TickGroup::StateBlock block_;
+  uint64_t num_dropped_blocks_ = 0;
 };
 
 class Panda {
@@ -59,6 +81,12 @@ class Panda {
  friend class motion::JointMotionGenerator;
  friend class motion::CartesianGenerator;
  friend class motion::CartesianMotionGenerator;
+ friend class motion::JointTrajectoryGenerator;
+ friend class motion::JointVelocityStreamGenerator;
+ friend class motion::CartesianVelocityStreamGenerator;
+ friend class PandaContext;
+ friend class simulation::StressTest;
+ friend class simulation::CycleTimeBenchmark;
 
  public:
 
@@ -87,14 +115,22 @@ class Panda {
 
   double velocity_rel {1.0}, acceleration_rel {1.0}, jerk_rel {1.0};
 
+  /// Durations of the connection steps in seconds
+  struct ConnectionTiming {
+    double connect, load_model, read_state, total;
+    ModelCache::Source model_source;
+  };
+
   Panda(
       std::string hostname, std::string name = "panda",
       franka::RealtimeConfig realtime_config = franka::RealtimeConfig::kIgnore);
   ~Panda();
   const PandaContext createContext(double frequency, double max_runtime = 0.0,
-                                   uint64_t max_iter = 0);
+                                   uint64_t max_iter = 0,
+                                   size_t block_size = 0);
   franka::Robot &getRobot();
   franka::Model &getModel();
+  const ConnectionTiming &getConnectionTiming() const;
   franka::RobotState getState();
   void startController(std::shared_ptr<TorqueController> controller);
   void stopController();
@@ -119,6 +155,11 @@ class Panda {
   Vector7d getJointPositions();
   Eigen::Matrix<double, 4, 4> getPose();
   void setDefaultBehavior();
+  /** Use the tool frame of `kinematics` as the robot's end effector, so
+   *  O_T_EE and the end-effector Jacobian refer to the tool for all
+   *  controllers and generators. */
+  void setKinematics(std::shared_ptr<kinematics::Kinematics> kinematics);
+  std::shared_ptr<kinematics::Kinematics> getKinematics();
   void raiseError();
   void recover();
   void teaching_mode(bool active, const Vector7d &damping = kDefaultTeachingDamping);
@@ -126,11 +167,15 @@ class Panda {
   const std::string name_;
 
  private:
+  // Instance without robot connection, driven by the stress test
+  Panda(const std::string &name, std::shared_ptr<RobotModel> model);
+
   void _startController(std::shared_ptr<TorqueController> controller);
   void _runController(TorqueCallback &control);
 
   
   void _setState(const franka::RobotState &state);
+  void _setTickGroup(std::shared_ptr<TickGroup> tick_group);
   template <typename... Args>
   void _log(const std::string level, Args &&...args);
 
@@ -138,10 +183,14 @@ class Panda {
 
   std::shared_ptr<franka::Robot> robot_;
   std::shared_ptr<franka::Model> model_;
+  // Dynamics handed to torque controllers, forwards to model_
+  std::shared_ptr<RobotModel> robot_model_;
   franka::RobotState state_;
   std::mutex mux_;
 
   std::shared_ptr<TorqueController> current_controller_;
+  std::shared_ptr<kinematics::Kinematics> kinematics_ =
+      std::make_shared<kinematics::Kinematics>();
   std::shared_ptr<motion::Generator> current_generator_;
 
   std::thread current_thread_;
@@ -149,9 +198,17 @@ class Panda {
       virtual_walls_;
   py::object logger_;
   std::string hostname_;
+  ConnectionTiming connection_timing_;
   std::shared_ptr<franka::Exception> last_error_;
   std::deque<franka::RobotState> log_;
   std::atomic<bool> moving_;
+  // Raw pointer read by the control thread, owned by tick_group_owner_.
+  // tick_group_busy_ is set while the control thread uses the group, so
+  // _setTickGroup() can release replaced groups outside the control thread.
+  std::atomic<TickGroup *> tick_group_{nullptr};
+  std::atomic<bool> tick_group_busy_{false};
+  std::shared_ptr<TickGroup> tick_group_owner_;
+  std::mutex tick_group_mux_;
 
   bool log_enabled_ = false;
   size_t log_size_;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <franka/model.h>
+#include <franka/robot_state.h>
+
+#include <array>
+#include <memory>
+
+/**
+ * Dynamics queried by torque controllers. On the robot this is libfranka's
+ * model, the simulation provides its own rigid-body implementation so that
+ * controllers can be run offline without changes.
+ */
+class RobotModel {
+ public:
+  virtual ~RobotModel() = default;
+
+  /// @brief Column-major 7x7 joint space inertia matrix
+  virtual std::array<double, 49> mass(
+      const franka::RobotState &robot_state) const = 0;
+  /// @brief Coriolis and centrifugal torques
+  virtual std::array<double, 7> coriolis(
+      const franka::RobotState &robot_state) const = 0;
+  virtual std::array<double, 7> gravity(
+      const franka::RobotState &robot_state) const = 0;
+  /// @brief Column-major 6x7 Jacobian of `frame` relative to the base frame
+  virtual std::array<double, 42> zeroJacobian(
+      franka::Frame frame, const franka::RobotState &robot_state) const = 0;
+};
+
+/// @brief Forwards to libfranka's model of a connected robot
+class FrankaRobotModel : public RobotModel {
+ public:
+  explicit FrankaRobotModel(std::shared_ptr<franka::Model> model);
+
+  std::array<double, 49> mass(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 7> coriolis(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 7> gravity(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 42> zeroJacobian(
+      franka::Frame frame,
+      const franka::RobotState &robot_state) const override;
+
+ private:
+  std::shared_ptr<franka::Model> model_;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <Eigen/Dense>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kinematics/kinematics.h"
+#include "motion/generators.h"
+#include "panda.h"
+#include "simulation/rigid_body_model.h"
+#include "utils.h"
+
+namespace simulation {
+
+/// @brief Ways of moving through a sequence of joint waypoints
+enum class Strategy {
+  /// Time-optimal path following with motion::JointTrajectory
+  kJointTrajectory,
+  /// Ruckig profiles of motion::JointMotionGenerator, stopping at each
+  /// waypoint
+  kJointMotionGenerator,
+  /** Ruckig profiles of motion::CartesianMotionGenerator through the
+   *  end-effector poses of the waypoints, stopping at each */
+  kCartesianMotionGenerator
+};
+
+struct CycleTimeSettings {
+  static constexpr double kControlPeriod = 1e-3;
+
+  /** Speed factor and blending deviation of the joint trajectory. The
+   *  speed factor scales the joint velocity limits like velocity_rel does
+   *  for the generators, by default all strategies use the full limits. */
+  double speed_factor = 1.0;
+  double max_deviation = 0.0;
+  /// Relative dynamics of the generators, see Panda::velocity_rel
+  double velocity_rel = 1.0, acceleration_rel = 1.0, jerk_rel = 1.0;
+  /// Generators still moving after this long fail
+  double timeout = 60.0;
+  /// Load carried by the arm, for the joint torques
+  Load load = RigidBodyModel::kFrankaHand;
+  Eigen::Matrix4d F_T_EE = RigidBodyModel::kFrankaHandTransform;
+};
+
+struct CycleTimeResult {
+  /// Time from leaving the first waypoint to arriving at the last one
+  double duration = 0.0;
+  /** Computation before the first command: the trajectory for
+   *  kJointTrajectory, the first control tick for the generators */
+  double planning_time = 0.0;
+  /// Longest computation of a command during the motion
+  double max_tick_time = 0.0;
+  Vector7d peak_velocity = Vector7d::Zero();
+  /// Inverse dynamics of the rigid-body model, gravity included
+  Vector7d peak_torque = Vector7d::Zero();
+  /// Largest ratio of the peaks to kQMaxVelocity and kTauJMax
+  double velocity_utilization = 0.0, torque_utilization = 0.0;
+  bool failed = false;
+  std::string error;
+};
+
+/**
+ * Compares the cycle time of motion strategies offline. Each run moves the
+ * arm from the first waypoint through the others at 1 kHz, faster than real
+ * time: the joint trajectory is sampled, generators are stepped through
+ * the same calls as on a connected Panda with their commands echoed back
+ * as robot state. Joint positions of Cartesian generators are recovered by
+ * inverse kinematics holding joint 7, an approximation of the elbow held
+ * by the robot's Cartesian interface. Joint velocities, accelerations and
+ * torques are evaluated on the rigid-body model used by rollout(), which
+ * also provides the Jacobian the Cartesian generator scales its limits
+ * with.
+ *
+ * Must be constructed with the GIL held.
+ */
+class CycleTimeBenchmark {
+ public:
+  explicit CycleTimeBenchmark(const CycleTimeSettings &settings);
+  ~CycleTimeBenchmark();
+
+  const CycleTimeSettings &getSettings() const { return settings_; }
+
+  CycleTimeResult run(const std::vector<Vector7d> &waypoints,
+                      Strategy strategy);
+
+ private:
+  CycleTimeResult _trajectory(const std::vector<Vector7d> &waypoints);
+  CycleTimeResult _jointGenerator(const std::vector<Vector7d> &waypoints);
+  CycleTimeResult _cartesianGenerator(const std::vector<Vector7d> &waypoints);
+
+  CycleTimeSettings settings_;
+  kinematics::Kinematics kinematics_;
+  std::unique_ptr<Panda> panda_;
+};
+
+}  // namespace simulation
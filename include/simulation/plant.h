@@ -0,0 +1,91 @@
+#pragma once
+#include <franka/robot_state.h>
+
+#include <Eigen/Dense>
+#include <memory>
+
+#include "constants.h"
+#include "simulation/rigid_body_model.h"
+#include "utils.h"
+
+namespace simulation {
+
+/**
+ * Plane the end effector may press against, modeled as a unilateral
+ * spring-damper along the normal without friction.
+ */
+struct Contact {
+  Eigen::Vector3d point = Eigen::Vector3d::Zero();
+  /// Pointing away from the surface into free space
+  Eigen::Vector3d normal = Eigen::Vector3d::UnitZ();
+  double stiffness = 1e4;
+  double damping = 100.0;
+};
+
+struct PlantSettings {
+  static constexpr double kControlPeriod = 1e-3;
+
+  Vector7d q_init = kJointPositionStart;
+  /// Integration steps per control tick
+  int substeps = 2;
+  /** Cutoff frequency of libfranka's low-pass filter on the commanded
+   *  torques, disabled at 1 kHz and above */
+  double cutoff_frequency = 100.0;
+  /** Reflected rotor inertia added to the diagonal of the plant's mass
+   *  matrix, which the rigid-body model doesn't include */
+  Vector7d armature = Vector7d::Constant(0.1);
+  /// Viscous joint friction of the plant
+  Vector7d viscous_friction = Vector7d::Zero();
+  /// End effector known to the controller through the robot state
+  Load end_effector = RigidBodyModel::kFrankaHand;
+  Eigen::Matrix4d F_T_EE = RigidBodyModel::kFrankaHandTransform;
+  /// Load carried by the plant that the controller doesn't know about
+  Load payload;
+  bool contact = false;
+  Contact contact_plane;
+};
+
+/**
+ * Simulated arm driven by torque commands. Commands pass the same rate
+ * saturation and clipping as the real control loop and libfranka's
+ * low-pass filter. Gravity is compensated for the load reported in the
+ * robot state like on the robot, the rigid-body dynamics are integrated
+ * with semi-implicit Euler.
+ */
+class Plant {
+ public:
+  explicit Plant(const PlantSettings &settings);
+
+  /// @brief Model shared by all plants, it doesn't hold any state
+  static std::shared_ptr<RigidBodyModel> model();
+
+  /// @brief Robot state as reported to the controller
+  const franka::RobotState &getState() const { return state_; }
+  const Vector7d &getJointPositions() const { return q_; }
+  const Vector7d &getJointVelocities() const { return dq_; }
+  /// @brief Commanded torques after saturation and filtering
+  const Vector7d &getCommandedTorques() const { return tau_J_d_; }
+  /// @brief Force exerted by the end effector on the contact plane
+  const Eigen::Vector3d &getForce() const { return force_; }
+  double getTime() const { return time_; }
+
+  /// @brief Apply a torque command for one control period
+  void step(const Vector7d &command);
+
+ private:
+  void _observe();
+
+  PlantSettings settings_;
+  Load load_;
+  bool payload_;
+  double filter_gain_;
+  double time_ = 0.0;
+
+  franka::RobotState state_;
+  Vector7d q_, dq_, tau_J_, tau_J_d_ = Vector7d::Zero();
+  Eigen::Vector3d force_ = Eigen::Vector3d::Zero();
+  Eigen::Matrix<double, 7, 7> mass_;
+  Vector7d bias_;
+};
+
+}  // namespace simulation
@@ -0,0 +1,88 @@
+#pragma once
+#include <Eigen/Dense>
+
+#include <array>
+
+#include "robot_model.h"
+#include "utils.h"
+
+namespace simulation {
+
+/// @brief Rigid body attached to the flange, expressed in the flange frame
+struct Load {
+  double mass = 0.0;
+  Eigen::Vector3d com = Eigen::Vector3d::Zero();
+  /// Rotational inertia with respect to the center of mass
+  Eigen::Matrix3d inertia = Eigen::Matrix3d::Zero();
+};
+
+/**
+ * Rigid-body model of the Panda arm. Kinematics follow the modified
+ * Denavit-Hartenberg parameters of the datasheet. The link inertial
+ * parameters are approximate values after the identification of Gaz et al.
+ * (RA-L 2019) and don't include the end effector.
+ *
+ * Like libfranka's model, the RobotModel interface takes the end effector
+ * frame (`F_T_EE`, `EE_T_K`) and the total load (`m_total`, `F_x_Ctotal`,
+ * `I_total`) from the robot state. The remaining functions are used by the
+ * simulator to integrate the plant, whose load may differ from the one
+ * reported to the controller.
+ */
+class RigidBodyModel : public RobotModel {
+ public:
+  /// @brief Franka Hand as configured by default
+  static const Load kFrankaHand;
+  static const Eigen::Matrix4d kFrankaHandTransform;
+
+  std::array<double, 49> mass(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 7> coriolis(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 7> gravity(
+      const franka::RobotState &robot_state) const override;
+  std::array<double, 42> zeroJacobian(
+      franka::Frame frame,
+      const franka::RobotState &robot_state) const override;
+
+  /** @brief Joint space inertia matrix and the sum of Coriolis, centrifugal
+   *  and gravity torques of the arm carrying `load` */
+  void dynamics(const Vector7d &q, const Vector7d &dq, const Load &load,
+                Eigen::Matrix<double, 7, 7> &mass, Vector7d &bias) const;
+  /// @brief Pose of the flange transformed by `F_T_X` in the base frame
+  Eigen::Matrix4d pose(const Vector7d &q, const Eigen::Matrix4d &F_T_X) const;
+  /// @brief Jacobian of the flange transformed by `F_T_X` in the base frame
+  Eigen::Matrix<double, 6, 7> jacobian(const Vector7d &q,
+                                       const Eigen::Matrix4d &F_T_X) const;
+
+  /// @brief Load reported in a robot state
+  static Load stateLoad(const franka::RobotState &robot_state);
+
+ private:
+  /// @brief Link frames in the base frame, index 7 is the flange
+  struct Frames {
+    std::array<Eigen::Matrix3d, 8> rotation;
+    std::array<Eigen::Vector3d, 8> origin;
+  };
+
+  /// @brief Link inertial parameters, expressed in the link frames
+  struct Links {
+    std::array<double, 7> mass;
+    std::array<Eigen::Vector3d, 7> com;
+    std::array<Eigen::Matrix3d, 7> inertia;
+  };
+
+  void _frames(const Vector7d &q, Frames &frames) const;
+  /// @brief Links with the load lumped into the last one
+  Links _links(const Load &load) const;
+  Eigen::Matrix<double, 7, 7> _mass(const Frames &frames,
+                                    const Links &links) const;
+  /// @brief Recursive Newton-Euler for zero joint accelerations
+  Vector7d _bias(const Frames &frames, const Vector7d &dq, const Links &links,
+                 bool with_gravity) const;
+  Eigen::Matrix<double, 6, 7> _jacobian(const Frames &frames, int frame,
+                                        const Eigen::Vector3d &point) const;
+  Eigen::Matrix4d _frameTransform(franka::Frame frame,
+                                  const franka::RobotState &robot_state) const;
+};
+
+}  // namespace simulation
@@ -0,0 +1,79 @@
+#pragma once
+#include <Eigen/Dense>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controllers/controller.h"
+#include "simulation/plant.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+namespace simulation {
+
+/// @brief Signal compared to the leading entries of the setpoint rows
+enum class Objective {
+  /// Joint positions
+  kJointPosition,
+  /// End-effector position
+  kCartesianPosition,
+  /// Force exerted by the end effector on the contact plane
+  kForce
+};
+
+struct RolloutSettings : PlantSettings {
+  double duration = 2.0;
+  /** Row-major setpoints, one row of `setpoint_size` per control tick
+   *  passed to TorqueController::applySetpoint. The last row is held until
+   *  the end. */
+  std::vector<double> setpoints;
+  size_t setpoint_size = 0;
+  Objective objective = Objective::kCartesianPosition;
+  /// Settling band as fraction of the final setpoint step
+  double settling_tolerance = 0.02;
+  /// Record the objective signal of every tick
+  bool record = false;
+};
+
+struct RolloutResult {
+  /// Simulated time, shorter than requested if the rollout failed
+  double duration = 0.0;
+  double rms_error = 0.0, max_error = 0.0, final_error = 0.0;
+  /// Largest excursion beyond the final setpoint relative to the step
+  double overshoot = 0.0;
+  /// Time after the last setpoint change until the error stays in the band
+  double settling_time = std::numeric_limits<double>::infinity();
+  /// Ticks with commanded torque changes exceeding kDeltaTauMax
+  size_t torque_rate_violations = 0;
+  /// Ticks with commanded torques exceeding kTauJMax
+  size_t torque_limit_violations = 0;
+  double max_torque_rate = 0.0;
+  bool failed = false;
+  std::string error;
+  /// Row-major objective signal per tick, if recorded
+  std::vector<double> trace;
+};
+
+/// @brief Number of entries of the objective signal
+size_t objectiveSize(Objective objective);
+
+/**
+ * Simulate `controller` running on the arm, faster than real time. Each
+ * control tick applies the next setpoint row, steps the controller with the
+ * plant's robot state and passes the command to the plant. The rollout
+ * fails when the controller throws, the joint limits are exceeded or the
+ * plant diverges.
+ */
+RolloutResult rollout(TorqueController &controller,
+                      const RolloutSettings &settings);
+
+/** @brief Run one rollout per controller in parallel on the process-wide
+ *  thread pool. Controllers must be distinct instances. */
+std::vector<RolloutResult> rollouts(
+    const std::vector<std::shared_ptr<TorqueController>> &controllers,
+    const RolloutSettings &settings,
+    ThreadPool::Priority priority = ThreadPool::Priority::kNormal);
+
+}  // namespace simulation
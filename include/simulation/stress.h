@@ -0,0 +1,120 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controllers/controller.h"
+#include "motion/generator.h"
+#include "panda.h"
+#include "simulation/plant.h"
+
+namespace simulation {
+
+/// @brief Distribution of a latency in seconds
+struct LatencyStats {
+  double mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, p999 = 0.0, max = 0.0;
+
+  static LatencyStats of(std::vector<double> samples);
+};
+
+struct StressSettings {
+  static constexpr double kControlPeriod = 1e-3;
+
+  double duration = 5.0;
+  /// Latest completion of a callback after the nominal start of its tick
+  double deadline = 1e-3;
+  /** Callbacks taking longer than this, injected delays excluded, count as
+   *  blocked */
+  double blocking_threshold = 1e-4;
+  /// Run the loop with SCHED_FIFO like libfranka's RealtimeConfig::kEnforce
+  bool realtime = false;
+  /// CPU the loop thread is pinned to, -1 leaves it unpinned
+  int cpu = -1;
+  /** Integrate the arm for torque controllers, otherwise the robot state
+   *  holds still. Generators always see their own commands. */
+  bool simulate = true;
+  PlantSettings plant;
+
+  /// Threads spinning on the CPU for the whole run
+  size_t cpu_burners = 0;
+  /// Busy wait injected before the callback with `delay_probability`
+  double delay = 0.0;
+  double delay_probability = 0.0;
+  /// Threads holding the GIL for `gil_hold_time` once every `gil_period`
+  size_t gil_holders = 0;
+  double gil_hold_time = 5e-3;
+  double gil_period = 10e-3;
+  /** Tick group block size, 0 disables it. A consumer thread reads the
+   *  state blocks like PandaContext does. */
+  size_t block_size = 0;
+  /// Row-major setpoints published to the tick group by the producer
+  std::vector<double> setpoints;
+  size_t setpoint_size = 0;
+  /** Once every `burst_interval` the producer publishes the setpoints and
+   *  calls `producer` `burst_size` times back to back */
+  size_t burst_size = 0;
+  double burst_interval = 0.1;
+  std::function<void()> producer;
+  unsigned int seed = 0;
+};
+
+struct StressResult {
+  size_t ticks = 0;
+  /// Ticks that completed later than the deadline
+  size_t deadline_misses = 0;
+  size_t max_consecutive_misses = 0;
+  /// Ticks that ran longer than the blocking threshold on their own
+  size_t blocked_ticks = 0;
+  size_t injected_delays = 0;
+  /** From the nominal tick start to the start of the callback, the
+   *  callback itself and from the nominal tick start to its completion */
+  LatencyStats wakeup, callback, response;
+  /// Time into the run of the tick with the longest response
+  double worst_tick_time = 0.0;
+  /// Duration of each publication of the producer
+  LatencyStats producer;
+  size_t producer_calls = 0;
+  size_t blocks_read = 0, blocks_dropped = 0;
+  size_t gil_holds = 0;
+  /// Whether the loop thread obtained real-time scheduling
+  bool realtime = false;
+  bool failed = false;
+  std::string error;
+};
+
+/**
+ * Fake 1 kHz robot loop that runs controllers and generators through the
+ * same control path as a connected Panda while injecting disturbances:
+ * CPU burners, delayed callbacks, threads holding the GIL and bursts of
+ * setpoint updates. Torque controllers drive a simulated plant, generators
+ * see their commands echoed back as robot state. Reports deadline misses,
+ * latency percentiles and blocking of the callback.
+ *
+ * Must be constructed with the GIL held, runs must release it.
+ */
+class StressTest {
+ public:
+  explicit StressTest(const StressSettings &settings);
+  ~StressTest();
+
+  const StressSettings &getSettings() const { return settings_; }
+
+  StressResult run(std::shared_ptr<TorqueController> controller);
+  StressResult run(std::shared_ptr<motion::Generator> generator);
+
+ private:
+  // Control callback of one tick, returns true once the motion finished
+  using Tick =
+      std::function<bool(const franka::RobotState &, franka::Duration)>;
+  // Turns the last command into the robot state of the next tick
+  using Advance = std::function<void(franka::RobotState &)>;
+
+  StressResult _run(const franka::RobotState &initial, const Tick &tick,
+                    const Advance &advance);
+
+  StressSettings settings_;
+  std::unique_ptr<Panda> panda_;
+};
+
+}  // namespace simulation
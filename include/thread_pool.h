@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Process-wide work-stealing thread pool used by all offline computations
+ * (batch kinematics, trajectory planning, validation). Workers keep local
+ * task deques and steal from each other when idle. CPUs reserved for the
+ * real-time control thread are excluded from the workers' affinity. Unless
+ * the caller excludes CPUs, the last CPU the process may run on is kept
+ * free of workers.
+ */
+class ThreadPool {
+ public:
+  enum class Priority { kHigh = 0, kNormal = 1, kLow = 2 };
+  static constexpr size_t kNumPriorities = 3;
+
+  using Task = std::function<void()>;
+
+  /// @brief The shared pool instance, created on first use
+  static ThreadPool &instance();
+
+  explicit ThreadPool(size_t num_threads = 0,
+                      const std::vector<int> &excluded_cpus = {});
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /** @brief Restart the workers with a new configuration. A size of 0 uses
+   *  all CPUs the process may run on, except the excluded ones. Without
+   *  excluded CPUs, the last CPU is excluded for the control thread. Pending
+   *  tasks are completed before the workers are replaced. */
+  void configure(size_t num_threads, const std::vector<int> &excluded_cpus);
+
+  size_t getNumThreads() const;
+  /// @brief CPUs excluded from the workers, including the default one
+  std::vector<int> getExcludedCpus() const;
+  /// @brief CPUs the workers may run on
+  std::vector<int> getCpus() const;
+
+  /// @brief Run a task asynchronously
+  void post(Task task, Priority priority = Priority::kNormal);
+
+  /// @brief Run a task asynchronously and obtain its result as future
+  template <typename Function>
+  auto submit(Function &&f, Priority priority = Priority::kNormal)
+      -> std::future<decltype(f())> {
+    using Result = decltype(f());
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+        std::forward<Function>(f));
+    auto future = task->get_future();
+    post([task]() { (*task)(); }, priority);
+    return future;
+  }
+
+  /** @brief Call `f(i)` for all `i` in `[0, n)` and block until done. The
+   *  calling thread participates, so nested calls from within pool tasks do
+   *  not deadlock. The first exception thrown by `f` is rethrown. */
+  void parallelFor(size_t n, const std::function<void(size_t)> &f,
+                   Priority priority = Priority::kNormal);
+
+ private:
+  struct Worker {
+    std::mutex mux;
+    std::deque<Task> tasks[kNumPriorities];
+  };
+
+  void _start(size_t num_threads, const std::vector<int> &excluded_cpus);
+  void _stop();
+  void _run(size_t index);
+  bool _pop(size_t index, Task &task);
+  void _pin(std::thread &thread);
+
+  mutable std::mutex config_mux_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::vector<int> excluded_cpus_, cpus_;
+
+  std::mutex sleep_mux_;
+  std::condition_variable sleep_cv_;
+  std::atomic<size_t> num_threads_{0};
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> next_worker_{0};
+  bool stopping_ = false;
+};
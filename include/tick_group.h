@@ -0,0 +1,165 @@
+#pragma once
+
+#include <franka/robot_state.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+
+/**
+ * Lock-free single-producer single-consumer triple buffer. The producer
+ * writes to `back()` and publishes it, the consumer picks up the most
+ * recently published buffer with `update()` and reads `front()`. Neither
+ * side ever blocks or allocates.
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  T &back() { return buffers_[back_]; }
+  T &front() { return buffers_[front_]; }
+  T &operator[](size_t i) { return buffers_[i]; }
+
+  /// @brief Producer: publish the back buffer
+  void publish() { back_ = middle_.exchange(back_ | kFresh) & kIndexMask; }
+
+  /// @brief Consumer: swap in the latest published buffer, if any
+  bool update() {
+    if (!(middle_.load() & kFresh)) return false;
+    front_ = middle_.exchange(front_) & kIndexMask;
+    return true;
+  }
+
+ private:
+  static constexpr uint8_t kFresh = 0x4;
+  static constexpr uint8_t kIndexMask = 0x3;
+
+  T buffers_[3];
+  uint8_t back_ = 0, front_ = 1;
+  std::atomic<uint8_t> middle_{2};
+};
+
+/**
+ * Exchanges blocks of consecutive robot states and setpoints between the
+ * real-time thread and Python. The real-time thread records every state
+ * and publishes a block once `block_size` states were collected. Python
+ * answers with a block of future setpoints that the real-time thread
+ * consumes one row per tick, holding the last row if it runs out.
+ */
+class TickGroup {
+ public:
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                        Eigen::RowMajor>
+      RowMatrixXd;
+
+  struct StateBlock {
+    RowMatrixXd q, dq, tau_J, tau_ext_hat_filtered, O_T_EE, O_F_ext_hat_K;
+    Eigen::VectorXd time;
+    uint64_t sequence = 0;
+  };
+
+  explicit TickGroup(size_t block_size) : block_size_(block_size) {
+    if (block_size == 0) {
+      throw std::invalid_argument("Block size must be positive.");
+    }
+    for (size_t i = 0; i < 3; i++) {
+      StateBlock &block = states_[i];
+      block.q.resize(block_size, 7);
+      block.dq.resize(block_size, 7);
+      block.tau_J.resize(block_size, 7);
+      block.tau_ext_hat_filtered.resize(block_size, 7);
+      block.O_T_EE.resize(block_size, 16);
+      block.O_F_ext_hat_K.resize(block_size, 6);
+      block.time.resize(block_size);
+    }
+  }
+
+  size_t getBlockSize() const { return block_size_; }
+
+  /// @brief Real-time thread: record a state, publish full blocks
+  void push(const franka::RobotState &state) {
+    StateBlock &block = states_.back();
+    const size_t i = index_;
+    block.q.row(i) = Eigen::Map<const Eigen::RowVectorXd>(state.q.data(), 7);
+    block.dq.row(i) = Eigen::Map<const Eigen::RowVectorXd>(state.dq.data(), 7);
+    block.tau_J.row(i) =
+        Eigen::Map<const Eigen::RowVectorXd>(state.tau_J.data(), 7);
+    block.tau_ext_hat_filtered.row(i) = Eigen::Map<const Eigen::RowVectorXd>(
+        state.tau_ext_hat_filtered.data(), 7);
+    block.O_T_EE.row(i) =
+        Eigen::Map<const Eigen::RowVectorXd>(state.O_T_EE.data(), 16);
+    block.O_F_ext_hat_K.row(i) =
+        Eigen::Map<const Eigen::RowVectorXd>(state.O_F_ext_hat_K.data(), 6);
+    block.time[i] = state.time.toSec();
+    if (++index_ == block_size_) {
+      index_ = 0;
+      // Publish the block before its sequence, so a consumer woken up by
+      // the new sequence always finds the block in the middle slot
+      const uint64_t sequence =
+          sequence_.load(std::memory_order_relaxed) + 1;
+      block.sequence = sequence;
+      states_.publish();
+      sequence_.store(sequence, std::memory_order_release);
+      cv_.notify_one();
+    }
+  }
+
+  /** @brief Real-time thread: setpoint for the current tick or null if
+   *  Python has not provided any yet. */
+  const double *nextSetpoint(size_t &dim) {
+    if (setpoints_.update()) row_ = 0;
+    const RowMatrixXd &setpoints = setpoints_.front();
+    if (setpoints.rows() == 0) return nullptr;
+    const Eigen::Index row = std::min<Eigen::Index>(row_, setpoints.rows() - 1);
+    row_++;
+    dim = setpoints.cols();
+    return setpoints.data() + row * setpoints.cols();
+  }
+
+  /** @brief Python thread: wait until a new block was published. Returns
+   *  false on timeout. */
+  bool wait(double timeout) {
+    std::unique_lock<std::mutex> lock(mux_);
+    // The producer doesn't lock, so wake up periodically to re-check.
+    // read() may already have picked up a block whose sequence isn't
+    // stored yet, hence the comparison instead of inequality.
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration<double>(timeout);
+    while (sequence_.load(std::memory_order_acquire) <= consumed_) {
+      if (std::chrono::steady_clock::now() >= deadline) return false;
+      cv_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  /// @brief Python thread: latest published block
+  const StateBlock &read() {
+    states_.update();
+    consumed_ = states_.front().sequence;
+    return states_.front();
+  }
+
+  /** @brief Python thread: provide a block of future setpoints. The first
+   *  row is applied at the next tick. */
+  void setSetpoints(const Eigen::Ref<const RowMatrixXd> &setpoints) {
+    setpoints_.back() = setpoints;
+    setpoints_.publish();
+  }
+
+  uint64_t getSequence() const { return sequence_; }
+
+ private:
+  const size_t block_size_;
+  TripleBuffer<StateBlock> states_;
+  TripleBuffer<RowMatrixXd> setpoints_;
+  size_t index_ = 0;
+  Eigen::Index row_ = 0;
+  std::atomic<uint64_t> sequence_{0};
+  uint64_t consumed_ = 0;
+  std::mutex mux_;
+  std::condition_variable cv_;
+};
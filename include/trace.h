@@ -0,0 +1,144 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace py = pybind11;
+
+/**
+ * Opt-in process-wide timeline of scoped events, exported in the Chrome
+ * trace event format that Perfetto and chrome://tracing open. Every thread
+ * records into its own ring buffer that keeps the most recent events, so
+ * recording neither locks nor allocates except for a thread's first event.
+ * Real-time threads acquire their buffer before entering the loop and skip
+ * events instead of acquiring one while running.
+ * Buffers of finished threads are kept for export and handed to new
+ * threads, e.g. the next control thread, once their events are overwritten.
+ * Event names must outlive the tracer, use string literals or intern().
+ */
+class Tracer {
+ public:
+  static constexpr size_t kDefaultBufferSize = 65536;
+
+  struct Stats {
+    size_t buffers = 0, events = 0, overwritten = 0;
+  };
+
+  /// @brief The shared tracer instance, created on first use
+  static Tracer &instance();
+
+  /// @brief Nanoseconds on the steady clock
+  static int64_t now();
+
+  /** @brief Start recording with room for `buffer_size` events per thread.
+   *  Events recorded so far are dropped. */
+  void enable(size_t buffer_size = kDefaultBufferSize);
+  void disable();
+  bool isEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+  size_t getBufferSize() const;
+  /// @brief Drop all recorded events
+  void clear();
+  Stats getStats() const;
+
+  /// @brief Record an event of the calling thread that spans [start, end]
+  void record(const char *category, const char *name, int64_t start,
+              int64_t end);
+  /// @brief Record an event of the calling thread without duration
+  void instant(const char *category, const char *name);
+
+  /// @brief Name shown for the calling thread
+  void setThreadName(const std::string &name);
+  /** @brief Mark the calling thread as real-time and acquire its buffer if
+   *  tracing is enabled. Afterwards the thread never locks or allocates to
+   *  record, its events are skipped while it has no current buffer, e.g.
+   *  after enable() or clear(). */
+  void prepareRealTimeThread();
+  /// @brief Stable copy of a dynamic event name
+  const char *intern(const std::string &name);
+
+  /// @brief Recorded events as Chrome trace JSON
+  std::string exportJson() const;
+  /// @brief Write exportJson() to `path`, returns the number of events
+  size_t save(const std::string &path) const;
+
+ private:
+  struct Event {
+    const char *category;
+    const char *name;
+    int64_t start, duration;
+    uint32_t tid;
+  };
+
+  struct Buffer {
+    explicit Buffer(size_t size) : events(size) {}
+    std::vector<Event> events;
+    // Number of events ever written, only advanced by the owning thread
+    std::atomic<uint64_t> head{0};
+    std::atomic<bool> owned{true};
+  };
+
+  Tracer() = default;
+
+  Buffer *_buffer();
+  Buffer *_acquire();
+  size_t _export(std::ostream &os) const;
+  void _write(const char *category, const char *name, int64_t start,
+              int64_t duration);
+
+  mutable std::mutex mux_;
+  std::atomic<bool> enabled_{false};
+  // Bumped when buffers are dropped, threads then acquire new ones
+  std::atomic<uint64_t> generation_{1};
+  size_t buffer_size_ = kDefaultBufferSize;
+  std::vector<std::shared_ptr<Buffer>> buffers_;
+  std::map<uint32_t, std::string> thread_names_;
+  std::unordered_set<std::string> names_;
+};
+
+/// @brief Records the lifetime of the scope if tracing is enabled
+class TraceScope {
+ public:
+  TraceScope(const char *category, const char *name)
+      : category_(category),
+        name_(name),
+        start_(Tracer::instance().isEnabled() ? Tracer::now() : -1) {}
+  ~TraceScope() {
+    if (start_ >= 0) {
+      Tracer::instance().record(category_, name_, start_, Tracer::now());
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  const char *category_, *name_;
+  int64_t start_;
+};
+
+/** @brief Acquires the GIL like py::gil_scoped_acquire and records the time
+ *  spent waiting for it */
+class TracedGilAcquire {
+ public:
+  explicit TracedGilAcquire(const char *name)
+      : start_(Tracer::instance().isEnabled() ? Tracer::now() : -1) {
+    if (start_ >= 0) {
+      Tracer::instance().record("gil", name, start_, Tracer::now());
+    }
+  }
+
+ private:
+  int64_t start_;
+  py::gil_scoped_acquire acquire_;
+};
@@ -1,21 +1,31 @@
 #include <functional>
+#include <optional>
+#include <stdexcept>
 
 #include <franka/exception.h>
 #include <pybind11/chrono.h>
 #include <pybind11/eigen.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include "batch_model.h"
 #include "controllers/applied_force.h"
 #include "controllers/applied_torque.h"
 #include "controllers/cartesian_impedance.h"
 #include "controllers/force.h"
+#include "controllers/hybrid_force_impedance.h"
 #include "controllers/integrated_velocity.h"
 #include "controllers/joint_position.h"
+#include "controllers/joint_mpc.h"
+#include "controllers/time_scaling.h"
+#include "controllers/trajectory_follower.h"
 // #include "generators/joint_position.h"
 #include "kinematics/fk.h"
 #include "kinematics/ik.h"
+#include "kinematics/kinematics.h"
+#include "model_cache.h"
 #include "motion/cartesian_motion.hpp"
 #include "motion/generators.h"
 #include "motion/joint_motion.hpp"
@@ -23,13 +33,89 @@
 #include "motion/cartesian_motion_generator.hpp"
 #include "motion/generator.h"
 #include "motion/joint_motion_generator.hpp"
+#include "motion/joint_trajectory_generator.hpp"
+#include "motion/jerk_limited_trajectory.h"
 #include "motion/motion_data.hpp"
+#include "motion/trajectory_future.h"
+#include "motion/trajectory_set.h"
+#include "motion/velocity_stream_generator.hpp"
 #include "panda.h"
+#include "simulation/rollout.h"
+#include "simulation/cycle_time.h"
+#include "simulation/stress.h"
+#include "thread_pool.h"
+#include "trace.h"
 
 namespace py = pybind11;
 
 using namespace pybind11::literals;
 
+typedef py::array_t<double, py::array::c_style | py::array::forcecast>
+    DoubleArray;
+
+// Number of rows of a batch of joint vectors
+size_t jointRows(const DoubleArray &array, const char *name) {
+  if (array.ndim() != 2 || array.shape(1) != 7) {
+    throw std::invalid_argument(std::string(name) +
+                                " must have shape (N, 7).");
+  }
+  return array.shape(0);
+}
+
+// Per-waypoint scale from None, a scalar or one value per waypoint, empty
+// for the default
+std::vector<double> waypointScales(const py::object &scale, size_t count,
+                                   const char *name) {
+  if (scale.is_none()) return {};
+  DoubleArray values = py::cast<DoubleArray>(scale);
+  if (values.size() == 1) {
+    return std::vector<double>(count, *values.data());
+  }
+  if (static_cast<size_t>(values.size()) != count) {
+    throw std::invalid_argument(std::string(name) +
+                                " must be a scalar or hold one value per "
+                                "waypoint.");
+  }
+  return std::vector<double>(values.data(), values.data() + count);
+}
+
+const double *scaleData(const std::vector<double> &scales) {
+  return scales.empty() ? nullptr : scales.data();
+}
+
+template <typename Trajectory>
+void bindTrajectoryFuture(py::module &m, const char *name) {
+  using Future = motion::TrajectoryFuture<Trajectory>;
+  py::class_<Future, std::shared_ptr<Future>>(m, name, R"delim(
+          Trajectory computed in the background, see `compute_async`. Can be
+          awaited from asyncio and trio coroutines.
+      )delim")
+      .def("result", &Future::get, py::arg("timeout") = -1.0,
+           py::call_guard<py::gil_scoped_release>(), R"delim(
+               Wait for the trajectory and return it. Raises the error of a
+               failed computation, or if the computation was cancelled or
+               `timeout` seconds passed. A negative timeout waits
+               indefinitely.
+           )delim")
+      .def("wait", &Future::wait, py::arg("timeout") = -1.0,
+           py::call_guard<py::gil_scoped_release>(), R"delim(
+               Wait until done, returns whether the future is done.
+           )delim")
+      .def("cancel", &Future::cancel, R"delim(
+               Cancel the computation. Pending computations are skipped,
+               running ones complete but their result is discarded. Returns
+               False if the computation has already finished.
+           )delim")
+      .def("cancelled", &Future::isCancelled)
+      .def("running", &Future::isRunning)
+      .def("done", &Future::isDone)
+      .def("add_done_callback", &Future::addDoneCallback, py::arg("callback"),
+           R"delim(
+               Call `callback` without arguments once done, right away if the
+               future is already done. Runs on a background thread.
+           )delim");
+}
+
 PYBIND11_MODULE(_core, m) {
   py::module::import("panda_py.libfranka");
   py::options options;
@@ -42,6 +128,295 @@ PYBIND11_MODULE(_core, m) {
   m.attr("_TAU_J_MAX") = kTauJMax;
   m.attr("_DTAU_J_MAX") = kDTauJMax;
 
+  py::enum_<ThreadPool::Priority>(m, "TaskPriority")
+      .value("HIGH", ThreadPool::Priority::kHigh)
+      .value("NORMAL", ThreadPool::Priority::kNormal)
+      .value("LOW", ThreadPool::Priority::kLow);
+
+  m.def(
+      "configure_thread_pool",
+      [](size_t num_threads, const std::vector<int> &excluded_cpus) {
+        ThreadPool::instance().configure(num_threads, excluded_cpus);
+      },
+      py::arg("num_threads") = 0, py::arg("excluded_cpus") = std::vector<int>(),
+      py::call_guard<py::gil_scoped_release>(), R"delim(
+          Configure the process-wide thread pool used by all parallel
+          computations of panda-py.
+
+          Args:
+            num_threads: Number of worker threads. If 0, all CPUs available
+              to the process except the excluded ones are used.
+            excluded_cpus: CPUs the workers must not run on, e.g. the core
+              reserved for the real-time control thread. If empty, the last
+              CPU available to the process is excluded.
+      )delim");
+  m.def(
+      "get_thread_pool_config",
+      []() {
+        auto &pool = ThreadPool::instance();
+        py::dict config;
+        config["num_threads"] = pool.getNumThreads();
+        config["excluded_cpus"] = pool.getExcludedCpus();
+        config["cpus"] = pool.getCpus();
+        return config;
+      },
+      R"delim(
+          Get the configuration of the process-wide thread pool.
+      )delim");
+
+  m.def(
+      "configure_model_cache",
+      [](bool enabled) { ModelCache::instance().setEnabled(enabled); },
+      py::arg("enabled") = true, R"delim(
+          Configure the process-wide robot model cache. Loading the model
+          downloads the model library from the robot, cached models are
+          shared by all :py:class:`Panda` instances connected to the same
+          robot running the same server version.
+
+          Args:
+            enabled: Share models within the process.
+      )delim");
+  m.def(
+      "set_model_loader",
+      [](std::optional<py::function> loader) {
+        if (!loader) {
+          ModelCache::instance().setLoader(nullptr);
+          return;
+        }
+        // The cache copies its loader without the GIL, Python objects are
+        // shared through pointers released with the GIL
+        std::shared_ptr<py::function> function(
+            new py::function(*loader), [](py::function *function) {
+              py::gil_scoped_acquire acquire;
+              delete function;
+            });
+        ModelCache::instance().setLoader([function](franka::Robot &robot) {
+          py::gil_scoped_acquire acquire;
+          py::object result =
+              (*function)(py::cast(&robot, py::return_value_policy::reference));
+          auto *model = result.cast<franka::Model *>();
+          auto *owner = new py::object(std::move(result));
+          return std::shared_ptr<franka::Model>(model, [owner](franka::Model *) {
+            py::gil_scoped_acquire acquire;
+            delete owner;
+          });
+        });
+      },
+      py::arg("loader"), R"delim(
+          Replace the loader of the robot model cache, e.g. with a stand-in
+          for testing. Cached models are kept.
+
+          Args:
+            loader: Called with the connected :py:class:`libfranka.Robot`
+              on a cache miss, returns its :py:class:`libfranka.Model`.
+              None restores the default loader, which downloads the model
+              from the robot.
+      )delim");
+  m.def(
+      "get_model_cache_stats",
+      []() {
+        auto stats = ModelCache::instance().getStats();
+        py::dict result;
+        result["loads"] = stats.loads;
+        result["memory_hits"] = stats.memory_hits;
+        return result;
+      },
+      R"delim(
+          Get the number of models loaded from the robot and taken from
+          memory.
+      )delim");
+  m.def(
+      "clear_model_cache", []() { ModelCache::instance().clear(); },
+      R"delim(
+          Drop all robot models cached in memory.
+      )delim");
+
+  // Batched evaluation on libfranka's Model class, bound by the libfranka
+  // module
+  auto model_class = py::reinterpret_borrow<py::class_<franka::Model>>(
+      py::module::import("panda_py.libfranka").attr("Model"));
+  auto jacobian_batch = [](auto method) {
+    return [method](const franka::Model &model, franka::Frame frame,
+                    const DoubleArray &q, const std::array<double, 16> &F_T_EE,
+                    const std::array<double, 16> &EE_T_K,
+                    ThreadPool::Priority priority) {
+      const size_t n = jointRows(q, "q");
+      py::array_t<double> jacobians({n, size_t(6), size_t(7)});
+      double *out = jacobians.mutable_data();
+      {
+        py::gil_scoped_release release;
+        (BatchModel(model, priority).*method)(frame, q.data(), n, F_T_EE,
+                                              EE_T_K, out);
+      }
+      return jacobians;
+    };
+  };
+  model_class
+      .def(
+          "pose_batch",
+          [](const franka::Model &model, franka::Frame frame,
+             const DoubleArray &q, const std::array<double, 16> &F_T_EE,
+             const std::array<double, 16> &EE_T_K,
+             ThreadPool::Priority priority) {
+            const size_t n = jointRows(q, "q");
+            py::array_t<double> poses({n, size_t(4), size_t(4)});
+            double *out = poses.mutable_data();
+            {
+              py::gil_scoped_release release;
+              BatchModel(model, priority)
+                  .pose(frame, q.data(), n, F_T_EE, EE_T_K, out);
+            }
+            return poses;
+          },
+          py::arg("frame"), py::arg("q"), py::arg("F_T_EE"),
+          py::arg("EE_T_K"),
+          py::arg("priority") = ThreadPool::Priority::kNormal,
+          R"delim(
+              Poses of `frame` for each row of `q` (N x 7) as array of
+              4x4 matrices (N x 4 x 4). Like all batched methods, the
+              configurations are evaluated on the process-wide thread
+              pool without holding the GIL.
+          )delim")
+      .def("body_jacobian_batch", jacobian_batch(&BatchModel::bodyJacobian),
+           py::arg("frame"), py::arg("q"), py::arg("F_T_EE"),
+           py::arg("EE_T_K"),
+           py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Body Jacobians of `frame` for each row of `q` (N x 6 x 7).
+          )delim")
+      .def("zero_jacobian_batch", jacobian_batch(&BatchModel::zeroJacobian),
+           py::arg("frame"), py::arg("q"), py::arg("F_T_EE"),
+           py::arg("EE_T_K"),
+           py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Zero Jacobians of `frame` for each row of `q` (N x 6 x 7).
+          )delim")
+      .def(
+          "mass_batch",
+          [](const franka::Model &model, const DoubleArray &q,
+             const std::array<double, 9> &I_total, double m_total,
+             const std::array<double, 3> &F_x_Ctotal,
+             ThreadPool::Priority priority) {
+            const size_t n = jointRows(q, "q");
+            py::array_t<double> mass({n, size_t(7), size_t(7)});
+            double *out = mass.mutable_data();
+            {
+              py::gil_scoped_release release;
+              BatchModel(model, priority)
+                  .mass(q.data(), n, {I_total, m_total, F_x_Ctotal}, out);
+            }
+            return mass;
+          },
+          py::arg("q"), py::arg("I_total"), py::arg("m_total"),
+          py::arg("F_x_Ctotal"),
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Joint space inertia matrices for each row of `q`
+              (N x 7 x 7).
+          )delim")
+      .def(
+          "coriolis_batch",
+          [](const franka::Model &model, const DoubleArray &q,
+             const DoubleArray &dq, const std::array<double, 9> &I_total,
+             double m_total, const std::array<double, 3> &F_x_Ctotal,
+             ThreadPool::Priority priority) {
+            const size_t n = jointRows(q, "q");
+            if (jointRows(dq, "dq") != n) {
+              throw std::invalid_argument(
+                  "q and dq must have the same number of rows.");
+            }
+            py::array_t<double> coriolis({n, size_t(7)});
+            double *out = coriolis.mutable_data();
+            {
+              py::gil_scoped_release release;
+              BatchModel(model, priority)
+                  .coriolis(q.data(), dq.data(), n,
+                            {I_total, m_total, F_x_Ctotal}, out);
+            }
+            return coriolis;
+          },
+          py::arg("q"), py::arg("dq"), py::arg("I_total"), py::arg("m_total"),
+          py::arg("F_x_Ctotal"),
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Coriolis torques for each row of `q` and `dq` (N x 7).
+          )delim")
+      .def(
+          "gravity_batch",
+          [](const franka::Model &model, const DoubleArray &q, double m_total,
+             const std::array<double, 3> &F_x_Ctotal,
+             const std::array<double, 3> &gravity_earth,
+             ThreadPool::Priority priority) {
+            const size_t n = jointRows(q, "q");
+            py::array_t<double> gravity({n, size_t(7)});
+            double *out = gravity.mutable_data();
+            {
+              py::gil_scoped_release release;
+              BatchModel(model, priority)
+                  .gravity(q.data(), n, {{}, m_total, F_x_Ctotal},
+                           gravity_earth, out);
+            }
+            return gravity;
+          },
+          py::arg("q"), py::arg("m_total"), py::arg("F_x_Ctotal"),
+          py::arg("gravity_earth") = std::array<double, 3>{0., 0., -9.81},
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Gravity torques for each row of `q` (N x 7).
+          )delim");
+
+  m.def(
+      "configure_tracing",
+      [](bool enabled, size_t buffer_size) {
+        auto &tracer = Tracer::instance();
+        if (enabled) {
+          tracer.enable(buffer_size);
+        } else {
+          tracer.disable();
+        }
+      },
+      py::arg("enabled") = true,
+      py::arg("buffer_size") = Tracer::kDefaultBufferSize, R"delim(
+          Record a timeline of control ticks, controller and generator
+          switches, error recovery, trajectory computations, GIL
+          acquisitions and done callbacks. Every thread keeps its most
+          recent events in a ring buffer, an event costs two clock reads,
+          typically well below a microsecond. Enabling drops previously
+          recorded events. Control loops acquire their buffer when they
+          start, a loop already running when tracing is enabled or cleared
+          is recorded from its next start.
+
+          Args:
+            enabled: Record events, recorded events are kept when disabled.
+            buffer_size: Number of events kept per thread.
+      )delim");
+  m.def(
+      "save_trace", [](const std::string &path) {
+        return Tracer::instance().save(path);
+      },
+      py::arg("path"), py::call_guard<py::gil_scoped_release>(), R"delim(
+          Write the recorded events in the Chrome trace event format to
+          `path`, which can be opened with https://ui.perfetto.dev or
+          chrome://tracing. Returns the number of events written.
+      )delim");
+  m.def(
+      "get_trace_stats",
+      []() {
+        auto &tracer = Tracer::instance();
+        auto stats = tracer.getStats();
+        py::dict result;
+        result["enabled"] = tracer.isEnabled();
+        result["buffer_size"] = tracer.getBufferSize();
+        result["buffers"] = stats.buffers;
+        result["events"] = stats.events;
+        result["overwritten"] = stats.overwritten;
+        return result;
+      },
+      R"delim(
+          Get the number of per-thread buffers, of recorded events and of
+          events overwritten by newer ones.
+      )delim");
+  m.def(
+      "clear_trace", []() { Tracer::instance().clear(); },
+      R"delim(
+          Drop all recorded events.
+      )delim");
+
   m.def("ik_full",
         py::overload_cast<Eigen::Matrix<double, 4, 4>, Vector7d, double>(
             &kinematics::ik_full),
@@ -84,21 +459,365 @@ PYBIND11_MODULE(_core, m) {
      Computes end-effector pose in base frame from joint positions.
   )delim");
 
-  py::class_<motion::JointTrajectory>(m, "JointTrajectory")
+  py::class_<kinematics::Kinematics, std::shared_ptr<kinematics::Kinematics>>(
+      m, "Kinematics", R"delim(
+          Forward and inverse kinematics for a tool mounted on the flange.
+          The tool transform is folded into the analytical solutions once,
+          so the methods cost about the same as :py:func:`fk` and
+          :py:func:`ik` for the Franka Hand. Pass it to
+          :py:meth:`Panda.set_kinematics` to make the tool the robot's end
+          effector for controllers and generators.
+      )delim")
+      .def(py::init<const Eigen::Matrix4d &>(),
+           py::arg("F_T_EE") = kinematics::Kinematics::kFrankaHand, R"delim(
+              Args:
+                F_T_EE: Homogeneous transform from the flange to the tool
+                  frame, defaults to the Franka Hand.
+          )delim")
+      .def_property_readonly("F_T_EE", &kinematics::Kinematics::getTransform)
+      .def("fk",
+           py::overload_cast<const Vector7d &>(&kinematics::Kinematics::fk,
+                                               py::const_),
+           py::arg("q"), R"delim(
+              Pose of the tool frame in the base frame.
+          )delim")
+      .def("ik",
+           py::overload_cast<const Eigen::Matrix4d &, const Vector7d &, double>(
+               &kinematics::Kinematics::ik, py::const_),
+           py::arg("O_T_EE"), py::arg("q_init") = kinematics::kQDefault,
+           py::arg("q_7") = M_PI_4, R"delim(
+              Joint positions placing the tool frame at `O_T_EE`, see
+              :py:func:`ik`.
+          )delim")
+      .def(
+          "ik",
+          [](const kinematics::Kinematics &kinematics,
+             const Eigen::Vector3d &position,
+             const Eigen::Vector4d &orientation, const Vector7d &q_init,
+             double q_7) {
+            return kinematics.ik(
+                PositionOrientationToMatrix(position, orientation), q_init,
+                q_7);
+          },
+          py::arg("position"), py::arg("orientation"),
+          py::arg("q_init") = kinematics::kQDefault, py::arg("q_7") = M_PI_4)
+      .def("ik_full", &kinematics::Kinematics::ikFull, py::arg("O_T_EE"),
+           py::arg("q_init") = kinematics::kQDefault, py::arg("q_7") = M_PI_4,
+           R"delim(
+              All four solutions placing the tool frame at `O_T_EE`, see
+              :py:func:`ik_full`.
+          )delim")
+      .def(
+          "fk_batch",
+          [](const kinematics::Kinematics &kinematics, const DoubleArray &q,
+             ThreadPool::Priority priority) {
+            const size_t n = jointRows(q, "q");
+            py::array_t<double> poses({n, size_t(4), size_t(4)});
+            double *out = poses.mutable_data();
+            {
+              py::gil_scoped_release release;
+              kinematics.fk(q.data(), n, out, priority);
+            }
+            return poses;
+          },
+          py::arg("q"), py::arg("priority") = ThreadPool::Priority::kNormal,
+          R"delim(
+              Tool poses (N x 4 x 4) for each row of `q` (N x 7), computed on
+              the process-wide thread pool without holding the GIL.
+          )delim")
+      .def(
+          "ik_batch",
+          [](const kinematics::Kinematics &kinematics,
+             const DoubleArray &O_T_EE, const DoubleArray &q_init,
+             const DoubleArray &q_7, ThreadPool::Priority priority) {
+            if (O_T_EE.ndim() != 3 || O_T_EE.shape(1) != 4 ||
+                O_T_EE.shape(2) != 4) {
+              throw std::invalid_argument("Poses must have shape (N, 4, 4).");
+            }
+            const size_t n = O_T_EE.shape(0);
+            const bool per_pose_init = q_init.ndim() == 2;
+            if (per_pose_init ? jointRows(q_init, "q_init") != n
+                              : q_init.ndim() != 1 || q_init.shape(0) != 7) {
+              throw std::invalid_argument(
+                  "q_init must have shape (7,) or (N, 7).");
+            }
+            const bool per_pose_q7 = q_7.ndim() == 1;
+            if (per_pose_q7 ? static_cast<size_t>(q_7.shape(0)) != n
+                            : q_7.ndim() != 0) {
+              throw std::invalid_argument("q_7 must be a scalar or (N,).");
+            }
+            py::array_t<double> q({n, size_t(7)});
+            double *out = q.mutable_data();
+            {
+              py::gil_scoped_release release;
+              kinematics.ik(O_T_EE.data(), n, q_init.data(), per_pose_init,
+                            q_7.data(), per_pose_q7, out, priority);
+            }
+            return q;
+          },
+          py::arg("O_T_EE"), py::arg("q_init") = kinematics::kQDefault,
+          py::arg("q_7") = M_PI_4,
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Joint positions (N x 7) placing the tool frame at each pose
+              (N x 4 x 4), computed on the process-wide thread pool without
+              holding the GIL. Rows without solution are NaN.
+
+              Args:
+                O_T_EE: Tool poses.
+                q_init: Reference configuration, one for all poses (7,) or
+                  one per pose (N x 7).
+                q_7: Position of joint 7, a scalar or one per pose.
+                priority: Priority of the computation on the thread pool.
+          )delim")
+      .def(
+          "ik_path",
+          [](const kinematics::Kinematics &kinematics,
+             const DoubleArray &O_T_EE, const Vector7d &q_init,
+             double q7_resolution, double max_q7_step, double max_joint_step,
+             double limit_margin, double limit_weight,
+             size_t refinement_iterations, ThreadPool::Priority priority) {
+            if (O_T_EE.ndim() != 3 || O_T_EE.shape(1) != 4 ||
+                O_T_EE.shape(2) != 4) {
+              throw std::invalid_argument("Poses must have shape (N, 4, 4).");
+            }
+            kinematics::PathIkSettings settings;
+            settings.q7_resolution = q7_resolution;
+            settings.max_q7_step = max_q7_step;
+            settings.max_joint_step = max_joint_step;
+            settings.limit_margin = limit_margin;
+            settings.limit_weight = limit_weight;
+            settings.refinement_iterations = refinement_iterations;
+            const size_t n = O_T_EE.shape(0);
+            py::array_t<double> q({n, size_t(7)});
+            double *out = q.mutable_data();
+            {
+              py::gil_scoped_release release;
+              kinematics.ikPath(O_T_EE.data(), n, q_init, settings, out,
+                                priority);
+            }
+            return q;
+          },
+          py::arg("O_T_EE"), py::arg("q_init") = kinematics::kQDefault,
+          py::arg("q7_resolution") = kinematics::PathIkSettings().q7_resolution,
+          py::arg("max_q7_step") = kinematics::PathIkSettings().max_q7_step,
+          py::arg("max_joint_step") =
+              kinematics::PathIkSettings().max_joint_step,
+          py::arg("limit_margin") = kinematics::PathIkSettings().limit_margin,
+          py::arg("limit_weight") = kinematics::PathIkSettings().limit_weight,
+          py::arg("refinement_iterations") =
+              kinematics::PathIkSettings().refinement_iterations,
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Joint path (N x 7) through a densely sampled Cartesian path
+              (N x 4 x 4) with the position of joint 7 chosen along the
+              whole path, rather than fixed per pose like in
+              :py:meth:`ik_batch`. Solutions are evaluated on a grid of q7
+              values for all poses on the process-wide thread pool, dynamic
+              programming selects the q7 profile that best trades the
+              distance from the center of the joint ranges against
+              smoothness, and Gauss-Newton iterations refine it between
+              the grid values. Runs without holding the GIL.
+
+              Args:
+                O_T_EE: Tool poses along the path.
+                q_init: Reference configuration selecting the solution
+                  branch, the first solution is pulled towards it.
+                q7_resolution: Spacing of the q7 grid.
+                max_q7_step: Largest change of q7 between poses.
+                max_joint_step: Largest change of any joint between poses.
+                limit_margin: Distance all joints keep from their limits.
+                limit_weight: Weight of the distance from the center of the
+                  joint ranges against smoothness.
+                refinement_iterations: Gauss-Newton iterations.
+                priority: Priority of the computation on the thread pool.
+
+              Raises:
+                RuntimeError: If no path within the limits reaches all
+                  poses.
+          )delim");
+
+  bindTrajectoryFuture<motion::JointTrajectory>(m, "JointTrajectoryFuture");
+  bindTrajectoryFuture<motion::CartesianTrajectory>(
+      m, "CartesianTrajectoryFuture");
+
+  py::class_<motion::JointTrajectory, std::shared_ptr<motion::JointTrajectory>>(
+      m, "JointTrajectory")
       .def(py::init<const std::vector<Vector7d> &, double, double, double>(),
            py::arg("waypoints"),
            py::arg("speed_factor") = motion::kDefaultJointSpeedFactor,
            py::arg("max_deviation") = 0,
            py::arg("timeout") = motion::kDefaultTimeout)
+      .def_static(
+          "compute_async",
+          [](const std::vector<Vector7d> &waypoints, double speed_factor,
+             double max_deviation, double timeout,
+             ThreadPool::Priority priority) {
+            return motion::TrajectoryFuture<motion::JointTrajectory>::submit(
+                [=]() {
+                  return std::make_shared<motion::JointTrajectory>(
+                      waypoints, speed_factor, max_deviation, timeout);
+                },
+                priority);
+          },
+          py::arg("waypoints"),
+          py::arg("speed_factor") = motion::kDefaultJointSpeedFactor,
+          py::arg("max_deviation") = 0,
+          py::arg("timeout") = motion::kDefaultTimeout,
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Compute the trajectory in the background on the shared thread
+              pool. Takes the same arguments as the constructor.
+
+              Args:
+                priority: Scheduling priority among pending computations.
+
+              Returns:
+                :py:class:`JointTrajectoryFuture` holding the trajectory.
+          )delim")
       .def("get_duration", &motion::JointTrajectory::getDuration)
       .def("get_joint_positions", &motion::JointTrajectory::getJointPositions,
            py::arg("time"))
       .def("get_joint_velocities", &motion::JointTrajectory::getJointVelocities,
            py::arg("time"))
       .def("get_joint_accelerations",
-           &motion::JointTrajectory::getJointAccelerations, py::arg("time"));
+           &motion::JointTrajectory::getJointAccelerations, py::arg("time"))
+      .def("compile", &motion::JointTrajectory::compile,
+           py::call_guard<py::gil_scoped_release>(), R"delim(
+               Convert the trajectory into contiguous piecewise-polynomial
+               form, used by :py:meth:`sample` and the trajectory followers to
+               evaluate position, velocity and acceleration in a single pass
+               without walking the path. The compiled form interpolates the
+               integration steps of the time-optimal trajectory, so its
+               velocities and accelerations differ slightly from the
+               `get_joint_*` methods, which always evaluate the trajectory itself.
+           )delim")
+      .def_property_readonly("compiled", &motion::JointTrajectory::isCompiled)
+      .def("sample", &motion::JointTrajectory::sample, py::arg("times"),
+           py::call_guard<py::gil_scoped_release>(), R"delim(
+               Evaluate the trajectory at many points in time. Compiles the
+               trajectory on first use.
+
+               Args:
+                 times: Vector of shape (N,) holding the sample times.
+
+               Returns:
+                 Tuple of joint positions, velocities and accelerations,
+                 each of shape (N, 7).
+           )delim");
+
+  py::class_<motion::JerkLimitedTrajectory,
+             std::shared_ptr<motion::JerkLimitedTrajectory>>(
+      m, "JerkLimitedTrajectory", R"delim(
+          Jerk-limited version of a joint trajectory for execution on the
+          joint position interface, see :py:class:`JointTrajectoryGenerator`.
+          Unblended waypoints become stops and acceleration jumps become jerk
+          ramps, roughly acceleration over jerk long. The result is a quintic
+          spline that respects the velocity, acceleration and jerk limits. The
+          trajectory is only slowed down if it would otherwise leave the limits
+          or deviate from its path by more than `max_deviation`.
+      )delim")
+      .def(py::init<std::shared_ptr<motion::JointTrajectory>, const Vector7d &,
+                    double, double>(),
+           py::arg("trajectory"),
+           py::arg("max_jerk") = motion::JerkLimitedTrajectory::kDefaultMaxJerk,
+           py::arg("max_deviation") =
+               motion::JerkLimitedTrajectory::kDefaultMaxDeviation,
+           py::arg("knot_spacing") =
+               motion::JerkLimitedTrajectory::kDefaultKnotSpacing,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_duration", &motion::JerkLimitedTrajectory::getDuration)
+      .def("get_joint_positions",
+           &motion::JerkLimitedTrajectory::getJointPositions, py::arg("time"))
+      .def("get_joint_velocities",
+           &motion::JerkLimitedTrajectory::getJointVelocities, py::arg("time"))
+      .def("get_joint_accelerations",
+           &motion::JerkLimitedTrajectory::getJointAccelerations,
+           py::arg("time"))
+      .def("sample", &motion::JerkLimitedTrajectory::sample, py::arg("times"),
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("time_scale",
+                             &motion::JerkLimitedTrajectory::getTimeScale,
+                             R"delim(
+               Factor by which the trajectory was slowed down, 1 if it wasn't.
+           )delim")
+      .def_property_readonly("deviation",
+                             &motion::JerkLimitedTrajectory::getDeviation,
+                             R"delim(
+               Largest position deviation from the path of the time-optimal
+               trajectory.
+           )delim");
+
+  py::class_<motion::TrajectorySet>(m, "TrajectorySet", R"delim(
+          Collection of joint trajectories that are evaluated at common
+          points in time. Evaluation is parallelised over trajectories and
+          each trajectory is compiled on first use.
+      )delim")
+      .def(py::init<const std::vector<std::shared_ptr<motion::JointTrajectory>> &,
+                    ThreadPool::Priority>(),
+           py::arg("trajectories") =
+               std::vector<std::shared_ptr<motion::JointTrajectory>>(),
+           py::arg("priority") = ThreadPool::Priority::kNormal)
+      .def("add", &motion::TrajectorySet::add, py::arg("trajectory"))
+      .def("clear", &motion::TrajectorySet::clear)
+      .def("__len__", &motion::TrajectorySet::size)
+      .def("__getitem__", &motion::TrajectorySet::get, py::arg("index"))
+      .def("compile", &motion::TrajectorySet::compile,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_durations", &motion::TrajectorySet::getDurations)
+      .def_property("priority", &motion::TrajectorySet::getPriority,
+                    &motion::TrajectorySet::setPriority)
+      .def(
+          "get_joint_positions",
+          [](motion::TrajectorySet &set,
+             const py::array_t<double, py::array::c_style |
+                                           py::array::forcecast> &times) {
+            const size_t num_times = times.size();
+            py::array_t<double> q({set.size(), num_times, size_t(7)});
+            const double *t = times.data();
+            double *q_ptr = q.mutable_data();
+            {
+              py::gil_scoped_release release;
+              set.evaluate(t, num_times, q_ptr, nullptr, nullptr);
+            }
+            return q;
+          },
+          py::arg("times"), R"delim(
+              Evaluate the joint positions of all trajectories.
+
+              Args:
+                times: Vector of shape (M,) holding the sample times.
 
-  py::class_<motion::CartesianTrajectory>(m, "CartesianTrajectory")
+              Returns:
+                Array of shape (K, M, 7) for K trajectories.
+          )delim")
+      .def(
+          "sample",
+          [](motion::TrajectorySet &set,
+             const py::array_t<double, py::array::c_style |
+                                           py::array::forcecast> &times) {
+            const size_t num_times = times.size();
+            std::vector<size_t> shape{set.size(), num_times, 7};
+            py::array_t<double> q(shape), dq(shape), ddq(shape);
+            const double *t = times.data();
+            double *q_ptr = q.mutable_data(), *dq_ptr = dq.mutable_data(),
+                   *ddq_ptr = ddq.mutable_data();
+            {
+              py::gil_scoped_release release;
+              set.evaluate(t, num_times, q_ptr, dq_ptr, ddq_ptr);
+            }
+            return py::make_tuple(q, dq, ddq);
+          },
+          py::arg("times"), R"delim(
+              Evaluate joint positions, velocities and accelerations of all
+              trajectories.
+
+              Args:
+                times: Vector of shape (M,) holding the sample times.
+
+              Returns:
+                Tuple of three arrays of shape (K, M, 7) for K trajectories.
+          )delim");
+
+  py::class_<motion::CartesianTrajectory,
+             std::shared_ptr<motion::CartesianTrajectory>>(m, "CartesianTrajectory")
       .def(py::init<const std::vector<Eigen::Matrix<double, 3, 1>> &,
                     const std::vector<Eigen::Matrix<double, 4, 1>> &, double,
                     double, double>(),
@@ -112,7 +831,58 @@ PYBIND11_MODULE(_core, m) {
            py::arg("speed_factor") = motion::kDefaultCartesianSpeedFactor,
            py::arg("max_deviation") = 0,
            py::arg("timeout") = motion::kDefaultTimeout)
+      .def_static(
+          "compute_async",
+          [](const std::vector<Eigen::Matrix<double, 3, 1>> &positions,
+             const std::vector<Eigen::Matrix<double, 4, 1>> &orientations,
+             double speed_factor, double max_deviation, double timeout,
+             ThreadPool::Priority priority) {
+            return motion::TrajectoryFuture<motion::CartesianTrajectory>::
+                submit(
+                    [=]() {
+                      return std::make_shared<motion::CartesianTrajectory>(
+                          positions, orientations, speed_factor,
+                          max_deviation, timeout);
+                    },
+                    priority);
+          },
+          py::arg("positions"), py::arg("orientations"),
+          py::arg("speed_factor") = motion::kDefaultCartesianSpeedFactor,
+          py::arg("max_deviation") = 0,
+          py::arg("timeout") = motion::kDefaultTimeout,
+          py::arg("priority") = ThreadPool::Priority::kNormal, R"delim(
+              Compute the trajectory in the background on the shared thread
+              pool. Takes the same arguments as the constructor.
+
+              Args:
+                priority: Scheduling priority among pending computations.
+
+              Returns:
+                :py:class:`CartesianTrajectoryFuture` holding the trajectory.
+          )delim")
+      .def_static(
+          "compute_async",
+          [](const std::vector<Eigen::Matrix<double, 4, 4>> &poses,
+             double speed_factor, double max_deviation, double timeout,
+             ThreadPool::Priority priority) {
+            return motion::TrajectoryFuture<motion::CartesianTrajectory>::
+                submit(
+                    [=]() {
+                      return std::make_shared<motion::CartesianTrajectory>(
+                          poses, speed_factor, max_deviation, timeout);
+                    },
+                    priority);
+          },
+          py::arg("poses"),
+          py::arg("speed_factor") = motion::kDefaultCartesianSpeedFactor,
+          py::arg("max_deviation") = 0,
+          py::arg("timeout") = motion::kDefaultTimeout,
+          py::arg("priority") = ThreadPool::Priority::kNormal)
       .def("get_duration", &motion::CartesianTrajectory::getDuration)
+      .def("compile", &motion::CartesianTrajectory::compile,
+           py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("compiled",
+                             &motion::CartesianTrajectory::isCompiled)
       .def("get_pose", &motion::CartesianTrajectory::getPose, py::arg("time"))
       .def("get_position", &motion::CartesianTrajectory::getPosition,
            py::arg("time"))
@@ -124,7 +894,31 @@ PYBIND11_MODULE(_core, m) {
       .def("__enter__", &PandaContext::enter)
       .def("__exit__", &PandaContext::exit)
       .def_property_readonly("time", &PandaContext::getTime)
-      .def_property_readonly("num_ticks", &PandaContext::getNumTicks);
+      .def_property_readonly("num_ticks", &PandaContext::getNumTicks)
+      .def_property_readonly("block_size", &PandaContext::getBlockSize)
+      .def_property_readonly("num_dropped_blocks",
+                             &PandaContext::getNumDroppedBlocks, R"delim(
+          Number of state blocks that were published but superseded before
+          :py:meth:`ok` picked them up.
+      )delim")
+      .def("get_states", &PandaContext::getStates, R"delim(
+          States of the last block received with :py:meth:`ok`. Returns a
+          dictionary of arrays with one row per control tick, i.e.
+          q, dq, tau_J, tau_ext_hat_filtered (K x 7), O_T_EE (K x 16,
+          column-major), O_F_ext_hat_K (K x 6) and time (K x 1).
+      )delim")
+      .def("set_setpoints", &PandaContext::setSetpoints, py::arg("setpoints"),
+           R"delim(
+          Provide a block of future setpoints for the active controller.
+          The control thread applies one row per tick starting with the next
+          tick and holds the last row if no new block arrives in time.
+          :py:class:`JointPosition` takes joint positions, optionally
+          followed by joint velocities (7 or 14 columns).
+          :py:class:`CartesianImpedance` takes position and orientation
+          quaternion (scalar last), optionally followed by nullspace joint
+          positions (7 or 14 columns).
+          :py:class:`Force` takes the desired force (3 columns).
+      )delim");
 
   py::class_<Panda>(m, "Panda", R"delim(
      The main interface of panda-py to control the robot.
@@ -139,13 +933,41 @@ PYBIND11_MODULE(_core, m) {
            py::arg("damping") = Panda::kDefaultTeachingDamping,
            py::call_guard<py::gil_scoped_release>())
       .def("create_context", &Panda::createContext, py::arg("frequency"),
-           py::arg("max_runtime") = 0.0, py::arg("max_iter") = 0)
+           py::arg("max_runtime") = 0.0, py::arg("max_iter") = 0,
+           py::arg("block_size") = 0, R"delim(
+          Create a context to run a control loop at the given frequency.
+          With a positive `block_size` the context runs in tick-group mode:
+          :py:meth:`PandaContext.ok` blocks until the control thread has
+          collected the next `block_size` states, which are retrieved with
+          :py:meth:`PandaContext.get_states`, and the frequency is ignored.
+          Setpoints for the following ticks are provided as a block with
+          :py:meth:`PandaContext.set_setpoints`. A controller must be running
+          before the loop is entered.
+      )delim")
       .def("get_robot", &Panda::getRobot,
            py::return_value_policy::reference_internal, R"delim(
                Get a reference to the :py:class:`libfranka.Robot` class behind this instance.
            )delim")
       .def("get_model", &Panda::getModel,
            py::return_value_policy::reference_internal)
+      .def(
+          "get_connection_timing",
+          [](const Panda &panda) {
+            static const char *kModelSources[] = {"robot", "memory"};
+            const auto &timing = panda.getConnectionTiming();
+            py::dict result;
+            result["connect"] = timing.connect;
+            result["load_model"] = timing.load_model;
+            result["read_state"] = timing.read_state;
+            result["total"] = timing.total;
+            result["model_source"] =
+                kModelSources[static_cast<int>(timing.model_source)];
+            return result;
+          },
+          R"delim(
+          Durations in seconds of the steps taken to connect to the robot,
+          and where the model was loaded from (robot or memory).
+      )delim")
       .def("get_state", &Panda::getState, R"delim(
           Get a copy of the last :py:class:`libfranka.RobotState` received from the robot.
       )delim")
@@ -185,6 +1007,18 @@ PYBIND11_MODULE(_core, m) {
       //     .def("join_motion", &Panda::joinMotionThread)
 
       .def("set_default_behavior", &Panda::setDefaultBehavior)
+      .def("set_kinematics", &Panda::setKinematics, py::arg("kinematics"),
+           R"delim(
+          Use the tool frame of `kinematics` as the robot's end effector.
+          The robot then reports `O_T_EE` and the end-effector Jacobian for
+          the tool, so Cartesian controllers and generators act on it
+          without additional cost in the control loop. The robot must not
+          be moving.
+      )delim")
+      .def("get_kinematics", &Panda::getKinematics, R"delim(
+          Kinematics of the current end effector, the Franka Hand unless
+          set with :py:meth:`set_kinematics`.
+      )delim")
       .def("raise_error", &Panda::raiseError, R"delim(
           Raises a `RuntimeError` in Python when the robot has an active error.
           As panda-py controllers run asynchroneously, encountered errors don't
@@ -218,6 +1052,33 @@ PYBIND11_MODULE(_core, m) {
       .def("set_damping", &IntegratedVelocity::setDamping,
            py::call_guard<py::gil_scoped_release>(), py::arg("damping"));
 
+  py::class_<SetpointBuffer, std::shared_ptr<SetpointBuffer>>(
+      m, "SetpointBuffer", R"delim(
+          Controller-owned setpoint array for low-overhead streaming. Write
+          into :py:attr:`array` and call :py:meth:`commit` to hand the values
+          to the control thread. Keep a reference to :py:attr:`array` rather
+          than accessing the property on every update, writing into the
+          view and committing avoids all argument conversion.
+      )delim")
+      .def_property_readonly(
+          "array",
+          [](std::shared_ptr<SetpointBuffer> self) {
+            return py::array_t<double>(self->size(), self->staging(),
+                                       py::cast(self));
+          },
+          R"delim(
+          Writable numpy view of the staging array. Changes take effect
+          with the next :py:meth:`commit`.
+      )delim")
+      .def("commit", &SetpointBuffer::commit, R"delim(
+          Publish the staging array to the control thread.
+      )delim")
+      .def_property_readonly("version", &SetpointBuffer::getVersion, R"delim(
+          Number of commits so far, including the controller's resets to
+          the current state when it starts.
+      )delim")
+      .def("__len__", &SetpointBuffer::size);
+
   py::class_<JointPosition, TorqueController, std::shared_ptr<JointPosition>>(
       m, "JointPosition")
       .def(py::init<const Vector7d &, const Vector7d &,
@@ -233,7 +1094,18 @@ PYBIND11_MODULE(_core, m) {
       .def("set_damping", &JointPosition::setDamping,
            py::call_guard<py::gil_scoped_release>(), py::arg("damping"))
       .def("set_filter", &JointPosition::setFilter,
-           py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"));
+           py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"))
+      .def_property_readonly("setpoint", &JointPosition::getSetpointBuffer,
+                             R"delim(
+          :py:class:`SetpointBuffer` holding joint positions followed by joint
+          velocities (14 values). Initialized with the current configuration
+          when the controller is started.
+      )delim");
+
+  py::enum_<CartesianImpedance::NullspaceObjective>(m, "NullspaceObjective")
+      .value("POSTURE", CartesianImpedance::NullspaceObjective::kPosture)
+      .value("MANIPULABILITY",
+             CartesianImpedance::NullspaceObjective::kManipulability);
 
   py::class_<CartesianImpedance, TorqueController,
              std::shared_ptr<CartesianImpedance>>(m, "CartesianImpedance")
@@ -259,7 +1131,13 @@ PYBIND11_MODULE(_core, m) {
            )delim")
       .def("set_control", &CartesianImpedance::setControl,
            py::call_guard<py::gil_scoped_release>(), py::arg("position"),
-           py::arg("orientation"), py::arg("q_nullspace") = kJointPositionStart)
+           py::arg("orientation"), py::arg("q_nullspace") = py::none(),
+           R"delim(
+          Set the end-effector pose and, optionally, the nullspace joint
+          positions the posture objective pulls towards. The nullspace
+          target starts at the joint positions the controller was started
+          with and is kept if `q_nullspace` is None.
+      )delim")
       .def("set_impedance", &CartesianImpedance::setImpedance,
            py::call_guard<py::gil_scoped_release>(), py::arg("impedance"))
       .def("set_damping_ratio", &CartesianImpedance::setDampingRatio,
@@ -268,8 +1146,52 @@ PYBIND11_MODULE(_core, m) {
            &CartesianImpedance::setNullspaceStiffness,
            py::call_guard<py::gil_scoped_release>(),
            py::arg("nullspace_stiffness"))
+      .def("set_nullspace_objective",
+           &CartesianImpedance::setNullspaceObjective,
+           py::call_guard<py::gil_scoped_release>(), py::arg("objective"),
+           py::arg("manipulability_weight") = 1.0,
+           py::arg("joint_limit_weight") = 1.0, R"delim(
+          Select what the nullspace term drives the joints towards.
+          `POSTURE` (default) pulls towards the nullspace joint positions of
+          :py:meth:`set_control`. `MANIPULABILITY` follows the analytic
+          gradient of the weighted sum of the log-manipulability and the
+          normalized distance to the joint limits, computed from the
+          Jacobian each tick, to keep the arm away from singularities
+          during long Cartesian motions. The nullspace stiffness scales the
+          gradient in both cases.
+
+          Args:
+            objective: :py:class:`NullspaceObjective` to follow.
+            manipulability_weight: Weight of the log-manipulability.
+            joint_limit_weight: Weight of the joint-limit distance.
+      )delim")
+      .def("set_singularity_damping",
+           &CartesianImpedance::setSingularityDamping,
+           py::call_guard<py::gil_scoped_release>(),
+           py::arg("manipulability_threshold") =
+               kinematics::kDefaultManipulabilityThreshold,
+           py::arg("max_damping") = kinematics::kDefaultMaxDamping,
+           R"delim(
+          Configure the damping of the nullspace projection close to
+          singularities. Below the manipulability threshold the damping
+          grows linearly up to `max_damping` at the singularity, so the
+          projection doesn't swing the joints where the Jacobian is
+          ill-conditioned. Above it, the projection is exact and the
+          nullspace term doesn't disturb the task. Enabled by default.
+
+          Args:
+            manipulability_threshold: Manipulability sqrt(det(J J^T)) below
+              which damping is applied, zero disables it.
+            max_damping: Damping at an exact singularity.
+      )delim")
       .def("set_filter", &CartesianImpedance::setFilter,
-           py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"));
+           py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"))
+      .def_property_readonly("setpoint", &CartesianImpedance::getSetpointBuffer,
+                             R"delim(
+          :py:class:`SetpointBuffer` holding position, orientation quaternion
+          (scalar last) and nullspace joint positions (14 values). Initialized
+          with the current pose when the controller is started.
+      )delim");
 
   py::class_<AppliedTorque, TorqueController, std::shared_ptr<AppliedTorque>>(
       m, "AppliedTorque")
@@ -316,6 +1238,813 @@ PYBIND11_MODULE(_core, m) {
            py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"))
       .def_property_readonly("name", &Force::name);
 
+  py::class_<HybridForceImpedance, TorqueController,
+             std::shared_ptr<HybridForceImpedance>>(m, "HybridForceImpedance")
+      .def(py::init<const Eigen::Matrix<double, 6, 6> &, const double &,
+                    const double &, const double &, const double &,
+                    const Vector6d &, const double &>(),
+           py::arg("impedance") = HybridForceImpedance::kDefaultImpedance,
+           py::arg("damping_ratio") =
+               HybridForceImpedance::kDefaultDampingRatio,
+           py::arg("nullspace_stiffness") =
+               HybridForceImpedance::kDefaultNullspaceStiffness,
+           py::arg("k_p") = HybridForceImpedance::kDefaultProportionalGain,
+           py::arg("k_i") = HybridForceImpedance::kDefaultIntegralGain,
+           py::arg("force_damping") =
+               HybridForceImpedance::kDefaultForceDamping,
+           py::arg("filter_coeff") = HybridForceImpedance::kDefaultFilterCoeff,
+           R"delim(
+               Hybrid force/impedance controller. The selection vector assigns
+               each task space axis (base frame) to force control (1) or
+               impedance control (0), intermediate values blend both. Force
+               axes use feedforward plus PI control on the wrench estimated from
+               joint torques, impedance axes behave like :py:class:`CartesianImpedance`.
+
+               Args:
+                 impedance: Cartesian impedance expressed as a matrix
+                   :math:`\in \mathbb{R}^{6\times 6}`.
+                 damping_ratio: Cartesian damping is computed based on the given
+                   impedance and damping ratio.
+                 nullspace_stiffness: Control gain of the nullspace term.
+                 k_p: Proportional gain of the wrench error.
+                 k_i: Integral gain of the wrench error.
+                 force_damping: Task space damping along force controlled axes.
+                 filter_coeff: TP1 filter coefficient used to filter input signals.
+                   The selection vector ramps linearly instead, see
+                   :py:meth:`set_selection_ramp_time`.
+           )delim")
+      .def("set_control", &HybridForceImpedance::setControl,
+           py::call_guard<py::gil_scoped_release>(), py::arg("position"),
+           py::arg("orientation"), py::arg("wrench"),
+           py::arg("q_nullspace") = kJointPositionStart, R"delim(
+          Set the pose for impedance controlled axes and the wrench exerted
+          along force controlled axes.
+      )delim")
+      .def("set_selection", &HybridForceImpedance::setSelection,
+           py::call_guard<py::gil_scoped_release>(), py::arg("selection"))
+      .def("set_feedforward", &HybridForceImpedance::setFeedforward,
+           py::call_guard<py::gil_scoped_release>(), py::arg("wrench"), R"delim(
+          Wrench added on all axes, e.g. to compensate a tool.
+      )delim")
+      .def("set_impedance", &HybridForceImpedance::setImpedance,
+           py::call_guard<py::gil_scoped_release>(), py::arg("impedance"))
+      .def("set_damping_ratio", &HybridForceImpedance::setDampingRatio,
+           py::call_guard<py::gil_scoped_release>(), py::arg("damping_ratio"))
+      .def("set_nullspace_stiffness",
+           &HybridForceImpedance::setNullspaceStiffness,
+           py::call_guard<py::gil_scoped_release>(),
+           py::arg("nullspace_stiffness"))
+      .def("set_force_gains", &HybridForceImpedance::setForceGains,
+           py::call_guard<py::gil_scoped_release>(), py::arg("k_p"),
+           py::arg("k_i"))
+      .def("set_force_damping", &HybridForceImpedance::setForceDamping,
+           py::call_guard<py::gil_scoped_release>(), py::arg("force_damping"))
+      .def("set_integral_limit", &HybridForceImpedance::setIntegralLimit,
+           py::call_guard<py::gil_scoped_release>(), py::arg("limit"))
+      .def("set_wrench_limit", &HybridForceImpedance::setWrenchLimit,
+           py::call_guard<py::gil_scoped_release>(), py::arg("limit"))
+      .def("set_filter", &HybridForceImpedance::setFilter,
+           py::call_guard<py::gil_scoped_release>(), py::arg("filter_coeff"))
+      .def("set_selection_ramp_time",
+           &HybridForceImpedance::setSelectionRampTime,
+           py::call_guard<py::gil_scoped_release>(), py::arg("duration"),
+           R"delim(
+          Time in seconds the selection takes to ramp from impedance (0) to
+          force control (1), independent of the filter coefficient. Zero
+          switches immediately.
+      )delim")
+      .def("set_singularity_damping",
+           &HybridForceImpedance::setSingularityDamping,
+           py::call_guard<py::gil_scoped_release>(),
+           py::arg("manipulability_threshold") =
+               kinematics::kDefaultManipulabilityThreshold,
+           py::arg("max_damping") = kinematics::kDefaultMaxDamping,
+           R"delim(
+          Configure the damping of the wrench estimate and the nullspace
+          projection close to singularities. Below the manipulability
+          threshold the damping grows linearly up to `max_damping` at the
+          singularity, so the estimated wrench and with it the force loop
+          stay bounded where the Jacobian is ill-conditioned, at the cost of
+          underestimating wrenches along the weak directions. Above it, both
+          are exact. Enabled by default.
+
+          Args:
+            manipulability_threshold: Manipulability sqrt(det(J J^T)) below
+              which damping is applied, zero disables it.
+            max_damping: Damping at an exact singularity.
+      )delim")
+      .def("set_contact_transition",
+           &HybridForceImpedance::setContactTransition,
+           py::call_guard<py::gil_scoped_release>(), py::arg("selection"),
+           py::arg("force"), R"delim(
+          Arm a transition to `selection` that is taken inside the control
+          loop once the measured force along its translational axes exceeds
+          `force`. A non-positive force disarms the transition.
+      )delim")
+      .def("set_displacement_limit",
+           &HybridForceImpedance::setDisplacementLimit,
+           py::call_guard<py::gil_scoped_release>(), py::arg("distance"),
+           R"delim(
+          Fall back to impedance control at the current pose if the
+          end-effector moves further than `distance` along force controlled
+          axes, e.g. when contact is lost. Zero disables the limit.
+      )delim")
+      .def_property_readonly("in_contact", &HybridForceImpedance::isInContact)
+      .def_property_readonly("limit_exceeded",
+                             &HybridForceImpedance::isLimitExceeded)
+      .def_property_readonly("wrench", &HybridForceImpedance::getWrench,
+                             R"delim(
+          Wrench exerted by the end-effector, estimated from joint torques.
+      )delim")
+      .def_property_readonly("selection", &HybridForceImpedance::getSelection);
+
+  py::class_<controllers::TimeScaling,
+             std::shared_ptr<controllers::TimeScaling>>(m, "TimeScaling")
+      .def(py::init<double, double, double, double, double, double, double,
+                    size_t>(),
+           py::arg("error_threshold") =
+               controllers::TimeScaling::kDefaultErrorThreshold,
+           py::arg("error_limit") =
+               controllers::TimeScaling::kDefaultErrorLimit,
+           py::arg("torque_threshold") =
+               controllers::TimeScaling::kDefaultTorqueThreshold,
+           py::arg("torque_limit") =
+               controllers::TimeScaling::kDefaultTorqueLimit,
+           py::arg("min_rate") = controllers::TimeScaling::kDefaultMinRate,
+           py::arg("slowdown") = controllers::TimeScaling::kDefaultSlowdown,
+           py::arg("recovery") = controllers::TimeScaling::kDefaultRecovery,
+           py::arg("log_size") = controllers::TimeScaling::kDefaultLogSize,
+           R"delim(
+               Trajectory clock for path following, attached to a trajectory
+               follower through its `time_scaling` property. The trajectory
+               time advances at a rate between `min_rate` and one instead of
+               with wall time. The rate drops smoothly while the tracking error
+               or the largest estimated external joint torque exceed their
+               thresholds and recovers to nominal speed afterwards, so a
+               disturbed motion slows down instead of triggering reflexes.
+
+               Args:
+                 error_threshold: Tracking error above which the motion slows
+                   down, in rad for joint and m for Cartesian followers.
+                 error_limit: Tracking error at which `min_rate` is reached.
+                 torque_threshold: External torque in Nm above which the motion
+                   slows down.
+                 torque_limit: External torque at which `min_rate` is reached.
+                 min_rate: Slowest rate of the trajectory clock, zero allows
+                   pausing.
+                 slowdown: Largest rate decrease per second.
+                 recovery: Largest rate increase per second.
+                 log_size: Number of ticks kept in the time-warp log.
+           )delim")
+      .def_property_readonly("rate", &controllers::TimeScaling::getRate)
+      .def_property_readonly("trajectory_time",
+                             &controllers::TimeScaling::getTrajectoryTime)
+      .def(
+          "get_log",
+          [](const controllers::TimeScaling &time_scaling) {
+            auto samples = time_scaling.getLog();
+            Eigen::VectorXd time(samples.size()),
+                trajectory_time(samples.size()), rate(samples.size()),
+                tracking_error(samples.size()), external_torque(samples.size());
+            for (size_t i = 0; i < samples.size(); i++) {
+              time[i] = samples[i].time;
+              trajectory_time[i] = samples[i].trajectory_time;
+              rate[i] = samples[i].rate;
+              tracking_error[i] = samples[i].tracking_error;
+              external_torque[i] = samples[i].external_torque;
+            }
+            py::dict result;
+            result["time"] = time;
+            result["trajectory_time"] = trajectory_time;
+            result["rate"] = rate;
+            result["tracking_error"] = tracking_error;
+            result["external_torque"] = external_torque;
+            return result;
+          },
+          R"delim(
+              Get the time-warp profile of the last ticks as a dictionary of
+              arrays: controller time, trajectory time, rate, tracking error
+              and external torque.
+          )delim");
+
+  py::class_<controllers::JointTrajectoryFollower, TorqueController,
+             std::shared_ptr<controllers::JointTrajectoryFollower>>(
+      m, "JointTrajectoryFollower")
+      .def(py::init([](std::shared_ptr<motion::JointTrajectory> trajectory,
+                       const Vector7d &stiffness, const Vector7d &damping,
+                       bool feedforward, double dq_threshold,
+                       double time_offset, double preview) {
+             return std::make_shared<controllers::JointTrajectoryFollower>(
+                 controllers::JointTrajectorySource(trajectory),
+                 controllers::JointImpedanceLaw(stiffness, damping,
+                                                feedforward),
+                 dq_threshold, time_offset, preview);
+           }),
+           py::arg("trajectory"),
+           py::arg("stiffness") = JointPosition::kDefaultStiffness,
+           py::arg("damping") = JointPosition::kDefaultDamping,
+           py::arg("feedforward") = false,
+           py::arg("dq_threshold") =
+               controllers::JointTrajectory::kDefaultDqThreshold,
+           py::arg("time_offset") = 0.0, py::arg("preview") = 0.0,
+           R"delim(
+               Follows a :py:class:`JointTrajectory` with a joint impedance law.
+               Position, velocity and acceleration are evaluated once per tick
+               from the compiled trajectory and fed to the tracking law directly.
+
+               Args:
+                 trajectory: Trajectory to follow, compiled when the controller starts.
+                 stiffness: Joint stiffness.
+                 damping: Joint damping, applied to the velocity tracking error.
+                 feedforward: Add inverse dynamics feedforward of the reference
+                   acceleration.
+                 dq_threshold: Joint velocity below which the robot is considered
+                   at rest after the trajectory ended.
+                 time_offset: Shift of the trajectory time, a negative offset
+                   delays the start.
+                 preview: Look-ahead of the reference in seconds.
+           )delim")
+      .def_property("time_offset",
+                    &controllers::JointTrajectoryFollower::getTimeOffset,
+                    &controllers::JointTrajectoryFollower::setTimeOffset)
+      .def_property("preview", &controllers::JointTrajectoryFollower::getPreview,
+                    &controllers::JointTrajectoryFollower::setPreview)
+      .def_property("time_scaling",
+                    &controllers::JointTrajectoryFollower::getTimeScaling,
+                    &controllers::JointTrajectoryFollower::setTimeScaling)
+      .def("queue",
+           &controllers::JointTrajectoryFollower::queue<motion::JointTrajectory>,
+           py::arg("trajectory"), py::call_guard<py::gil_scoped_release>(),
+           R"delim(
+               Blend `trajectory` into the end of the motion without coming to
+               rest or restarting the controller. The trajectory has to start
+               where the queued motion ends. The blend window is the longest
+               overlap that keeps the joint velocities and accelerations within
+               the peaks of either trajectory. Trajectories queued while the
+               controller runs blend no earlier than 50 ms from now, segments
+               that were already executed are dropped. Once the controller
+               finished, the trajectory replaces the executed motion and runs
+               on the next start.
+
+               Args:
+                 trajectory: Trajectory to append.
+
+               Returns:
+                 Duration of the blend window in seconds.
+           )delim")
+      .def("get_duration", &controllers::JointTrajectoryFollower::getDuration);
+
+  py::class_<controllers::CartesianTrajectoryFollower, TorqueController,
+             std::shared_ptr<controllers::CartesianTrajectoryFollower>>(
+      m, "CartesianTrajectoryFollower")
+      .def(py::init([](std::shared_ptr<motion::CartesianTrajectory> trajectory,
+                       const Vector7d &q_nullspace,
+                       const Eigen::Matrix<double, 6, 6> &impedance,
+                       double damping_ratio, double nullspace_stiffness,
+                       double dq_threshold, double time_offset,
+                       double preview) {
+             return std::make_shared<controllers::CartesianTrajectoryFollower>(
+                 controllers::CartesianTrajectorySource(trajectory),
+                 controllers::CartesianImpedanceLaw(
+                     impedance, damping_ratio, nullspace_stiffness,
+                     q_nullspace),
+                 dq_threshold, time_offset, preview);
+           }),
+           py::arg("trajectory"), py::arg("q_nullspace") = kJointPositionStart,
+           py::arg("impedance") =
+               controllers::CartesianTrajectory::kDefaultImpedance,
+           py::arg("damping_ratio") = CartesianImpedance::kDefaultDampingRatio,
+           py::arg("nullspace_stiffness") =
+               controllers::CartesianTrajectory::kDefaultNullspaceStiffness,
+           py::arg("dq_threshold") =
+               controllers::CartesianTrajectory::kDefaultDqThreshold,
+           py::arg("time_offset") = 0.0, py::arg("preview") = 0.0,
+           R"delim(
+               Follows a :py:class:`CartesianTrajectory` with a Cartesian impedance
+               law. Pose, twist and twist derivative are evaluated once per tick
+               from the compiled trajectory and fed to the tracking law directly,
+               the reference twist is used as damping target.
+
+               Args:
+                 trajectory: Trajectory to follow, compiled when the controller starts.
+                 q_nullspace: Nullspace joint positions.
+                 impedance: Cartesian impedance expressed as a matrix
+                   :math:`\in \mathbb{R}^{6\times 6}`.
+                 damping_ratio: Cartesian damping is computed based on the given
+                   impedance and damping ratio.
+                 nullspace_stiffness: Control gain of the nullspace term.
+                 dq_threshold: Joint velocity below which the robot is considered
+                   at rest after the trajectory ended.
+                 time_offset: Shift of the trajectory time, a negative offset
+                   delays the start.
+                 preview: Look-ahead of the reference in seconds.
+           )delim")
+      .def_property("time_offset",
+                    &controllers::CartesianTrajectoryFollower::getTimeOffset,
+                    &controllers::CartesianTrajectoryFollower::setTimeOffset)
+      .def_property("preview",
+                    &controllers::CartesianTrajectoryFollower::getPreview,
+                    &controllers::CartesianTrajectoryFollower::setPreview)
+      .def_property("time_scaling",
+                    &controllers::CartesianTrajectoryFollower::getTimeScaling,
+                    &controllers::CartesianTrajectoryFollower::setTimeScaling)
+      .def("get_duration",
+           &controllers::CartesianTrajectoryFollower::getDuration);
+
+  py::class_<controllers::JointTrajectoryMPC, TorqueController,
+             std::shared_ptr<controllers::JointTrajectoryMPC>>(
+      m, "JointTrajectoryMPC")
+      .def(py::init<std::shared_ptr<motion::JointTrajectory>, double, double,
+                    double, double, int, double, double>(),
+           py::arg("trajectory"),
+           py::arg("block_duration") =
+               controllers::JointTrajectoryMPC::kDefaultBlockDuration,
+           py::arg("position_weight") =
+               controllers::JointTrajectoryMPC::kDefaultPositionWeight,
+           py::arg("velocity_weight") =
+               controllers::JointTrajectoryMPC::kDefaultVelocityWeight,
+           py::arg("acceleration_weight") =
+               controllers::JointTrajectoryMPC::kDefaultAccelerationWeight,
+           py::arg("max_iterations") =
+               controllers::JointTrajectoryMPC::kDefaultMaxIterations,
+           py::arg("torque_margin") =
+               controllers::JointTrajectoryMPC::kDefaultTorqueMargin,
+           py::arg("dq_threshold") =
+               controllers::JointTrajectory::kDefaultDqThreshold,
+           R"delim(
+               Follows a :py:class:`JointTrajectory` with linear model-predictive
+               control. Each tick the arm is linearized at the current state and
+               the joint accelerations over a horizon of 5 blocks are optimized
+               such that the previewed reference is tracked while the joint
+               torque and torque rate limits are respected. The QP has a fixed
+               size and is solved with a warm-started ADMM iteration. Compared to
+               :py:class:`JointTrajectoryFollower` this anticipates the
+               reference and degrades gracefully when it demands more torque
+               than available.
+
+               Args:
+                 trajectory: Trajectory to follow, compiled when the controller starts.
+                 block_duration: Duration of each horizon block in seconds.
+                 position_weight: Weight of the position tracking error.
+                 velocity_weight: Weight of the velocity tracking error.
+                 acceleration_weight: Weight of the deviation from the reference
+                   acceleration, regularizes the torques.
+                 max_iterations: Maximum number of ADMM iterations per tick.
+                 torque_margin: Fraction of the joint torque limits available to
+                   the controller.
+                 dq_threshold: Joint velocity below which the robot is considered
+                   at rest after the trajectory ended.
+           )delim")
+      .def(
+          "get_solve_stats",
+          [](const controllers::JointTrajectoryMPC &controller) {
+            auto stats = controller.getSolveStats();
+            py::dict result;
+            result["count"] = stats.count;
+            result["not_converged"] = stats.not_converged;
+            result["mean"] = stats.mean;
+            result["max"] = stats.max;
+            result["p50"] = stats.p50;
+            result["p90"] = stats.p90;
+            result["p99"] = stats.p99;
+            result["mean_iterations"] = stats.mean_iterations;
+            return result;
+          },
+          R"delim(
+              Get the number of solves, how many of them stopped at the
+              iteration limit, solve time statistics in seconds and the mean
+              number of iterations. Percentiles are resolved to 10 µs.
+          )delim")
+      .def("reset_solve_stats",
+           &controllers::JointTrajectoryMPC::resetSolveStats);
+
+  py::enum_<simulation::Objective>(m, "RolloutObjective")
+      .value("JOINT_POSITION", simulation::Objective::kJointPosition)
+      .value("CARTESIAN_POSITION", simulation::Objective::kCartesianPosition)
+      .value("FORCE", simulation::Objective::kForce);
+
+  m.def(
+      "rollout",
+      [](const std::vector<std::shared_ptr<TorqueController>> &controllers,
+         const DoubleArray &setpoints, double duration,
+         simulation::Objective objective, const Vector7d &q_init,
+         int substeps, double cutoff_frequency, const Vector7d &armature,
+         const Vector7d &viscous_friction, double payload_mass,
+         const Eigen::Vector3d &payload_com,
+         const std::optional<Eigen::Vector3d> &contact_point,
+         const Eigen::Vector3d &contact_normal, double contact_stiffness,
+         double contact_damping, double settling_tolerance, bool record,
+         ThreadPool::Priority priority) {
+        if (setpoints.ndim() != 1 && setpoints.ndim() != 2) {
+          throw std::invalid_argument(
+              "Setpoints must be a single row or one row per tick.");
+        }
+        simulation::RolloutSettings settings;
+        settings.setpoint_size = setpoints.shape(setpoints.ndim() - 1);
+        settings.setpoints.assign(setpoints.data(),
+                                  setpoints.data() + setpoints.size());
+        settings.duration = duration;
+        settings.objective = objective;
+        settings.q_init = q_init;
+        settings.substeps = substeps;
+        settings.cutoff_frequency = cutoff_frequency;
+        settings.armature = armature;
+        settings.viscous_friction = viscous_friction;
+        settings.payload.mass = payload_mass;
+        settings.payload.com = payload_com;
+        if (contact_point) {
+          settings.contact = true;
+          settings.contact_plane.point = *contact_point;
+          settings.contact_plane.normal = contact_normal;
+          settings.contact_plane.stiffness = contact_stiffness;
+          settings.contact_plane.damping = contact_damping;
+        }
+        settings.settling_tolerance = settling_tolerance;
+        settings.record = record;
+
+        std::vector<simulation::RolloutResult> results;
+        {
+          py::gil_scoped_release release;
+          results = simulation::rollouts(controllers, settings, priority);
+        }
+        const size_t n = results.size();
+        auto column = [&](auto member) {
+          py::array_t<double> values(n);
+          for (size_t i = 0; i < n; i++) {
+            values.mutable_data()[i] = static_cast<double>(results[i].*member);
+          }
+          return values;
+        };
+        py::dict result;
+        result["duration"] = column(&simulation::RolloutResult::duration);
+        result["rms_error"] = column(&simulation::RolloutResult::rms_error);
+        result["max_error"] = column(&simulation::RolloutResult::max_error);
+        result["final_error"] = column(&simulation::RolloutResult::final_error);
+        result["overshoot"] = column(&simulation::RolloutResult::overshoot);
+        result["settling_time"] =
+            column(&simulation::RolloutResult::settling_time);
+        result["torque_rate_violations"] =
+            column(&simulation::RolloutResult::torque_rate_violations);
+        result["torque_limit_violations"] =
+            column(&simulation::RolloutResult::torque_limit_violations);
+        result["max_torque_rate"] =
+            column(&simulation::RolloutResult::max_torque_rate);
+        py::array_t<bool> failed(n);
+        py::list errors;
+        for (size_t i = 0; i < n; i++) {
+          failed.mutable_data()[i] = results[i].failed;
+          errors.append(results[i].error);
+        }
+        result["failed"] = failed;
+        result["error"] = errors;
+        if (record) {
+          const size_t size = simulation::objectiveSize(objective);
+          py::list traces;
+          for (const auto &r : results) {
+            py::array_t<double> trace(
+                {r.trace.size() / size, size});
+            std::copy(r.trace.begin(), r.trace.end(), trace.mutable_data());
+            traces.append(trace);
+          }
+          result["trace"] = traces;
+        }
+        return result;
+      },
+      py::arg("controllers"), py::arg("setpoints"),
+      py::arg("duration") = 2.0,
+      py::arg("objective") = simulation::Objective::kCartesianPosition,
+      py::arg("q_init") = kJointPositionStart, py::arg("substeps") = 2,
+      py::arg("cutoff_frequency") = 100.0,
+      py::arg("armature") = Vector7d::Constant(0.1),
+      py::arg("viscous_friction") = Vector7d::Zero(),
+      py::arg("payload_mass") = 0.0,
+      py::arg("payload_com") = Eigen::Vector3d::Zero(),
+      py::arg("contact_point") = py::none(),
+      py::arg("contact_normal") = Eigen::Vector3d::UnitZ(),
+      py::arg("contact_stiffness") = 1e4, py::arg("contact_damping") = 100.0,
+      py::arg("settling_tolerance") = 0.02, py::arg("record") = false,
+      py::arg("priority") = ThreadPool::Priority::kNormal,
+      R"delim(
+          Simulate each controller on a rigid-body model of the arm, in
+          parallel on the process-wide thread pool and faster than real
+          time. Every rollout starts at rest in `q_init` and receives the
+          setpoint rows through the same mechanism as
+          :py:meth:`PandaContext.set_setpoints`, one row per tick with the
+          last row held. Commands pass the same torque rate saturation and
+          clipping as on the robot, and gravity is compensated for the
+          configured Franka Hand. Controllers are modified by the rollout
+          and must be distinct instances, e.g. one per parameter set.
+
+          Args:
+            controllers: Controllers to simulate.
+            setpoints: A single setpoint row or one row per tick (T x K).
+              The leading columns are the reference of the objective.
+            duration: Simulated time in seconds.
+            objective: Signal compared to the setpoints, joint positions,
+              end-effector position or force exerted on the contact plane.
+            q_init: Initial joint positions.
+            substeps: Integration steps per 1 ms control tick.
+            cutoff_frequency: Cutoff frequency of libfranka's low-pass filter
+              on the commanded torques in Hz, disabled at 1000 and above.
+            armature: Reflected rotor inertia of the simulated joints.
+            viscous_friction: Viscous joint friction of the simulated arm.
+            payload_mass: Mass of a payload unknown to the controller.
+            payload_com: Center of mass of the payload in the flange frame.
+            contact_point: Point on a contact plane, no contact if None.
+            contact_normal: Normal of the contact plane pointing into free
+              space.
+            contact_stiffness: Stiffness of the contact plane in N/m.
+            contact_damping: Damping of the contact plane in Ns/m.
+            settling_tolerance: Settling band as fraction of the step to the
+              final setpoint.
+            record: Also return the objective signal of every tick.
+            priority: Priority of the rollouts on the thread pool.
+
+          Returns:
+            Dictionary of arrays with one entry per controller: duration,
+            rms_error, max_error, final_error, overshoot (fraction of the
+            step), settling_time (inf if not settled), the number of ticks
+            whose commands exceed the torque rate or torque limits
+            (torque_rate_violations, torque_limit_violations),
+            max_torque_rate in Nm/s and failed. `error` lists the failure
+            reasons and `trace` the recorded signals (T x D).
+      )delim");
+
+  auto stress_result = [](const simulation::StressResult &r) {
+    auto latency = [](const simulation::LatencyStats &stats) {
+      py::dict d;
+      d["mean"] = stats.mean;
+      d["p50"] = stats.p50;
+      d["p90"] = stats.p90;
+      d["p99"] = stats.p99;
+      d["p99.9"] = stats.p999;
+      d["max"] = stats.max;
+      return d;
+    };
+    py::dict result;
+    result["ticks"] = r.ticks;
+    result["deadline_misses"] = r.deadline_misses;
+    result["max_consecutive_misses"] = r.max_consecutive_misses;
+    result["blocked_ticks"] = r.blocked_ticks;
+    result["injected_delays"] = r.injected_delays;
+    result["wakeup"] = latency(r.wakeup);
+    result["callback"] = latency(r.callback);
+    result["response"] = latency(r.response);
+    result["worst_tick_time"] = r.worst_tick_time;
+    result["producer"] = latency(r.producer);
+    result["producer_calls"] = r.producer_calls;
+    result["blocks_read"] = r.blocks_read;
+    result["blocks_dropped"] = r.blocks_dropped;
+    result["gil_holds"] = r.gil_holds;
+    result["realtime"] = r.realtime;
+    result["failed"] = r.failed;
+    result["error"] = r.error;
+    return result;
+  };
+
+  py::class_<simulation::StressTest>(m, "StressTest", R"delim(
+          Fake 1 kHz robot loop that runs controllers and generators through
+          the same control path as a connected :py:class:`Panda` while
+          injecting disturbances: CPU burners, delayed callbacks, threads
+          holding the GIL and bursts of setpoint updates. Torque controllers
+          drive the rigid-body model used by :py:func:`rollout`, generators
+          see their commands echoed back as robot state. Runs execute on a
+          dedicated thread in real time and release the GIL, combine them
+          with :py:func:`configure_tracing` to see where time is spent.
+      )delim")
+      .def(py::init([](double duration, double deadline,
+                       double blocking_threshold, bool realtime, int cpu,
+                       bool simulate, const Vector7d &q_init,
+                       size_t cpu_burners, double delay,
+                       double delay_probability, size_t gil_holders,
+                       double gil_hold_time, double gil_period,
+                       size_t block_size,
+                       const std::optional<DoubleArray> &setpoints,
+                       size_t burst_size, double burst_interval,
+                       const py::object &producer, unsigned int seed) {
+             simulation::StressSettings settings;
+             settings.duration = duration;
+             settings.deadline = deadline;
+             settings.blocking_threshold = blocking_threshold;
+             settings.realtime = realtime;
+             settings.cpu = cpu;
+             settings.simulate = simulate;
+             settings.plant.q_init = q_init;
+             settings.cpu_burners = cpu_burners;
+             settings.delay = delay;
+             settings.delay_probability = delay_probability;
+             settings.gil_holders = gil_holders;
+             settings.gil_hold_time = gil_hold_time;
+             settings.gil_period = gil_period;
+             settings.block_size = block_size;
+             if (setpoints) {
+               if (setpoints->ndim() != 1 && setpoints->ndim() != 2) {
+                 throw std::invalid_argument(
+                     "Setpoints must be a single row or a block of rows.");
+               }
+               settings.setpoint_size = setpoints->shape(setpoints->ndim() - 1);
+               settings.setpoints.assign(setpoints->data(),
+                                         setpoints->data() + setpoints->size());
+             }
+             settings.burst_size = burst_size;
+             settings.burst_interval = burst_interval;
+             if (!producer.is_none()) {
+               settings.producer = [producer]() {
+                 TracedGilAcquire acquire("stress_producer");
+                 try {
+                   producer();
+                 } catch (py::error_already_set &e) {
+                   throw std::runtime_error(e.what());
+                 }
+               };
+             }
+             settings.seed = seed;
+             return std::make_unique<simulation::StressTest>(settings);
+           }),
+           py::arg("duration") = 5.0, py::arg("deadline") = 1e-3,
+           py::arg("blocking_threshold") = 1e-4, py::arg("realtime") = false,
+           py::arg("cpu") = -1, py::arg("simulate") = true,
+           py::arg("q_init") = kJointPositionStart,
+           py::arg("cpu_burners") = 0, py::arg("delay") = 0.0,
+           py::arg("delay_probability") = 0.0, py::arg("gil_holders") = 0,
+           py::arg("gil_hold_time") = 5e-3, py::arg("gil_period") = 10e-3,
+           py::arg("block_size") = 0, py::arg("setpoints") = py::none(),
+           py::arg("burst_size") = 0, py::arg("burst_interval") = 0.1,
+           py::arg("producer") = py::none(), py::arg("seed") = 0,
+           R"delim(
+              Args:
+                duration: Length of each run in seconds.
+                deadline: Latest completion of a callback after the nominal
+                  start of its tick in seconds.
+                blocking_threshold: Callbacks taking longer than this,
+                  injected delays excluded, count as blocked.
+                realtime: Run the loop with SCHED_FIFO like
+                  `RealtimeConfig.kEnforce`, requires the privilege.
+                cpu: CPU to pin the loop thread to, -1 leaves it unpinned.
+                simulate: Integrate the arm for torque controllers,
+                  otherwise the robot state holds still.
+                q_init: Initial joint positions.
+                cpu_burners: Threads spinning on the CPU during runs.
+                delay: Busy wait in seconds injected before callbacks.
+                delay_probability: Probability of delaying a callback.
+                gil_holders: Threads holding the GIL for `gil_hold_time`
+                  once every `gil_period` seconds.
+                gil_hold_time: Time each GIL holder keeps the GIL.
+                gil_period: Period of the GIL holders.
+                block_size: Tick group block size, 0 disables it. A
+                  consumer thread reads the state blocks like
+                  :py:class:`PandaContext` does.
+                setpoints: Setpoint rows published to the tick group in
+                  bursts, requires a block size.
+                burst_size: Publications per burst, each publishes the
+                  setpoints and calls `producer`.
+                burst_interval: Time between bursts in seconds.
+                producer: Callable invoked with the GIL held in each
+                  publication, e.g. a planner updating setpoints.
+                seed: Seed of the delay injection.
+          )delim")
+      .def(
+          "run",
+          [stress_result](simulation::StressTest &test,
+                          std::shared_ptr<TorqueController> controller) {
+            simulation::StressResult result;
+            {
+              py::gil_scoped_release release;
+              result = test.run(controller);
+            }
+            return stress_result(result);
+          },
+          py::arg("controller"))
+      .def(
+          "run",
+          [stress_result](simulation::StressTest &test,
+                          std::shared_ptr<motion::Generator> generator) {
+            simulation::StressResult result;
+            {
+              py::gil_scoped_release release;
+              result = test.run(generator);
+            }
+            return stress_result(result);
+          },
+          py::arg("generator"), R"delim(
+              Run a torque controller or a generator for the configured
+              duration with the configured disturbances.
+
+              Returns:
+                Dictionary with the number of ticks, deadline_misses,
+                max_consecutive_misses, blocked_ticks and injected_delays,
+                latency statistics in seconds (mean, p50, p90, p99, p99.9,
+                max) of the wakeup, the callback and the response, i.e.
+                completion after the nominal tick start, worst_tick_time,
+                latency statistics of the producer and producer_calls,
+                blocks_read and blocks_dropped of the consumer, gil_holds,
+                whether realtime scheduling was applied, failed and error.
+          )delim");
+
+  py::enum_<simulation::Strategy>(m, "MotionStrategy")
+      .value("JOINT_TRAJECTORY", simulation::Strategy::kJointTrajectory)
+      .value("JOINT_MOTION_GENERATOR",
+             simulation::Strategy::kJointMotionGenerator)
+      .value("CARTESIAN_MOTION_GENERATOR",
+             simulation::Strategy::kCartesianMotionGenerator);
+
+  py::class_<simulation::CycleTimeBenchmark>(m, "CycleTimeBenchmark", R"delim(
+          Compares the cycle time of motion strategies offline. Each run
+          moves from the first waypoint through the others at 1 kHz and
+          faster than real time: :py:class:`JointTrajectory` is sampled,
+          generators are stepped like on a connected :py:class:`Panda` with
+          their commands echoed back as robot state. Cartesian motions are
+          mapped to joint positions by inverse kinematics holding joint 7,
+          which approximates the elbow held by the robot. Joint torques are
+          computed by the rigid-body model used by :py:func:`rollout`, which
+          also provides the Jacobian the Cartesian generator scales its
+          limits with. See :py:mod:`panda_py.benchmark` for the suite of
+          representative paths.
+      )delim")
+      .def(py::init([](double speed_factor, double max_deviation,
+                       double velocity_rel, double acceleration_rel,
+                       double jerk_rel, double timeout, double load_mass,
+                       const Eigen::Vector3d &load_com,
+                       const Eigen::Matrix3d &load_inertia,
+                       const Eigen::Matrix4d &F_T_EE) {
+             simulation::CycleTimeSettings settings;
+             settings.speed_factor = speed_factor;
+             settings.max_deviation = max_deviation;
+             settings.velocity_rel = velocity_rel;
+             settings.acceleration_rel = acceleration_rel;
+             settings.jerk_rel = jerk_rel;
+             settings.timeout = timeout;
+             settings.load.mass = load_mass;
+             settings.load.com = load_com;
+             settings.load.inertia = load_inertia;
+             settings.F_T_EE = F_T_EE;
+             return new simulation::CycleTimeBenchmark(settings);
+           }),
+           py::arg("speed_factor") = 1.0,
+           py::arg("max_deviation") = 0.0, py::arg("velocity_rel") = 1.0,
+           py::arg("acceleration_rel") = 1.0, py::arg("jerk_rel") = 1.0,
+           py::arg("timeout") = 60.0,
+           py::arg("load_mass") = simulation::RigidBodyModel::kFrankaHand.mass,
+           py::arg("load_com") = simulation::RigidBodyModel::kFrankaHand.com,
+           py::arg("load_inertia") =
+               simulation::RigidBodyModel::kFrankaHand.inertia,
+           py::arg("F_T_EE") = simulation::RigidBodyModel::kFrankaHandTransform,
+           R"delim(
+              Args:
+                speed_factor: Speed factor of the joint trajectory, scales the
+              joint limits like `velocity_rel` for the generators.
+                max_deviation: Blending deviation of the joint trajectory.
+                velocity_rel: Relative velocity of the generators.
+                acceleration_rel: Relative acceleration of the generators.
+                jerk_rel: Relative jerk of the generators.
+                timeout: Generators still moving after this many seconds
+                  fail.
+                load_mass: Mass of the load at the flange, end effector
+                  included, defaults to the Franka Hand.
+                load_com: Center of mass of the load in the flange frame.
+                load_inertia: Inertia of the load about its center of mass.
+                F_T_EE: Transform from the flange to the end effector that
+                  Cartesian waypoints refer to.
+          )delim")
+      .def(
+          "run",
+          [](simulation::CycleTimeBenchmark &benchmark,
+             const DoubleArray &waypoints, simulation::Strategy strategy) {
+            const size_t n = jointRows(waypoints, "waypoints");
+            std::vector<Vector7d> joint_waypoints(n);
+            for (size_t i = 0; i < n; i++) {
+              joint_waypoints[i] =
+                  Eigen::Map<const Vector7d>(waypoints.data() + 7 * i);
+            }
+            simulation::CycleTimeResult r;
+            {
+              py::gil_scoped_release release;
+              r = benchmark.run(joint_waypoints, strategy);
+            }
+            py::dict result;
+            result["duration"] = r.duration;
+            result["planning_time"] = r.planning_time;
+            result["max_tick_time"] = r.max_tick_time;
+            result["peak_velocity"] = r.peak_velocity;
+            result["peak_torque"] = r.peak_torque;
+            result["velocity_utilization"] = r.velocity_utilization;
+            result["torque_utilization"] = r.torque_utilization;
+            result["failed"] = r.failed;
+            result["error"] = r.error;
+            return result;
+          },
+          py::arg("waypoints"), py::arg("strategy"), R"delim(
+              Move through joint waypoints (N x 7) with `strategy`, starting
+              at rest at the first one.
+
+              Returns:
+                Dictionary with the motion duration, planning_time before
+                the first command and max_tick_time of later commands in
+                seconds, the per-joint peak_velocity and peak_torque, their
+                velocity_utilization and torque_utilization, i.e. the
+                largest ratio to the joint limits, failed and error.
+          )delim");
+
   py::enum_<motion::ReferenceFrame>(m, "ReferenceFrame")
       .value("GLOBAL", motion::ReferenceFrame::GLOBAL)
       .value("RELATIVE", motion::ReferenceFrame::RELATIVE);
@@ -364,8 +2093,112 @@ PYBIND11_MODULE(_core, m) {
       .def("add_waypoint", &motion::JointMotionGenerator::addWaypoint,
            py::arg("waypoint"))
       .def("clear_waypoints", &motion::JointMotionGenerator::clearWaypoints)
-      .def("add_waypoints", &motion::JointMotionGenerator::addWaypoints,
-           py::arg("waypoints"));
+      .def("add_waypoints",
+           py::overload_cast<const std::vector<motion::JointMotion> &>(
+               &motion::JointMotionGenerator::addWaypoints),
+           py::arg("waypoints"))
+      .def(
+          "add_waypoints",
+          [](motion::JointMotionGenerator &generator,
+             const DoubleArray &targets, const py::object &velocity_rel,
+             const py::object &acceleration_rel, const py::object &jerk_rel) {
+            if (targets.ndim() != 2 || targets.shape(1) != 7) {
+              throw std::invalid_argument(
+                  "Joint waypoints must have shape (N, 7).");
+            }
+            const size_t count = targets.shape(0);
+            auto velocity = waypointScales(velocity_rel, count, "velocity_rel");
+            auto acceleration =
+                waypointScales(acceleration_rel, count, "acceleration_rel");
+            auto jerk = waypointScales(jerk_rel, count, "jerk_rel");
+            generator.addWaypoints(targets.data(), count, scaleData(velocity),
+                                   scaleData(acceleration), scaleData(jerk));
+          },
+          py::arg("targets"), py::arg("velocity_rel") = py::none(),
+          py::arg("acceleration_rel") = py::none(),
+          py::arg("jerk_rel") = py::none(), R"delim(
+              Append waypoints from an array in one pass, without creating
+              :py:class:`JointMotion` objects.
+
+              Args:
+                targets: Joint positions of shape (N, 7).
+                velocity_rel: Velocity scale, a scalar or one per waypoint.
+                acceleration_rel: Acceleration scale, a scalar or one per
+                  waypoint.
+                jerk_rel: Jerk scale, a scalar or one per waypoint.
+          )delim");
+
+  py::class_<motion::JointTrajectoryGenerator, motion::Generator,
+             std::shared_ptr<motion::JointTrajectoryGenerator>>(
+      m, "JointTrajectoryGenerator", R"delim(
+          Executes a :py:class:`JerkLimitedTrajectory` on the joint position
+          interface. The trajectory has to start at the current joint
+          positions.
+      )delim")
+      .def(py::init<std::shared_ptr<motion::JerkLimitedTrajectory>,
+                    std::function<void()>>(),
+           py::arg("trajectory"), py::arg("done_callback") = nullptr);
+
+  py::class_<motion::JointVelocityStreamGenerator, motion::Generator,
+             std::shared_ptr<motion::JointVelocityStreamGenerator>>(
+      m, "JointVelocityStreamGenerator", R"delim(
+          Streams joint velocity commands on the joint velocity interface,
+          e.g. for teleoperation. The latest command is tracked within the
+          velocity, acceleration and jerk limits. If no new command arrives
+          within `timeout` seconds, the robot decelerates to rest and waits
+          for the next command.
+      )delim")
+      .def(py::init<double, double, double, double, std::function<void()>>(),
+           py::arg("timeout") =
+               motion::JointVelocityStreamGenerator::kDefaultTimeout,
+           py::arg("velocity_rel") = 1.0, py::arg("acceleration_rel") = 1.0,
+           py::arg("jerk_rel") = 1.0, py::arg("done_callback") = nullptr)
+      .def("set_velocity", &motion::JointVelocityStreamGenerator::setVelocity,
+           py::arg("velocity"), R"delim(
+          Command joint velocities, picked up at the next control tick.
+      )delim")
+      .def_property_readonly(
+          "command", &motion::JointVelocityStreamGenerator::getCommandBuffer,
+          R"delim(
+          :py:class:`SetpointBuffer` holding the commanded joint velocities,
+          write into its array and commit to avoid copies.
+      )delim")
+      .def_property_readonly("timed_out",
+                             &motion::JointVelocityStreamGenerator::isTimedOut,
+                             R"delim(
+          Whether the last command is older than the timeout.
+      )delim");
+
+  py::class_<motion::CartesianVelocityStreamGenerator, motion::Generator,
+             std::shared_ptr<motion::CartesianVelocityStreamGenerator>>(
+      m, "CartesianVelocityStreamGenerator", R"delim(
+          Streams end-effector twists in the base frame on the Cartesian
+          velocity interface, translational followed by angular velocity.
+          Limited and guarded by a timeout like
+          :py:class:`JointVelocityStreamGenerator`, except that the
+          translational and angular velocity are limited by their norms.
+      )delim")
+      .def(py::init<double, double, double, double, std::function<void()>>(),
+           py::arg("timeout") =
+               motion::CartesianVelocityStreamGenerator::kDefaultTimeout,
+           py::arg("velocity_rel") = 1.0, py::arg("acceleration_rel") = 1.0,
+           py::arg("jerk_rel") = 1.0, py::arg("done_callback") = nullptr)
+      .def("set_twist", &motion::CartesianVelocityStreamGenerator::setTwist,
+           py::arg("twist"), R"delim(
+          Command an end-effector twist, picked up at the next control tick.
+      )delim")
+      .def_property_readonly(
+          "command",
+          &motion::CartesianVelocityStreamGenerator::getCommandBuffer,
+          R"delim(
+          :py:class:`SetpointBuffer` holding the commanded twist, write into
+          its array and commit to avoid copies.
+      )delim")
+      .def_property_readonly(
+          "timed_out", &motion::CartesianVelocityStreamGenerator::isTimedOut,
+          R"delim(
+          Whether the last command is older than the timeout.
+      )delim");
 
   py::class_<motion::CartesianMotionGenerator, motion::Generator,
              std::shared_ptr<motion::CartesianMotionGenerator>>(
@@ -375,6 +2208,56 @@ PYBIND11_MODULE(_core, m) {
       .def("add_waypoint", &motion::CartesianMotionGenerator::addWaypoint,
            py::arg("waypoint"))
       .def("clear_waypoints", &motion::CartesianMotionGenerator::clearWaypoints)
-      .def("add_waypoints", &motion::CartesianMotionGenerator::addWaypoints,
-           py::arg("waypoints"));
+      .def("add_waypoints",
+           py::overload_cast<const std::vector<motion::CartesianMotion> &>(
+               &motion::CartesianMotionGenerator::addWaypoints),
+           py::arg("waypoints"))
+      .def(
+          "add_waypoints",
+          [](motion::CartesianMotionGenerator &generator,
+             const DoubleArray &poses, const py::object &velocity_rel,
+             const py::object &acceleration_rel, const py::object &jerk_rel,
+             motion::ReferenceFrame reference_frame) {
+            size_t row_size = 0;
+            if (poses.ndim() == 3 && poses.shape(1) == 4 &&
+                poses.shape(2) == 4) {
+              row_size = 16;
+            } else if (poses.ndim() == 2 && poses.shape(1) == 7) {
+              row_size = 7;
+            } else {
+              throw std::invalid_argument(
+                  "Pose waypoints must have shape (N, 4, 4) or (N, 7).");
+            }
+            const size_t count = poses.shape(0);
+            auto velocity = waypointScales(velocity_rel, count, "velocity_rel");
+            auto acceleration =
+                waypointScales(acceleration_rel, count, "acceleration_rel");
+            auto jerk = waypointScales(jerk_rel, count, "jerk_rel");
+            generator.addWaypoints(poses.data(), count, row_size,
+                                   reference_frame, scaleData(velocity),
+                                   scaleData(acceleration), scaleData(jerk));
+          },
+          py::arg("poses"), py::arg("velocity_rel") = py::none(),
+          py::arg("acceleration_rel") = py::none(),
+          py::arg("jerk_rel") = py::none(),
+          py::arg("reference_frame") = motion::ReferenceFrame::GLOBAL,
+          R"delim(
+              Append waypoints from an array in one pass, without creating
+              :py:class:`CartesianMotion` objects.
+
+              Args:
+                poses: Homogeneous transforms of shape (N, 4, 4) or positions
+                  followed by quaternions (x, y, z, w) of shape (N, 7).
+                velocity_rel: Velocity scale, a scalar or one per waypoint.
+                acceleration_rel: Acceleration scale, a scalar or one per
+                  waypoint.
+                jerk_rel: Jerk scale, a scalar or one per waypoint.
+                reference_frame: Frame the poses are expressed in.
+          )delim")
+      .def_property_readonly(
+          "speed_scale", &motion::CartesianMotionGenerator::getSpeedScale,
+          R"delim(
+          Current scale of the Cartesian velocity limits. Lowered where the
+          profile would exceed the joint limits, e.g. close to singularities.
+      )delim");
 }
@@ -0,0 +1,108 @@
+#include "batch_model.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+
+#include "trace.h"
+
+namespace {
+std::array<double, 7> _row(const double *data, size_t i) {
+  std::array<double, 7> row;
+  std::copy(data + 7 * i, data + 7 * (i + 1), row.begin());
+  return row;
+}
+
+// Copy a column-major libfranka array into a row-major output matrix
+template <int Rows, int Cols>
+void _store(const std::array<double, Rows * Cols> &matrix, double *out,
+            size_t i) {
+  Eigen::Map<Eigen::Matrix<double, Rows, Cols, Eigen::RowMajor>>(
+      out + Rows * Cols * i) =
+      Eigen::Map<const Eigen::Matrix<double, Rows, Cols>>(matrix.data());
+}
+
+void _store(const std::array<double, 7> &vector, double *out, size_t i) {
+  std::copy(vector.begin(), vector.end(), out + 7 * i);
+}
+}  // namespace
+
+BatchModel::BatchModel(const franka::Model &model,
+                       ThreadPool::Priority priority)
+    : model_(model), priority_(priority) {}
+
+template <typename Function>
+void BatchModel::_forEach(size_t n, const Function &f) const {
+  const size_t num_chunks = (n + kChunkSize - 1) / kChunkSize;
+  ThreadPool::instance().parallelFor(
+      num_chunks,
+      [&](size_t chunk) {
+        const size_t end = std::min(n, (chunk + 1) * kChunkSize);
+        for (size_t i = chunk * kChunkSize; i < end; i++) {
+          f(i);
+        }
+      },
+      priority_);
+}
+
+void BatchModel::pose(franka::Frame frame, const double *q, size_t n,
+                      const std::array<double, 16> &F_T_EE,
+                      const std::array<double, 16> &EE_T_K,
+                      double *poses) const {
+  TraceScope scope("model", "pose_batch");
+  _forEach(n, [&](size_t i) {
+    _store<4, 4>(model_.pose(frame, _row(q, i), F_T_EE, EE_T_K), poses, i);
+  });
+}
+
+void BatchModel::bodyJacobian(franka::Frame frame, const double *q, size_t n,
+                              const std::array<double, 16> &F_T_EE,
+                              const std::array<double, 16> &EE_T_K,
+                              double *jacobians) const {
+  TraceScope scope("model", "body_jacobian_batch");
+  _forEach(n, [&](size_t i) {
+    _store<6, 7>(model_.bodyJacobian(frame, _row(q, i), F_T_EE, EE_T_K),
+                 jacobians, i);
+  });
+}
+
+void BatchModel::zeroJacobian(franka::Frame frame, const double *q, size_t n,
+                              const std::array<double, 16> &F_T_EE,
+                              const std::array<double, 16> &EE_T_K,
+                              double *jacobians) const {
+  TraceScope scope("model", "zero_jacobian_batch");
+  _forEach(n, [&](size_t i) {
+    _store<6, 7>(model_.zeroJacobian(frame, _row(q, i), F_T_EE, EE_T_K),
+                 jacobians, i);
+  });
+}
+
+void BatchModel::mass(const double *q, size_t n, const Load &load,
+                      double *mass) const {
+  TraceScope scope("model", "mass_batch");
+  _forEach(n, [&](size_t i) {
+    _store<7, 7>(
+        model_.mass(_row(q, i), load.I_total, load.m_total, load.F_x_Ctotal),
+        mass, i);
+  });
+}
+
+void BatchModel::coriolis(const double *q, const double *dq, size_t n,
+                          const Load &load, double *coriolis) const {
+  TraceScope scope("model", "coriolis_batch");
+  _forEach(n, [&](size_t i) {
+    _store(model_.coriolis(_row(q, i), _row(dq, i), load.I_total,
+                           load.m_total, load.F_x_Ctotal),
+           coriolis, i);
+  });
+}
+
+void BatchModel::gravity(const double *q, size_t n, const Load &load,
+                         const std::array<double, 3> &gravity_earth,
+                         double *gravity) const {
+  TraceScope scope("model", "gravity_batch");
+  _forEach(n, [&](size_t i) {
+    _store(model_.gravity(_row(q, i), load.m_total, load.F_x_Ctotal,
+                          gravity_earth),
+           gravity, i);
+  });
+}
@@ -55,7 +55,7 @@ void AppliedForce::setFilter(const double filter_coeff) {
 }
 
 void AppliedForce::start(const franka::RobotState &robot_state,
-                         std::shared_ptr<franka::Model> model) {
+                         std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   f_d_.setZero();
   f_d_target_.setZero();
@@ -63,7 +63,7 @@ void AppliedForce::start(const franka::RobotState &robot_state,
 }
 
 void AppliedForce::stop(const franka::RobotState &robot_state,
-                        std::shared_ptr<franka::Model> model) {
+                        std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
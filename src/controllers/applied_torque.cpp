@@ -51,14 +51,14 @@ void AppliedTorque::setFilter(const double filter_coeff) {
 }
 
 void AppliedTorque::start(const franka::RobotState &robot_state,
-                          std::shared_ptr<franka::Model> model) {
+                          std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   tau_d_.setZero();
   tau_d_target_.setZero();
 }
 
 void AppliedTorque::stop(const franka::RobotState &robot_state,
-                         std::shared_ptr<franka::Model> model) {
+                         std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
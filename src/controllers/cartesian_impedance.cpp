@@ -1,7 +1,9 @@
 #include "controllers/cartesian_impedance.h"
 
 #include <iostream>
+#include <stdexcept>
 
+#include "kinematics/manipulability.h"
 #include "panda.h"
 
 // clang-format off
@@ -29,6 +31,7 @@ CartesianImpedance::CartesianImpedance(
   nullspace_stiffness_ = nullspace_stiffness;
   nullspace_stiffnes_target_ = nullspace_stiffness;
   filter_coeff_ = filter_coeff;
+  setpoint_buffer_ = std::make_shared<SetpointBuffer>(14);
 };
 
 void CartesianImpedance::_computeDamping() {
@@ -41,14 +44,25 @@ franka::Torques CartesianImpedance::step(const franka::RobotState &robot_state,
   Eigen::Quaterniond orientation_d;
   Vector7d q_nullspace_d;
   Eigen::Matrix<double, 6, 6> K_p, K_d;
+  NullspaceObjective nullspace_objective;
+  double manipulability_weight, joint_limit_weight;
+  double manipulability_threshold, max_damping;
   // These quantities may be modified outside of the control loop
   mux_.lock();
+  if (setpoint_buffer_->read(setpoint_.data(), setpoint_version_)) {
+    _setSetpoint(setpoint_.data(), setpoint_.size());
+  }
   _updateFilter();
   K_p = K_p_;
   K_d = K_d_;
   position_d = position_d_;
   orientation_d = orientation_d_;
   q_nullspace_d = q_nullspace_d_;
+  nullspace_objective = nullspace_objective_;
+  manipulability_weight = manipulability_weight_;
+  joint_limit_weight = joint_limit_weight_;
+  manipulability_threshold = manipulability_threshold_;
+  max_damping = max_damping_;
   mux_.unlock();
 
   // get state variables
@@ -83,20 +97,33 @@ franka::Torques CartesianImpedance::step(const franka::RobotState &robot_state,
   error.tail(3) << -transform.rotation() * error.tail(3);
 
   // compute control
-  // allocate variables
-  Eigen::VectorXd tau_task(7), tau_nullspace(7), tau_d(7);
+  Vector7d tau_task, tau_nullspace, tau_d;
 
-  // pseudoinverse for nullspace handling
-  // kinematic pseuoinverse
-  Eigen::MatrixXd jacobian_transpose_pinv;
-  pseudoInverse(jacobian.transpose(), jacobian_transpose_pinv);
+  // kinematic pseudoinverse for nullspace handling, exact away from
+  // singularities and damped close to them
+  Eigen::Matrix<double, 7, 6> jacobian_pinv;
+  kinematics::dampedPseudoInverse(jacobian, jacobian_pinv,
+                                  manipulability_threshold, max_damping);
 
   // Cartesian PD control with damping ratio = 1
   tau_task << jacobian.transpose() * (-K_p * error - K_d * (jacobian * dq));
-  // nullspace PD control with damping ratio = 1
-  tau_nullspace << (Eigen::MatrixXd::Identity(7, 7) -
-                    jacobian.transpose() * jacobian_transpose_pinv) *
-                       (nullspace_stiffness_ * (q_nullspace_d - q) -
+  // nullspace PD control with damping ratio = 1, either towards the
+  // nullspace joint positions or along the gradient of the objective
+  Vector7d nullspace_error;
+  if (nullspace_objective == NullspaceObjective::kManipulability) {
+    // The gradient doesn't vanish at the optimum, restrict it to the exact
+    // nullspace so the projection below, damped close to singularities,
+    // doesn't leak it into the task
+    nullspace_error = kinematics::nullspaceComponent(
+        jacobian,
+        manipulability_weight * kinematics::manipulabilityGradient(jacobian) +
+            joint_limit_weight * kinematics::jointLimitGradient(q));
+  } else {
+    nullspace_error = q_nullspace_d - q;
+  }
+  tau_nullspace << (Eigen::Matrix<double, 7, 7>::Identity() -
+                    jacobian_pinv * jacobian) *
+                       (nullspace_stiffness_ * nullspace_error -
                         (2.0 * sqrt(nullspace_stiffness_)) * dq);
   // Desired torque
   tau_d << tau_task + tau_nullspace + coriolis;
@@ -114,15 +141,17 @@ void CartesianImpedance::_updateFilter() {
   position_d_ =
       ema_filter(position_d_, position_d_target_, filter_coeff_, true);
   orientation_d_ = orientation_d_.slerp(filter_coeff_, orientation_d_target_);
+  q_nullspace_d_ =
+      ema_filter(q_nullspace_d_, q_nullspace_d_target_, filter_coeff_, true);
 }
 
 void CartesianImpedance::setControl(const Eigen::Vector3d &position,
                                     const Eigen::Vector4d &orientation,
-                                    const Vector7d &q_nullspace) {
+                                    const std::optional<Vector7d> &q_nullspace) {
   std::lock_guard<std::mutex> lock(mux_);
   position_d_target_ = position;
   orientation_d_target_ = orientation;
-  q_nullspace_d_target_ = q_nullspace;
+  if (q_nullspace) q_nullspace_d_target_ = *q_nullspace;
 }
 
 void CartesianImpedance::setImpedance(
@@ -144,13 +173,59 @@ void CartesianImpedance::setNullspaceStiffness(
   nullspace_stiffnes_target_ = nullspace_stiffness;
 }
 
+void CartesianImpedance::setNullspaceObjective(NullspaceObjective objective,
+                                               double manipulability_weight,
+                                               double joint_limit_weight) {
+  if (manipulability_weight < 0.0 || joint_limit_weight < 0.0) {
+    throw std::invalid_argument("Objective weights must be non-negative.");
+  }
+  std::lock_guard<std::mutex> lock(mux_);
+  nullspace_objective_ = objective;
+  manipulability_weight_ = manipulability_weight;
+  joint_limit_weight_ = joint_limit_weight;
+}
+
+void CartesianImpedance::setSingularityDamping(double manipulability_threshold,
+                                               double max_damping) {
+  if (manipulability_threshold < 0.0 || max_damping < 0.0) {
+    throw std::invalid_argument(
+        "Manipulability threshold and damping must be non-negative.");
+  }
+  std::lock_guard<std::mutex> lock(mux_);
+  manipulability_threshold_ = manipulability_threshold;
+  max_damping_ = max_damping;
+}
+
 void CartesianImpedance::setFilter(const double filter_coeff) {
   std::lock_guard<std::mutex> lock(mux_);
   filter_coeff_ = filter_coeff;
 }
 
+void CartesianImpedance::applySetpoint(const double *setpoint, size_t size) {
+  std::lock_guard<std::mutex> lock(mux_);
+  _setSetpoint(setpoint, size);
+}
+
+void CartesianImpedance::_setSetpoint(const double *setpoint, size_t size) {
+  // Position and orientation (scalar last), optionally followed by the
+  // nullspace joint positions
+  position_d_target_ = Eigen::Map<const Eigen::Vector3d>(setpoint);
+  orientation_d_target_.coeffs() = Eigen::Map<const Eigen::Vector4d>(setpoint + 3);
+  if (size >= 14) {
+    q_nullspace_d_target_ = Eigen::Map<const Vector7d>(setpoint + 7);
+  }
+}
+
+bool CartesianImpedance::acceptsSetpoint(size_t size) {
+  return size == 7 || size == 14;
+}
+
+std::shared_ptr<SetpointBuffer> CartesianImpedance::getSetpointBuffer() {
+  return setpoint_buffer_;
+}
+
 void CartesianImpedance::start(const franka::RobotState &robot_state,
-                               std::shared_ptr<franka::Model> model) {
+                               std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   Eigen::Affine3d transform(Eigen::Matrix4d::Map(robot_state.O_T_EE.data()));
   Eigen::Vector3d position(transform.translation());
@@ -163,10 +238,15 @@ void CartesianImpedance::start(const franka::RobotState &robot_state,
   q_nullspace_d_ = q;
   q_nullspace_d_target_ = q;
   model_ = model;
+  // Start the shared setpoint from the current pose
+  Eigen::Matrix<double, 14, 1> setpoint;
+  setpoint << position, orientation.coeffs(), q;
+  setpoint_buffer_->reset(setpoint.data());
+  setpoint_buffer_->read(setpoint_.data(), setpoint_version_);
 }
 
 void CartesianImpedance::stop(const franka::RobotState &robot_state,
-                              std::shared_ptr<franka::Model> model) {
+                              std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
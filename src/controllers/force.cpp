@@ -82,6 +82,13 @@ void Force::setControl(const Eigen::Vector3d &force) {
   f_d_target_ = force;
 }
 
+void Force::applySetpoint(const double *setpoint, size_t size) {
+  std::lock_guard<std::mutex> lock(mux_);
+  f_d_target_ = Eigen::Map<const Eigen::Vector3d>(setpoint);
+}
+
+bool Force::acceptsSetpoint(size_t size) { return size == 3; }
+
 void Force::setFilter(const double &filter_coeff) {
   std::lock_guard<std::mutex> lock(mux_);
   filter_coeff_ = filter_coeff;
@@ -108,7 +115,7 @@ void Force::setDamping(const Vector7d &damping) {
 }
 
 void Force::start(const franka::RobotState &robot_state,
-                  std::shared_ptr<franka::Model> model) {
+                  std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   f_d_.setZero();
   f_d_target_.setZero();
@@ -132,7 +139,7 @@ void Force::start(const franka::RobotState &robot_state,
 }
 
 void Force::stop(const franka::RobotState &robot_state,
-                 std::shared_ptr<franka::Model> model) {
+                 std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
@@ -0,0 +1,367 @@
+#include "controllers/hybrid_force_impedance.h"
+
+#include <stdexcept>
+
+// clang-format off
+static const double kDefaultImpedanceData[36] = {600,   0,   0,  0,  0,  0,
+                                                   0, 600,   0,  0,  0,  0,
+                                                   0,   0, 600,  0,  0,  0,
+                                                   0,   0,   0, 30,  0,  0,
+                                                   0,   0,   0,  0, 30,  0,
+                                                   0,   0,   0,  0,  0, 30};
+// clang-format on
+const Eigen::Matrix<double, 6, 6> HybridForceImpedance::kDefaultImpedance =
+    Eigen::Matrix<double, 6, 6>(kDefaultImpedanceData);
+const double HybridForceImpedance::kDefaultDampingRatio = 1.0;
+const double HybridForceImpedance::kDefaultNullspaceStiffness = 0.5;
+const double HybridForceImpedance::kDefaultProportionalGain = 0.5;
+const double HybridForceImpedance::kDefaultIntegralGain = 5.0;
+const double HybridForceImpedance::kDefaultFilterCoeff = 1.0;
+const double HybridForceImpedance::kDefaultSelectionRampTime = 0.1;
+
+static const double kDefaultForceDampingData[6] = {30, 30, 30, 2, 2, 2};
+const Vector6d HybridForceImpedance::kDefaultForceDamping =
+    Vector6d(kDefaultForceDampingData);
+static const double kDefaultIntegralLimitData[6] = {5, 5, 5, 0.5, 0.5, 0.5};
+const Vector6d HybridForceImpedance::kDefaultIntegralLimit =
+    Vector6d(kDefaultIntegralLimitData);
+static const double kDefaultWrenchLimitData[6] = {40, 40, 40, 5, 5, 5};
+const Vector6d HybridForceImpedance::kDefaultWrenchLimit =
+    Vector6d(kDefaultWrenchLimitData);
+
+HybridForceImpedance::HybridForceImpedance(
+    const Eigen::Matrix<double, 6, 6> &impedance, const double &damping_ratio,
+    const double &nullspace_stiffness, const double &k_p, const double &k_i,
+    const Vector6d &force_damping, const double &filter_coeff)
+    : K_p_(impedance),
+      K_p_target_(impedance),
+      D_f_(force_damping),
+      D_f_target_(force_damping),
+      integral_limit_(kDefaultIntegralLimit),
+      wrench_limit_(kDefaultWrenchLimit),
+      filter_coeff_(filter_coeff),
+      nullspace_stiffness_(nullspace_stiffness),
+      nullspace_stiffness_target_(nullspace_stiffness),
+      damping_ratio_(damping_ratio),
+      k_p_(k_p),
+      k_i_(k_i),
+      k_p_target_(k_p),
+      k_i_target_(k_i),
+      contact_force_(0),
+      displacement_limit_(0),
+      selection_ramp_time_(kDefaultSelectionRampTime) {
+  _computeDamping();
+  K_d_ = K_d_target_;
+  S_.setZero();
+  S_target_.setZero();
+  F_d_.setZero();
+  F_d_target_.setZero();
+  F_ff_.setZero();
+  F_ff_target_.setZero();
+  wrench_.setZero();
+  contact_selection_.setZero();
+  in_contact_ = false;
+  limit_exceeded_ = false;
+}
+
+void HybridForceImpedance::_computeDamping() {
+  K_d_target_ = damping_ratio_ * 2 * K_p_target_.cwiseSqrt();
+}
+
+franka::Torques HybridForceImpedance::step(
+    const franka::RobotState &robot_state, franka::Duration &duration) {
+  // get state variables
+  std::array<double, 7> coriolis_array = model_->coriolis(robot_state);
+  std::array<double, 7> gravity_array = model_->gravity(robot_state);
+  std::array<double, 42> jacobian_array =
+      model_->zeroJacobian(franka::Frame::kEndEffector, robot_state);
+  Eigen::Map<const Vector7d> coriolis(coriolis_array.data());
+  Eigen::Map<const Vector7d> gravity(gravity_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+  Eigen::Map<const Vector7d> tau_measured(robot_state.tau_J.data());
+  Vector7d q = Eigen::Map<const Vector7d>(robot_state.q.data());
+  Vector7d dq = Eigen::Map<const Vector7d>(robot_state.dq.data());
+  Eigen::Affine3d transform(Eigen::Matrix4d::Map(robot_state.O_T_EE.data()));
+  Eigen::Vector3d position(transform.translation());
+  Eigen::Quaterniond orientation(transform.rotation());
+
+  Vector7d tau_ext = tau_measured - gravity - tau_ext_init_;
+  Vector6d velocity = jacobian * dq;
+
+  // These quantities may be modified outside of the control loop
+  mux_.lock();
+  // Damped pseudoinverse, exact away from singularities and damped close to
+  // them, so neither the wrench estimate nor the nullspace projection blow
+  // up where the Jacobian is ill-conditioned
+  Eigen::Matrix<double, 7, 6> jacobian_pinv;
+  kinematics::dampedPseudoInverse(jacobian, jacobian_pinv,
+                                  manipulability_threshold_, max_damping_);
+  // Wrench exerted by the end-effector, estimated from joint torques through
+  // (J^T)^+ = (J^+)^T
+  Vector6d wrench = jacobian_pinv.transpose() * tau_ext;
+  wrench_ = wrench;
+  _updateTransitions(position);
+  _updateFilter();
+  _updateSelection(duration.toSec());
+  // Translational axes selected for force control hold the measured position
+  // as their setpoint, switching them back to impedance control starts from
+  // zero pose error while the selection ramps down
+  for (int i = 0; i < 3; i++) {
+    if (S_target_[i] > 0.5) {
+      position_d_[i] = position[i];
+      position_d_target_[i] = position[i];
+    }
+  }
+  Eigen::Matrix<double, 6, 6> K_p = K_p_, K_d = K_d_;
+  Eigen::Vector3d position_d = position_d_;
+  Eigen::Quaterniond orientation_d = orientation_d_;
+  Vector7d q_nullspace_d = q_nullspace_d_;
+  Vector6d S = S_, F_d = F_d_, F_ff = F_ff_, D_f = D_f_;
+  Vector6d integral_limit = integral_limit_, wrench_limit = wrench_limit_;
+  double k_p = k_p_, k_i = k_i_, nullspace_stiffness = nullspace_stiffness_;
+  mux_.unlock();
+
+  // Pose error, same convention as CartesianImpedance
+  Vector6d error;
+  error.head(3) << position - position_d;
+  if (orientation_d.coeffs().dot(orientation.coeffs()) < 0.0) {
+    orientation.coeffs() << -orientation.coeffs();
+  }
+  Eigen::Quaterniond error_quaternion(orientation.inverse() * orientation_d);
+  error.tail(3) << error_quaternion.x(), error_quaternion.y(),
+      error_quaternion.z();
+  error.tail(3) << -transform.rotation() * error.tail(3);
+
+  // Feedforward plus PI on the wrench error with anti-windup: the integrator
+  // is cleared on impedance axes, clamped, and frozen while the output
+  // saturates in the direction of the error
+  Vector6d wrench_error = F_d - wrench;
+  Vector6d F_force = F_d + k_p * wrench_error + k_i * integral_;
+  for (int i = 0; i < 6; i++) {
+    bool saturated = std::abs(F_force[i]) > wrench_limit[i] &&
+                     F_force[i] * wrench_error[i] > 0;
+    if (S[i] < 1e-3) {
+      integral_[i] = 0;
+    } else if (!saturated) {
+      integral_[i] += duration.toSec() * S[i] * wrench_error[i];
+      integral_[i] = std::max(-integral_limit[i],
+                              std::min(integral_limit[i], integral_[i]));
+    }
+    F_force[i] = std::max(-wrench_limit[i], std::min(wrench_limit[i], F_force[i]));
+  }
+  F_force -= D_f.asDiagonal() * velocity;
+
+  Vector6d F_motion = -K_p * error - K_d * velocity;
+  Vector6d F = (Vector6d::Ones() - S).asDiagonal() * F_motion +
+               S.asDiagonal() * F_force + F_ff;
+
+  Vector7d tau_task = jacobian.transpose() * F;
+  Vector7d tau_nullspace = (Eigen::Matrix<double, 7, 7>::Identity() -
+                            jacobian_pinv * jacobian) *
+                           (nullspace_stiffness * (q_nullspace_d - q) -
+                            (2.0 * sqrt(nullspace_stiffness)) * dq);
+  Vector7d tau_d = tau_task + tau_nullspace + coriolis;
+
+  franka::Torques torques = VectorToArray(tau_d);
+  torques.motion_finished = motion_finished_;
+  return torques;
+}
+
+void HybridForceImpedance::_updateTransitions(
+    const Eigen::Vector3d &position) {
+  if (contact_armed_) {
+    Eigen::Vector3d force =
+        contact_selection_.head(3).asDiagonal() * wrench_.head(3);
+    if (force.norm() > contact_force_) {
+      contact_armed_ = false;
+      in_contact_ = true;
+      S_target_ = contact_selection_;
+      position_anchor_ = position;
+    }
+  }
+  if (displacement_limit_ > 0) {
+    Eigen::Vector3d displacement =
+        S_.head(3).asDiagonal() * (position - position_anchor_);
+    if (displacement.norm() > displacement_limit_) {
+      // Lost contact or pushing through, hold the current pose instead
+      S_target_.setZero();
+      position_d_target_ = position;
+      limit_exceeded_ = true;
+      in_contact_ = false;
+    }
+  }
+}
+
+void HybridForceImpedance::_updateFilter() {
+  K_p_ = ema_filter(K_p_, K_p_target_, filter_coeff_, true);
+  K_d_ = ema_filter(K_d_, K_d_target_, filter_coeff_, true);
+  nullspace_stiffness_ = ema_filter(
+      nullspace_stiffness_, nullspace_stiffness_target_, filter_coeff_, true);
+  position_d_ =
+      ema_filter(position_d_, position_d_target_, filter_coeff_, true);
+  orientation_d_ = orientation_d_.slerp(filter_coeff_, orientation_d_target_);
+  q_nullspace_d_ =
+      ema_filter(q_nullspace_d_, q_nullspace_d_target_, filter_coeff_, true);
+  F_d_ = ema_filter(F_d_, F_d_target_, filter_coeff_, true);
+  F_ff_ = ema_filter(F_ff_, F_ff_target_, filter_coeff_, true);
+  D_f_ = ema_filter(D_f_, D_f_target_, filter_coeff_, true);
+  k_p_ = ema_filter(k_p_, k_p_target_, filter_coeff_, true);
+  k_i_ = ema_filter(k_i_, k_i_target_, filter_coeff_, true);
+}
+
+void HybridForceImpedance::_updateSelection(double dt) {
+  if (selection_ramp_time_ <= 0) {
+    S_ = S_target_;
+    return;
+  }
+  const double step = dt / selection_ramp_time_;
+  S_ += (S_target_ - S_).cwiseMax(-step).cwiseMin(step);
+}
+
+void HybridForceImpedance::setControl(const Eigen::Vector3d &position,
+                                      const Eigen::Vector4d &orientation,
+                                      const Vector6d &wrench,
+                                      const Vector7d &q_nullspace) {
+  std::lock_guard<std::mutex> lock(mux_);
+  position_d_target_ = position;
+  orientation_d_target_ = orientation;
+  F_d_target_ = wrench;
+  q_nullspace_d_target_ = q_nullspace;
+}
+
+void HybridForceImpedance::setSelection(const Vector6d &selection) {
+  std::lock_guard<std::mutex> lock(mux_);
+  S_target_ = selection.cwiseMax(0.0).cwiseMin(1.0);
+  position_anchor_ = position_d_;
+  limit_exceeded_ = false;
+}
+
+void HybridForceImpedance::setFeedforward(const Vector6d &wrench) {
+  std::lock_guard<std::mutex> lock(mux_);
+  F_ff_target_ = wrench;
+}
+
+void HybridForceImpedance::setImpedance(
+    const Eigen::Matrix<double, 6, 6> &impedance) {
+  std::lock_guard<std::mutex> lock(mux_);
+  K_p_target_ = impedance;
+  _computeDamping();
+}
+
+void HybridForceImpedance::setDampingRatio(const double &damping_ratio) {
+  std::lock_guard<std::mutex> lock(mux_);
+  damping_ratio_ = damping_ratio;
+  _computeDamping();
+}
+
+void HybridForceImpedance::setNullspaceStiffness(
+    const double &nullspace_stiffness) {
+  std::lock_guard<std::mutex> lock(mux_);
+  nullspace_stiffness_target_ = nullspace_stiffness;
+}
+
+void HybridForceImpedance::setForceGains(const double &k_p,
+                                         const double &k_i) {
+  std::lock_guard<std::mutex> lock(mux_);
+  k_p_target_ = k_p;
+  k_i_target_ = k_i;
+}
+
+void HybridForceImpedance::setForceDamping(const Vector6d &force_damping) {
+  std::lock_guard<std::mutex> lock(mux_);
+  D_f_target_ = force_damping;
+}
+
+void HybridForceImpedance::setIntegralLimit(const Vector6d &limit) {
+  std::lock_guard<std::mutex> lock(mux_);
+  integral_limit_ = limit.cwiseAbs();
+}
+
+void HybridForceImpedance::setWrenchLimit(const Vector6d &limit) {
+  std::lock_guard<std::mutex> lock(mux_);
+  wrench_limit_ = limit.cwiseAbs();
+}
+
+void HybridForceImpedance::setFilter(const double filter_coeff) {
+  std::lock_guard<std::mutex> lock(mux_);
+  filter_coeff_ = filter_coeff;
+}
+
+void HybridForceImpedance::setSelectionRampTime(const double &duration) {
+  std::lock_guard<std::mutex> lock(mux_);
+  selection_ramp_time_ = std::max(duration, 0.0);
+}
+
+void HybridForceImpedance::setSingularityDamping(
+    double manipulability_threshold, double max_damping) {
+  if (manipulability_threshold < 0.0 || max_damping < 0.0) {
+    throw std::invalid_argument(
+        "Manipulability threshold and damping must be non-negative.");
+  }
+  std::lock_guard<std::mutex> lock(mux_);
+  manipulability_threshold_ = manipulability_threshold;
+  max_damping_ = max_damping;
+}
+
+void HybridForceImpedance::setContactTransition(const Vector6d &selection,
+                                                const double &force) {
+  std::lock_guard<std::mutex> lock(mux_);
+  contact_selection_ = selection.cwiseMax(0.0).cwiseMin(1.0);
+  contact_force_ = force;
+  contact_armed_ = force > 0;
+  in_contact_ = false;
+}
+
+void HybridForceImpedance::setDisplacementLimit(const double &distance) {
+  std::lock_guard<std::mutex> lock(mux_);
+  displacement_limit_ = distance;
+  limit_exceeded_ = false;
+}
+
+bool HybridForceImpedance::isInContact() { return in_contact_; }
+
+bool HybridForceImpedance::isLimitExceeded() { return limit_exceeded_; }
+
+Vector6d HybridForceImpedance::getWrench() {
+  std::lock_guard<std::mutex> lock(mux_);
+  return wrench_;
+}
+
+Vector6d HybridForceImpedance::getSelection() {
+  std::lock_guard<std::mutex> lock(mux_);
+  return S_;
+}
+
+void HybridForceImpedance::start(const franka::RobotState &robot_state,
+                                 std::shared_ptr<RobotModel> model) {
+  motion_finished_ = false;
+  Eigen::Affine3d transform(Eigen::Matrix4d::Map(robot_state.O_T_EE.data()));
+  Eigen::Vector3d position(transform.translation());
+  Eigen::Quaterniond orientation(transform.rotation());
+  Vector7d q = Eigen::Map<const Vector7d>(robot_state.q.data());
+  position_d_ = position;
+  position_d_target_ = position;
+  position_anchor_ = position;
+  orientation_d_ = orientation;
+  orientation_d_target_ = orientation;
+  q_nullspace_d_ = q;
+  q_nullspace_d_target_ = q;
+  integral_.setZero();
+  model_ = model;
+
+  // Bias torque sensor
+  std::array<double, 7> gravity_array = model->gravity(robot_state);
+  tau_ext_init_ = Eigen::Map<const Vector7d>(robot_state.tau_J.data()) -
+                  Eigen::Map<const Vector7d>(gravity_array.data());
+}
+
+void HybridForceImpedance::stop(const franka::RobotState &robot_state,
+                                std::shared_ptr<RobotModel> model) {
+  motion_finished_ = true;
+}
+
+bool HybridForceImpedance::isRunning() { return !motion_finished_; }
+
+const std::string HybridForceImpedance::name() {
+  return "Hybrid Force/Impedance";
+}
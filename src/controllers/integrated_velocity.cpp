@@ -56,13 +56,13 @@ void IntegratedVelocity::setDamping(const Vector7d &damping) {
   K_d_ = damping;
 }
 
-void IntegratedVelocity::start(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) {
+void IntegratedVelocity::start(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   q_d_ = Eigen::Map<const Vector7d>(robot_state.q.data());
   dq_d_.setZero();
 }
 
-void IntegratedVelocity::stop(const franka::RobotState &robot_state, std::shared_ptr<franka::Model> model) {
+void IntegratedVelocity::stop(const franka::RobotState &robot_state, std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
@@ -0,0 +1,277 @@
+#include "controllers/joint_mpc.h"
+
+#include <chrono>
+
+using namespace controllers;
+
+const double JointTrajectoryMPC::kDefaultBlockDuration = 0.01;
+const double JointTrajectoryMPC::kDefaultPositionWeight = 1.0;
+const double JointTrajectoryMPC::kDefaultVelocityWeight = 1e-3;
+const double JointTrajectoryMPC::kDefaultAccelerationWeight = 1e-8;
+const int JointTrajectoryMPC::kDefaultMaxIterations = 50;
+const double JointTrajectoryMPC::kDefaultTorqueMargin = 0.9;
+
+LinearJointMPC::LinearJointMPC(double block_duration, double position_weight,
+                               double velocity_weight,
+                               double acceleration_weight, int max_iterations,
+                               double torque_margin)
+    : block_duration_(block_duration),
+      position_weight_(position_weight),
+      velocity_weight_(velocity_weight),
+      acceleration_weight_(acceleration_weight),
+      torque_margin_(torque_margin) {
+  if (block_duration <= 0.0) {
+    throw std::invalid_argument("Block duration must be positive.");
+  }
+  // Constant acceleration a_j over block j of duration h moves the end of
+  // block k by h²(k - j + 1/2) a_j and changes its velocity by h a_j
+  const double h = block_duration_;
+  G_q_.setZero();
+  G_v_.setZero();
+  for (int k = 0; k < kBlocks; k++) {
+    for (int j = 0; j <= k; j++) {
+      G_q_(k, j) = h * h * (k - j + 0.5);
+      G_v_(k, j) = h;
+    }
+  }
+  S_ = position_weight_ * G_q_.transpose() * G_q_ +
+       velocity_weight_ * G_v_.transpose() * G_v_;
+  S_.diagonal().array() += acceleration_weight_;
+  // ADMM uses a single step size, the cost is scaled to order one
+  cost_scale_ = 1.0 / S_.diagonal().maxCoeff();
+  // Joints share the cost structure, P = S ⊗ I
+  P_.setZero();
+  for (int j = 0; j < kBlocks; j++) {
+    for (int k = 0; k < kBlocks; k++) {
+      P_.block<7, 7>(7 * j, 7 * k).diagonal().setConstant(cost_scale_ *
+                                                           S_(j, k));
+    }
+  }
+  // The first block's change is relative to the last command, so D has a
+  // one on the diagonal and minus one below it
+  Eigen::Matrix<double, kBlocks, kBlocks> D =
+      Eigen::Matrix<double, kBlocks, kBlocks>::Identity();
+  D.diagonal<-1>().setConstant(-1.0);
+  E_ = Eigen::Matrix<double, kBlocks, kBlocks>::Identity() + D.transpose() * D;
+  qp_.getSettings().max_iterations = max_iterations;
+  for (auto &bin : histogram_) bin = 0;
+}
+
+void LinearJointMPC::reset() { qp_.reset(); }
+
+Vector7d LinearJointMPC::compute(const Vector7d &q, const Vector7d &dq,
+                                 const Eigen::Matrix<double, 7, 7> &mass,
+                                 const Vector7d &coriolis,
+                                 const Vector7d &gravity,
+                                 const Vector7d &tau_previous,
+                                 const Preview &positions,
+                                 const Preview &velocities) {
+  const auto start = std::chrono::steady_clock::now();
+  const double h = block_duration_;
+
+  // Rows 7j.. bound the torques of block j, rows 7(kBlocks + j).. their
+  // change from the previous block. Each joint's rows are normalized.
+  const Vector7d row_scale =
+      mass.cwiseAbs().rowwise().maxCoeff().cwiseInverse();
+  constraints_.mass = row_scale.asDiagonal() * mass;
+  const Eigen::Matrix<double, 7, 7> gram =
+      constraints_.mass.transpose() * constraints_.mass;
+  for (int j = 0; j < kBlocks; j++) {
+    for (int k = 0; k < kBlocks; k++) {
+      AtA_.block<7, 7>(7 * j, 7 * k) = E_(j, k) * gram;
+    }
+  }
+  qp_.setup(P_, AtA_);
+
+  Eigen::Matrix<double, kVariables, 1> gradient;
+  Eigen::Matrix<double, kConstraints, 1> lower, upper;
+  const Vector7d tau_max = torque_margin_ * kTauJMax;
+  const Vector7d rate = kDTauJMax * kControlPeriod;
+  for (int j = 0; j < kBlocks; j++) {
+    Vector7d g = -acceleration_weight_ / h * (velocities[j + 1] - velocities[j]);
+    for (int k = j; k < kBlocks; k++) {
+      const Vector7d position_error =
+          q + (k + 1) * h * dq - positions[k + 1];
+      const Vector7d velocity_error = dq - velocities[k + 1];
+      g += position_weight_ * G_q_(k, j) * position_error +
+           velocity_weight_ * G_v_(k, j) * velocity_error;
+    }
+    gradient.segment<7>(7 * j) = cost_scale_ * g;
+
+    lower.segment<7>(7 * j) =
+        row_scale.cwiseProduct(-tau_max - gravity - coriolis);
+    upper.segment<7>(7 * j) =
+        row_scale.cwiseProduct(tau_max - gravity - coriolis);
+    if (j == 0) {
+      lower.segment<7>(kVariables) =
+          row_scale.cwiseProduct(tau_previous - coriolis - rate);
+      upper.segment<7>(kVariables) =
+          row_scale.cwiseProduct(tau_previous - coriolis + rate);
+    } else {
+      upper.segment<7>(kVariables + 7 * j) =
+          row_scale.cwiseProduct(kDTauJMax * h);
+      lower.segment<7>(kVariables + 7 * j) =
+          -upper.segment<7>(kVariables + 7 * j);
+    }
+  }
+  const int iterations = qp_.solve(constraints_, gradient, lower, upper);
+  // ADMM iterates are only approximately feasible, the applied torques
+  // respect the limits exactly
+  Vector7d tau = mass * qp_.getSolution().head<7>() + coriolis;
+  tau = tau.cwiseMax(tau_previous - rate).cwiseMin(tau_previous + rate);
+  tau = tau.cwiseMax(-tau_max - gravity).cwiseMin(tau_max - gravity);
+
+  _record(std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        start)
+              .count(),
+          iterations, qp_.isConverged());
+  return tau;
+}
+
+void LinearJointMPC::Constraints::apply(
+    const Eigen::Matrix<double, kVariables, 1> &x,
+    Eigen::Matrix<double, kConstraints, 1> &Ax) const {
+  for (int j = 0; j < kBlocks; j++) {
+    Ax.segment<7>(7 * j).noalias() = mass * x.segment<7>(7 * j);
+    Ax.segment<7>(kVariables + 7 * j) = Ax.segment<7>(7 * j);
+    if (j > 0) {
+      Ax.segment<7>(kVariables + 7 * j) -= Ax.segment<7>(7 * (j - 1));
+    }
+  }
+}
+
+void LinearJointMPC::Constraints::applyTranspose(
+    const Eigen::Matrix<double, kConstraints, 1> &y,
+    Eigen::Matrix<double, kVariables, 1> &Aty) const {
+  for (int j = 0; j < kBlocks; j++) {
+    Vector7d w = y.segment<7>(7 * j) + y.segment<7>(kVariables + 7 * j);
+    if (j + 1 < kBlocks) w -= y.segment<7>(kVariables + 7 * (j + 1));
+    Aty.segment<7>(7 * j).noalias() = mass.transpose() * w;
+  }
+}
+
+void LinearJointMPC::_record(double seconds, int iterations, bool converged) {
+  const size_t bin =
+      std::min(static_cast<size_t>(seconds / kHistogramBinWidth),
+               kHistogramBins);
+  histogram_[bin].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  iterations_.fetch_add(iterations, std::memory_order_relaxed);
+  if (!converged) not_converged_.fetch_add(1, std::memory_order_relaxed);
+  // Single writer, the control thread
+  total_time_.store(total_time_.load(std::memory_order_relaxed) + seconds,
+                    std::memory_order_relaxed);
+  if (seconds > max_time_.load(std::memory_order_relaxed)) {
+    max_time_.store(seconds, std::memory_order_relaxed);
+  }
+}
+
+LinearJointMPC::SolveStats LinearJointMPC::getSolveStats() const {
+  SolveStats stats;
+  stats.count = count_.load();
+  if (stats.count == 0) return stats;
+  stats.not_converged = not_converged_.load();
+  stats.mean = total_time_.load() / stats.count;
+  stats.max = max_time_.load();
+  stats.mean_iterations = static_cast<double>(iterations_.load()) / stats.count;
+  // Percentiles are reported as the upper edge of their bin
+  std::array<uint64_t, kHistogramBins + 1> histogram;
+  uint64_t total = 0;
+  for (size_t i = 0; i <= kHistogramBins; i++) {
+    histogram[i] = histogram_[i].load();
+    total += histogram[i];
+  }
+  auto percentile = [&](double p) {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kHistogramBins; i++) {
+      cumulative += histogram[i];
+      if (cumulative >= p * total) {
+        return std::min((i + 1) * kHistogramBinWidth, stats.max);
+      }
+    }
+    return stats.max;
+  };
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+
+void LinearJointMPC::resetSolveStats() {
+  for (auto &bin : histogram_) bin = 0;
+  count_ = 0;
+  not_converged_ = 0;
+  iterations_ = 0;
+  total_time_ = 0.0;
+  max_time_ = 0.0;
+}
+
+JointTrajectoryMPC::JointTrajectoryMPC(
+    std::shared_ptr<motion::JointTrajectory> trajectory,
+    const double block_duration, const double position_weight,
+    const double velocity_weight, const double acceleration_weight,
+    const int max_iterations, const double torque_margin,
+    const double dq_threshold)
+    : source_(trajectory),
+      mpc_(block_duration, position_weight, velocity_weight,
+           acceleration_weight, max_iterations, torque_margin),
+      dq_threshold_(dq_threshold) {}
+
+void JointTrajectoryMPC::start(const franka::RobotState &robot_state,
+                               std::shared_ptr<RobotModel> model) {
+  motion_finished_ = false;
+  model_ = model;
+  source_.start();
+  mpc_.reset();
+}
+
+franka::Torques JointTrajectoryMPC::step(const franka::RobotState &robot_state,
+                                         franka::Duration &duration) {
+  const double time = getTime();
+  for (int k = 0; k <= LinearJointMPC::kBlocks; k++) {
+    source_.evaluate(time + k * mpc_.getBlockDuration(), reference_);
+    positions_[k] = reference_.position;
+    velocities_[k] = reference_.velocity;
+  }
+  std::array<double, 49> mass_array = model_->mass(robot_state);
+  std::array<double, 7> coriolis_array = model_->coriolis(robot_state);
+  std::array<double, 7> gravity_array = model_->gravity(robot_state);
+  Vector7d tau_d = mpc_.compute(
+      Eigen::Map<const Vector7d>(robot_state.q.data()),
+      Eigen::Map<const Vector7d>(robot_state.dq.data()),
+      Eigen::Map<const Eigen::Matrix<double, 7, 7>>(mass_array.data()),
+      Eigen::Map<const Vector7d>(coriolis_array.data()),
+      Eigen::Map<const Vector7d>(gravity_array.data()),
+      Eigen::Map<const Vector7d>(robot_state.tau_J_d.data()), positions_,
+      velocities_);
+
+  franka::Torques torques = VectorToArray(tau_d);
+  torques.motion_finished = motion_finished_;
+  if (time > source_.getDuration()) {
+    bool at_rest = true;
+    for (auto dq : robot_state.dq) {
+      if (std::abs(dq) > dq_threshold_) {
+        at_rest = false;
+      }
+    }
+    if (at_rest) {
+      torques.motion_finished = true;
+    }
+  }
+  return torques;
+}
+
+void JointTrajectoryMPC::stop(const franka::RobotState &robot_state,
+                              std::shared_ptr<RobotModel> model) {
+  motion_finished_ = true;
+}
+
+bool JointTrajectoryMPC::isRunning() { return !motion_finished_; }
+
+const std::string JointTrajectoryMPC::name() { return "JointTrajectoryMPC"; }
+
+LinearJointMPC::SolveStats JointTrajectoryMPC::getSolveStats() const {
+  return mpc_.getSolveStats();
+}
+
+void JointTrajectoryMPC::resetSolveStats() { mpc_.resetSolveStats(); }
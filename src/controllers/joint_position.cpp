@@ -22,6 +22,7 @@ JointPosition::JointPosition(const Vector7d &stiffness, const Vector7d &damping,
   K_d_ = damping;
   K_d_target_ = damping;
   filter_coeff_ = filter_coeff;
+  setpoint_buffer_ = std::make_shared<SetpointBuffer>(14);
 };
 
 franka::Torques JointPosition::step(const franka::RobotState &robot_state,
@@ -32,6 +33,9 @@ franka::Torques JointPosition::step(const franka::RobotState &robot_state,
   dq = Eigen::Map<const Vector7d>(robot_state.dq.data());
   // These quantities may be modified outside of the control loop
   mux_.lock();
+  if (setpoint_buffer_->read(setpoint_.data(), setpoint_version_)) {
+    _setSetpoint(setpoint_.data(), setpoint_.size());
+  }
   _updateFilter();
   K_p = K_p_;
   K_d = K_d_;
@@ -74,17 +78,45 @@ void JointPosition::setFilter(const double filter_coeff) {
   filter_coeff_ = filter_coeff;
 }
 
+void JointPosition::applySetpoint(const double *setpoint, size_t size) {
+  std::lock_guard<std::mutex> lock(mux_);
+  _setSetpoint(setpoint, size);
+}
+
+void JointPosition::_setSetpoint(const double *setpoint, size_t size) {
+  // Joint positions, optionally followed by joint velocities
+  q_d_target_ = Eigen::Map<const Vector7d>(setpoint);
+  if (size >= 14) {
+    dq_d_target_ = Eigen::Map<const Vector7d>(setpoint + 7);
+  } else {
+    dq_d_target_.setZero();
+  }
+}
+
+bool JointPosition::acceptsSetpoint(size_t size) {
+  return size == 7 || size == 14;
+}
+
+std::shared_ptr<SetpointBuffer> JointPosition::getSetpointBuffer() {
+  return setpoint_buffer_;
+}
+
 void JointPosition::start(const franka::RobotState &robot_state,
-                          std::shared_ptr<franka::Model> model) {
+                          std::shared_ptr<RobotModel> model) {
   motion_finished_ = false;
   q_d_ = Eigen::Map<const Vector7d>(robot_state.q.data());
   q_d_target_ = Eigen::Map<const Vector7d>(robot_state.q.data());
   dq_d_.setZero();
   dq_d_target_.setZero();
+  // Start the shared setpoint from the current configuration
+  Eigen::Matrix<double, 14, 1> setpoint;
+  setpoint << q_d_target_, Vector7d::Zero();
+  setpoint_buffer_->reset(setpoint.data());
+  setpoint_buffer_->read(setpoint_.data(), setpoint_version_);
 }
 
 void JointPosition::stop(const franka::RobotState &robot_state,
-                         std::shared_ptr<franka::Model> model) {
+                         std::shared_ptr<RobotModel> model) {
   motion_finished_ = true;
 }
 
@@ -8,16 +8,26 @@ JointTrajectory::JointTrajectory(std::shared_ptr<motion::JointTrajectory> trajec
                        const Vector7d &stiffness, const Vector7d &damping,
                        const double dq_threshold, const double filter_coeff)
     : JointPosition(stiffness, damping, filter_coeff),
-      traj_(trajectory),
+      source_(trajectory),
       dq_threshold_(dq_threshold) {}
 
 franka::Torques JointTrajectory::step(const franka::RobotState &robot_state,
                                  franka::Duration &duration) {
-  auto q_d = traj_->getJointPositions(getTime());
-  auto dq_d = traj_->getJointVelocities(getTime());
-  setControl(q_d, dq_d);
+  double time = getTime();
+  double rate = 1.0;
+  if (TimeScaling *time_scaling = active_time_scaling_.get()) {
+    const double error =
+        (reference_.position - Eigen::Map<const Vector7d>(robot_state.q.data()))
+            .cwiseAbs()
+            .maxCoeff();
+    time = time_scaling->update(time, error,
+                                TimeScaling::externalTorque(robot_state));
+    rate = time_scaling->getRate();
+  }
+  source_.evaluate(time, reference_);
+  setControl(reference_.position, rate * reference_.velocity);
   auto torques = JointPosition::step(robot_state, duration);
-  if (getTime() > traj_->getDuration()) {
+  if (time > source_.getDuration()) {
     bool at_rest = true;
     for (auto dq : robot_state.dq) {
       if (std::abs(dq) > dq_threshold_) {
@@ -31,6 +41,44 @@ franka::Torques JointTrajectory::step(const franka::RobotState &robot_state,
   return torques;
 }
 
+void JointTrajectory::start(const franka::RobotState &robot_state,
+                            std::shared_ptr<RobotModel> model) {
+  JointPosition::start(robot_state, model);
+  started_ = true;
+  source_.start();
+  source_.evaluate(0.0, reference_);
+  // The control thread uses the clock attached at start, released here on
+  // the next start instead of on the control thread
+  active_time_scaling_ = std::atomic_load(&time_scaling_);
+  if (active_time_scaling_) {
+    active_time_scaling_->start();
+  }
+}
+
+void JointTrajectory::setTimeScaling(
+    std::shared_ptr<TimeScaling> time_scaling) {
+  std::atomic_store(&time_scaling_, time_scaling);
+}
+
+std::shared_ptr<TimeScaling> JointTrajectory::getTimeScaling() {
+  return std::atomic_load(&time_scaling_);
+}
+
+double JointTrajectory::queue(
+    std::shared_ptr<motion::JointTrajectory> trajectory) {
+  // Before the controller runs, the whole schedule is still ahead, once it
+  // finished the whole schedule was executed
+  double time = started_ ? std::numeric_limits<double>::infinity()
+                         : -std::numeric_limits<double>::infinity();
+  if (isRunning()) {
+    time = getTime();
+    if (active_time_scaling_) {
+      time = active_time_scaling_->getTrajectoryTime();
+    }
+  }
+  return source_.queue(trajectory, time);
+}
+
 const std::string JointTrajectory::name() {
   return "JointTrajectory";
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "controllers/time_scaling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace controllers;
+
+const double TimeScaling::kDefaultErrorThreshold = 0.02;
+const double TimeScaling::kDefaultErrorLimit = 0.1;
+const double TimeScaling::kDefaultTorqueThreshold = 5.0;
+const double TimeScaling::kDefaultTorqueLimit = 15.0;
+const double TimeScaling::kDefaultMinRate = 0.1;
+const double TimeScaling::kDefaultSlowdown = 10.0;
+const double TimeScaling::kDefaultRecovery = 2.0;
+const size_t TimeScaling::kDefaultLogSize = 60000;
+
+TimeScaling::TimeScaling(double error_threshold, double error_limit,
+                         double torque_threshold, double torque_limit,
+                         double min_rate, double slowdown, double recovery,
+                         size_t log_size)
+    : error_threshold_(error_threshold),
+      error_limit_(error_limit),
+      torque_threshold_(torque_threshold),
+      torque_limit_(torque_limit),
+      min_rate_(min_rate),
+      slowdown_(slowdown),
+      recovery_(recovery),
+      log_(log_size) {
+  if (error_limit <= error_threshold || torque_limit <= torque_threshold) {
+    throw std::invalid_argument("Limits must be larger than thresholds.");
+  }
+  if (min_rate < 0.0 || min_rate > 1.0) {
+    throw std::invalid_argument("Minimum rate must be within [0, 1].");
+  }
+  if (slowdown <= 0.0 || recovery <= 0.0) {
+    throw std::invalid_argument("Rate slew limits must be positive.");
+  }
+}
+
+void TimeScaling::start() {
+  last_time_ = 0.0;
+  rate_ = 1.0;
+  rate_derivative_ = 0.0;
+  trajectory_time_ = 0.0;
+  log_start_.store(log_head_.load(std::memory_order_relaxed),
+                   std::memory_order_release);
+}
+
+double TimeScaling::_target(double value, double threshold,
+                            double limit) const {
+  if (value <= threshold) return 1.0;
+  if (value >= limit) return min_rate_;
+  // Smoothstep between threshold and limit
+  const double u = (value - threshold) / (limit - threshold);
+  return 1.0 - (1.0 - min_rate_) * u * u * (3.0 - 2.0 * u);
+}
+
+double TimeScaling::update(double time, double tracking_error,
+                           double external_torque) {
+  const double dt = std::max(time - last_time_, 0.0);
+  last_time_ = time;
+  const double target =
+      std::min(_target(tracking_error, error_threshold_, error_limit_),
+               _target(external_torque, torque_threshold_, torque_limit_));
+  const double rate = rate_;
+  const double change =
+      std::max(-slowdown_ * dt, std::min(target - rate, recovery_ * dt));
+  rate_ = rate + change;
+  rate_derivative_ = dt > 0.0 ? change / dt : 0.0;
+  // Trapezoidal integration of the rate
+  trajectory_time_ = trajectory_time_ + 0.5 * (rate + rate_) * dt;
+
+  if (!log_.empty()) {
+    // Announce the overwrite before touching the slot, see getLog()
+    const uint64_t head = log_head_.load(std::memory_order_relaxed);
+    log_claim_.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    log_[head % log_.size()] = {time, trajectory_time_, rate_, tracking_error,
+                                external_torque};
+    log_head_.store(head + 1, std::memory_order_release);
+  }
+  return trajectory_time_;
+}
+
+std::vector<TimeScaling::Sample> TimeScaling::getLog() const {
+  std::vector<Sample> samples;
+  const uint64_t size = log_.size();
+  if (size == 0) return samples;
+  const uint64_t head = log_head_.load(std::memory_order_acquire);
+  const uint64_t first = std::max(log_start_.load(std::memory_order_acquire),
+                                  head > size ? head - size : 0);
+  if (first >= head) return samples;
+  samples.reserve(head - first);
+  for (uint64_t i = first; i < head; i++) {
+    samples.push_back(log_[i % size]);
+  }
+  // Writing sample n overwrites sample n - size, drop the ones update() may
+  // have overwritten while copying
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t claim = log_claim_.load(std::memory_order_relaxed);
+  const uint64_t valid = claim > size ? claim - size : 0;
+  if (valid > first) {
+    samples.erase(samples.begin(),
+                  samples.begin() + std::min<uint64_t>(valid - first,
+                                                       samples.size()));
+  }
+  return samples;
+}
+
+double TimeScaling::externalTorque(const franka::RobotState &robot_state) {
+  double torque = 0.0;
+  for (double tau : robot_state.tau_ext_hat_filtered) {
+    torque = std::max(torque, std::abs(tau));
+  }
+  return torque;
+}
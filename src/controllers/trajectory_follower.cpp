@@ -0,0 +1,319 @@
+#include "controllers/trajectory_follower.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#include "kinematics/manipulability.h"
+
+using namespace controllers;
+
+double controllers::trackingError(const JointReference &reference,
+                                  const franka::RobotState &robot_state) {
+  return (reference.position -
+          Eigen::Map<const Vector7d>(robot_state.q.data()))
+      .cwiseAbs()
+      .maxCoeff();
+}
+
+double controllers::trackingError(const CartesianReference &reference,
+                                  const franka::RobotState &robot_state) {
+  return (reference.position -
+          Eigen::Vector3d(robot_state.O_T_EE[12], robot_state.O_T_EE[13],
+                          robot_state.O_T_EE[14]))
+      .norm();
+}
+
+const double JointTrajectorySource::kQueueTolerance = 1e-3;
+const double JointTrajectorySource::kQueueLatency = 0.05;
+
+JointTrajectorySource::JointTrajectorySource(
+    std::shared_ptr<motion::JointTrajectory> trajectory) {
+  auto segment = std::make_shared<Segment>();
+  segment->trajectory = trajectory;
+  segment->start = 0.0;
+  segment->duration = trajectory->getDuration();
+  segment->blend = 0.0;
+  segment->origin = trajectory->getJointPositions(0.0);
+  owner_ = std::make_unique<const Schedule>(Schedule{segment});
+  duration_ = segment->duration;
+  schedule_ = owner_.get();
+}
+
+JointTrajectorySource::JointTrajectorySource(
+    const JointTrajectorySource &other) {
+  std::lock_guard<std::mutex> lock(other.mux_);
+  owner_ = std::make_unique<const Schedule>(*other.owner_);
+  duration_ = other.duration_.load();
+  schedule_ = owner_.get();
+}
+
+void JointTrajectorySource::start() {
+  // Compile outside of the control loop
+  std::lock_guard<std::mutex> lock(mux_);
+  for (auto &segment : *owner_) {
+    segment->compiled = segment->trajectory->getCompiled().get();
+    segment->hint = 0;
+  }
+  current_ = nullptr;
+  first_ = 0;
+}
+
+double JointTrajectorySource::getDuration() { return duration_; }
+
+void JointTrajectorySource::evaluate(double time, Reference &reference) {
+  busy_.store(true);
+  const Schedule &segments = *schedule_.load();
+  if (&segments != current_) {
+    // Queued, possibly with executed segments dropped
+    current_ = &segments;
+    first_ = 0;
+  }
+  while (first_ + 1 < segments.size() &&
+         time > segments[first_]->start + segments[first_]->duration) {
+    first_++;
+  }
+  // Chained trajectories add up, finished ones only contribute their
+  // displacement which equals the origin of the first active one
+  Segment &base = *segments[first_];
+  base.hint = base.compiled->evaluate(
+      time - base.start, reference.position.data(),
+      reference.velocity.data(), reference.acceleration.data(), base.hint);
+  if (time < base.start || time > base.start + base.duration) {
+    reference.velocity.setZero();
+    reference.acceleration.setZero();
+  }
+  Vector7d position, velocity, acceleration;
+  for (size_t i = first_ + 1;
+       i < segments.size() && segments[i]->start < time; i++) {
+    Segment &segment = *segments[i];
+    segment.hint = segment.compiled->evaluate(
+        time - segment.start, position.data(), velocity.data(),
+        acceleration.data(), segment.hint);
+    reference.position += position - segment.origin;
+    if (time < segment.start + segment.duration) {
+      reference.velocity += velocity;
+      reference.acceleration += acceleration;
+    }
+  }
+  busy_.store(false, std::memory_order_release);
+}
+
+double JointTrajectorySource::queue(
+    std::shared_ptr<motion::JointTrajectory> trajectory, double time) {
+  auto segment = std::make_shared<Segment>();
+  segment->trajectory = trajectory;
+  segment->compiled = trajectory->getCompiled().get();
+  segment->duration = trajectory->getDuration();
+  segment->origin = trajectory->getJointPositions(0.0);
+  std::lock_guard<std::mutex> lock(mux_);
+  const Segment &previous = *owner_->back();
+  previous.trajectory->compile();
+  const Vector7d end =
+      previous.trajectory->getJointPositions(previous.duration);
+  if ((end - segment->origin).cwiseAbs().maxCoeff() > kQueueTolerance) {
+    throw std::invalid_argument(
+        "Queued trajectory doesn't start where the motion ends.");
+  }
+  // Executed segments only contribute the origin of the first remaining one
+  auto next = std::make_unique<Schedule>();
+  for (auto &executed : *owner_) {
+    if (executed->start + executed->duration >= time) {
+      next->push_back(executed);
+    }
+  }
+  if (next->empty()) {
+    // The motion came to rest at the end of the schedule
+    segment->blend = 0.0;
+    segment->start = std::isfinite(time) ? time + kQueueLatency : 0.0;
+  } else {
+    const double earliest = time + kQueueLatency;
+    segment->blend = _blendWindow(previous, *trajectory, earliest);
+    segment->start = std::max(
+        previous.start + previous.duration - segment->blend, earliest);
+  }
+  next->push_back(segment);
+  // Publish the duration first, so the control thread doesn't consider the
+  // new schedule finished
+  duration_ = segment->start + segment->duration;
+  std::unique_ptr<const Schedule> replaced = std::move(owner_);
+  owner_ = std::move(next);
+  schedule_.store(owner_.get());
+  // Sequentially consistent with the control thread's busy flag: once it
+  // reads false, the control thread is done with the replaced schedule
+  while (busy_.load()) {
+    std::this_thread::yield();
+  }
+  return segment->blend;
+}
+
+double JointTrajectorySource::_blendWindow(const Segment &previous,
+                                           motion::JointTrajectory &next,
+                                           double earliest) {
+  const double kSamplePeriod = 1e-3;
+  const double end = previous.start + previous.duration;
+  // Blends overlap at most two trajectories
+  const double max_window = std::min(
+      {end - std::max(earliest, previous.start + previous.blend),
+       previous.duration - previous.blend, next.getDuration()});
+  if (max_window < kSamplePeriod) return 0.0;
+
+  // Limits are the peaks of either trajectory, which reflect their speed
+  // factors. Blending trapezoidal profiles of equal acceleration reaches the
+  // peak exactly, hence the tolerance.
+  const double kTolerance = 0.01;
+  auto peaks = [&](motion::JointTrajectory &trajectory, Vector7d &velocity,
+                   Vector7d &acceleration) {
+    const size_t n =
+        static_cast<size_t>(trajectory.getDuration() / kSamplePeriod) + 2;
+    const Eigen::VectorXd times =
+        Eigen::VectorXd::LinSpaced(n, 0.0, trajectory.getDuration());
+    auto samples = trajectory.sample(times);
+    velocity = std::get<1>(samples).cwiseAbs().colwise().maxCoeff();
+    acceleration = std::get<2>(samples).cwiseAbs().colwise().maxCoeff();
+  };
+  Vector7d max_velocity, max_acceleration, velocity, acceleration;
+  peaks(*previous.trajectory, max_velocity, max_acceleration);
+  peaks(next, velocity, acceleration);
+  max_velocity = (max_velocity.cwiseMax(velocity) * (1.0 + kTolerance))
+                     .cwiseMin(kQMaxVelocity);
+  max_acceleration =
+      (max_acceleration.cwiseMax(acceleration) * (1.0 + kTolerance))
+          .cwiseMin(kQMaxAcceleration);
+
+  const size_t n = static_cast<size_t>(max_window / kSamplePeriod) + 1;
+  const Eigen::VectorXd window = Eigen::VectorXd::LinSpaced(n, 0.0, max_window);
+  const auto head = next.sample(window);
+  auto feasible = [&](double blend) {
+    const size_t samples = static_cast<size_t>(blend / kSamplePeriod) + 1;
+    const Eigen::VectorXd times =
+        window.head(samples).array() + (previous.duration - blend);
+    const auto tail = previous.trajectory->sample(times);
+    for (size_t i = 0; i < samples; i++) {
+      const Vector7d q = std::get<0>(tail).row(i).transpose() +
+                         std::get<0>(head).row(i).transpose() -
+                         std::get<0>(head).row(0).transpose();
+      const Vector7d dq = std::get<1>(tail).row(i).transpose() +
+                          std::get<1>(head).row(i).transpose();
+      const Vector7d ddq = std::get<2>(tail).row(i).transpose() +
+                           std::get<2>(head).row(i).transpose();
+      if ((dq.cwiseAbs().array() > max_velocity.array()).any() ||
+          (ddq.cwiseAbs().array() > max_acceleration.array()).any() ||
+          (q.array() < kLowerJointLimits.array()).any() ||
+          (q.array() > kUpperJointLimits.array()).any()) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Coarse scan from the longest window down, then bisect towards the next
+  // longer candidate
+  const int kCandidates = 32;
+  const double step = max_window / kCandidates;
+  for (int k = 0; k < kCandidates; k++) {
+    double lower = max_window - k * step;
+    if (!feasible(lower)) continue;
+    double upper = std::min(lower + step, max_window);
+    for (int i = 0; i < 8 && upper - lower > kSamplePeriod; i++) {
+      const double middle = 0.5 * (lower + upper);
+      (feasible(middle) ? lower : upper) = middle;
+    }
+    return lower;
+  }
+  return 0.0;
+}
+
+CartesianTrajectorySource::CartesianTrajectorySource(
+    std::shared_ptr<motion::CartesianTrajectory> trajectory)
+    : traj_(trajectory) {}
+
+void CartesianTrajectorySource::start() {
+  compiled_ = traj_->getCompiled().get();
+  hint_ = 0;
+}
+
+void CartesianTrajectorySource::evaluate(double time, Reference &reference) {
+  hint_ = traj_->evaluate(*compiled_, time, reference.position,
+                          reference.orientation, reference.velocity,
+                          reference.acceleration, hint_);
+}
+
+JointImpedanceLaw::JointImpedanceLaw(const Vector7d &stiffness,
+                                     const Vector7d &damping, bool feedforward)
+    : K_p_(stiffness), K_d_(damping), feedforward_(feedforward) {}
+
+void JointImpedanceLaw::start(const franka::RobotState &robot_state,
+                              std::shared_ptr<RobotModel> model) {
+  model_ = model;
+}
+
+Vector7d JointImpedanceLaw::compute(const Reference &reference,
+                                    const franka::RobotState &robot_state) {
+  Vector7d q = Eigen::Map<const Vector7d>(robot_state.q.data());
+  Vector7d dq = Eigen::Map<const Vector7d>(robot_state.dq.data());
+  Vector7d tau_d = K_p_.asDiagonal() * (reference.position - q) +
+                   K_d_.asDiagonal() * (reference.velocity - dq);
+  if (feedforward_) {
+    std::array<double, 49> mass_array = model_->mass(robot_state);
+    std::array<double, 7> coriolis_array = model_->coriolis(robot_state);
+    tau_d += Eigen::Map<const Eigen::Matrix<double, 7, 7>>(mass_array.data()) *
+                 reference.acceleration +
+             Eigen::Map<const Vector7d>(coriolis_array.data());
+  }
+  return tau_d;
+}
+
+CartesianImpedanceLaw::CartesianImpedanceLaw(
+    const Eigen::Matrix<double, 6, 6> &impedance, double damping_ratio,
+    double nullspace_stiffness, const Vector7d &q_nullspace)
+    : K_p_(impedance),
+      K_d_(damping_ratio * 2 * impedance.cwiseSqrt()),
+      nullspace_stiffness_(nullspace_stiffness),
+      q_nullspace_(q_nullspace) {}
+
+void CartesianImpedanceLaw::start(const franka::RobotState &robot_state,
+                                  std::shared_ptr<RobotModel> model) {
+  model_ = model;
+}
+
+Vector7d CartesianImpedanceLaw::compute(const Reference &reference,
+                                        const franka::RobotState &robot_state) {
+  std::array<double, 7> coriolis_array = model_->coriolis(robot_state);
+  std::array<double, 42> jacobian_array =
+      model_->zeroJacobian(franka::Frame::kEndEffector, robot_state);
+  Eigen::Map<const Vector7d> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+  Vector7d q = Eigen::Map<const Vector7d>(robot_state.q.data());
+  Vector7d dq = Eigen::Map<const Vector7d>(robot_state.dq.data());
+  Eigen::Affine3d transform(Eigen::Matrix4d::Map(robot_state.O_T_EE.data()));
+  Eigen::Vector3d position(transform.translation());
+  Eigen::Quaterniond orientation(transform.rotation());
+
+  // Pose error, same convention as CartesianImpedance
+  Vector6d error;
+  error.head(3) << position - reference.position;
+  if (reference.orientation.coeffs().dot(orientation.coeffs()) < 0.0) {
+    orientation.coeffs() << -orientation.coeffs();
+  }
+  Eigen::Quaterniond error_quaternion(orientation.inverse() *
+                                      reference.orientation);
+  error.tail(3) << error_quaternion.x(), error_quaternion.y(),
+      error_quaternion.z();
+  error.tail(3) << -transform.rotation() * error.tail(3);
+
+  // Task space PD with the reference twist as damping target
+  Vector7d tau_task = jacobian.transpose() *
+                      (-K_p_ * error - K_d_ * (jacobian * dq - reference.velocity));
+
+  // Nullspace projector, exact away from singularities and damped close to
+  // them, fixed size so nothing is allocated on the control thread
+  Eigen::Matrix<double, 7, 6> jacobian_pinv;
+  kinematics::dampedPseudoInverse(jacobian, jacobian_pinv);
+  Vector7d tau_nullspace = (Eigen::Matrix<double, 7, 7>::Identity() -
+                            jacobian_pinv * jacobian) *
+                           (nullspace_stiffness_ * (q_nullspace_ - q) -
+                            (2.0 * sqrt(nullspace_stiffness_)) * dq);
+  return tau_task + tau_nullspace + coriolis;
+}
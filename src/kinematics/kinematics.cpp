@@ -0,0 +1,310 @@
+#include "kinematics/kinematics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "kinematics/fk.h"
+#include "trace.h"
+
+using namespace kinematics;
+
+namespace {
+Eigen::Matrix4d _hand(double offset) {
+  Eigen::Affine3d transform(
+      Eigen::AngleAxisd(-M_PI_4, Eigen::Vector3d::UnitZ()));
+  transform.translation() << 0.0, 0.0, offset;
+  return transform.matrix();
+}
+
+Eigen::Matrix4d _inverse(const Eigen::Matrix4d &transform) {
+  return Eigen::Affine3d(transform).inverse(Eigen::Isometry).matrix();
+}
+
+// fk() was derived for a hand offset of 0.103 m, ik() for libfranka's 0.1034
+const Eigen::Matrix4d kFkHand = _hand(0.103);
+
+template <typename Function>
+void _forEach(size_t n, size_t chunk_size, ThreadPool::Priority priority,
+              const Function &f) {
+  const size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+  ThreadPool::instance().parallelFor(
+      num_chunks,
+      [&](size_t chunk) {
+        const size_t end = std::min(n, (chunk + 1) * chunk_size);
+        for (size_t i = chunk * chunk_size; i < end; i++) {
+          f(i);
+        }
+      },
+      priority);
+}
+
+// Normalized squared distance from the center of the joint ranges
+double _limitCost(const Vector7d &q) {
+  const Vector7d center = 0.5 * (kUpperJointLimits + kLowerJointLimits);
+  const Vector7d half_range = 0.5 * (kUpperJointLimits - kLowerJointLimits);
+  return (q - center).cwiseQuotient(half_range).squaredNorm();
+}
+}  // namespace
+
+const Eigen::Matrix4d Kinematics::kFrankaHand = _hand(0.1034);
+
+Kinematics::Kinematics(const Eigen::Matrix4d &F_T_EE) : F_T_EE_(F_T_EE) {
+  const Eigen::Matrix3d rotation = F_T_EE.topLeftCorner<3, 3>();
+  if (!F_T_EE.bottomRows<1>().isApprox(Eigen::RowVector4d(0, 0, 0, 1)) ||
+      !(rotation.transpose() * rotation).isIdentity(1e-6) ||
+      rotation.determinant() < 0.0) {
+    throw std::invalid_argument(
+        "Tool transform must be a homogeneous transformation.");
+  }
+  fk_T_EE_ = _inverse(kFkHand) * F_T_EE_;
+  EE_T_ik_ = _inverse(F_T_EE_) * kFrankaHand;
+}
+
+Eigen::Matrix4d Kinematics::fk(const Vector7d &q) const {
+  return kinematics::fk(q) * fk_T_EE_;
+}
+
+Vector7d Kinematics::ik(const Eigen::Matrix4d &O_T_EE, const Vector7d &q_init,
+                        double q7) const {
+  return kinematics::ik(O_T_EE * EE_T_ik_, q_init, q7);
+}
+
+Eigen::Matrix<double, 4, 7> Kinematics::ikFull(const Eigen::Matrix4d &O_T_EE,
+                                               const Vector7d &q_init,
+                                               double q7) const {
+  return kinematics::ik_full(O_T_EE * EE_T_ik_, q_init, q7);
+}
+
+void Kinematics::fk(const double *q, size_t n, double *poses,
+                    ThreadPool::Priority priority) const {
+  TraceScope scope("kinematics", "fk_batch");
+  typedef Eigen::Matrix<double, 4, 4, Eigen::RowMajor> RowMatrix4d;
+  _forEach(n, kChunkSize, priority, [&](size_t i) {
+    Eigen::Map<RowMatrix4d>(poses + 16 * i) =
+        fk(Eigen::Map<const Vector7d>(q + 7 * i));
+  });
+}
+
+void Kinematics::ik(const double *poses, size_t n, const double *q_init,
+                    bool per_pose_init, const double *q7, bool per_pose_q7,
+                    double *q, ThreadPool::Priority priority) const {
+  TraceScope scope("kinematics", "ik_batch");
+  typedef Eigen::Matrix<double, 4, 4, Eigen::RowMajor> RowMatrix4d;
+  _forEach(n, kChunkSize, priority, [&](size_t i) {
+    Eigen::Map<Vector7d>(q + 7 * i) =
+        ik(Eigen::Map<const RowMatrix4d>(poses + 16 * i),
+           Eigen::Map<const Vector7d>(q_init + (per_pose_init ? 7 * i : 0)),
+           q7[per_pose_q7 ? i : 0]);
+  });
+}
+
+void Kinematics::ikPath(const double *poses, size_t n, const Vector7d &q_init,
+                        const PathIkSettings &settings, double *q,
+                        ThreadPool::Priority priority) const {
+  if (settings.q7_resolution <= 0.0 || settings.max_q7_step < 0.0 ||
+      settings.max_joint_step <= 0.0 || settings.limit_weight < 0.0) {
+    throw std::invalid_argument(
+        "Resolution and joint step must be positive, q7 step and limit "
+        "weight non-negative.");
+  }
+  const Vector7d lower = kLowerJointLimits.array() + settings.limit_margin;
+  const Vector7d upper = kUpperJointLimits.array() - settings.limit_margin;
+  if (settings.limit_margin < 0.0 || (lower.array() >= upper.array()).any()) {
+    throw std::invalid_argument(
+        "Limit margin must be non-negative and smaller than the joint ranges.");
+  }
+  if (n == 0) return;
+  TraceScope scope("kinematics", "ik_path");
+  typedef Eigen::Matrix<double, 4, 4, Eigen::RowMajor> RowMatrix4d;
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+  // q7 grid centered in the range of joint 7
+  const double q7_range = upper[6] - lower[6];
+  const size_t m =
+      static_cast<size_t>(std::floor(q7_range / settings.q7_resolution)) + 1;
+  const double q7_first =
+      lower[6] + 0.5 * (q7_range - (m - 1) * settings.q7_resolution);
+  const size_t window = static_cast<size_t>(
+      std::floor(settings.max_q7_step / settings.q7_resolution + 1e-9));
+  // Costs are scaled such that the total approximates the integral over
+  // s in [0, 1] of limit_weight * _limitCost(q) + |dq/ds|^2
+  const double scale = static_cast<double>(n);
+
+  // Limit cost of the solution at pose i and q7, infinite without one
+  auto solve = [&](size_t i, double q7, Vector7d &q_i) {
+    q_i = ik(Eigen::Map<const RowMatrix4d>(poses + 16 * i), q_init, q7);
+    if (!q_i.allFinite() || (q_i.array() < lower.array()).any() ||
+        (q_i.array() > upper.array()).any()) {
+      return kInfinity;
+    }
+    return settings.limit_weight * _limitCost(q_i) / scale;
+  };
+  auto step = [&](const Vector7d &from, const Vector7d &to) {
+    const Vector7d delta = to - from;
+    if (delta.cwiseAbs().maxCoeff() > settings.max_joint_step) {
+      return kInfinity;
+    }
+    return scale * delta.squaredNorm();
+  };
+
+  // Solutions on the grid, the bulk of the work
+  std::vector<Vector7d> states(n * m);
+  std::vector<double> cost(n * m);
+  _forEach(n, std::max<size_t>(1, kChunkSize / m), priority, [&](size_t i) {
+    for (size_t j = 0; j < m; j++) {
+      cost[i * m + j] =
+          solve(i, q7_first + j * settings.q7_resolution, states[i * m + j]);
+    }
+  });
+
+  // Dynamic programming, cost becomes the cost to come
+  std::vector<size_t> parent(n * m, 0);
+  auto unreachable = [&](size_t i) {
+    return std::none_of(cost.begin() + i * m, cost.begin() + (i + 1) * m,
+                        [](double c) { return std::isfinite(c); });
+  };
+  for (size_t j = 0; j < m; j++) {
+    cost[j] += (states[j] - q_init).squaredNorm();
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (i > 0) {
+      for (size_t j = 0; j < m; j++) {
+        double &c = cost[i * m + j];
+        if (!std::isfinite(c)) continue;
+        double best = kInfinity;
+        const size_t begin = j > window ? j - window : 0;
+        const size_t end = std::min(m, j + window + 1);
+        for (size_t k = begin; k < end; k++) {
+          const double previous = cost[(i - 1) * m + k];
+          if (!std::isfinite(previous)) continue;
+          const double total =
+              previous + step(states[(i - 1) * m + k], states[i * m + j]);
+          if (total < best) {
+            best = total;
+            parent[i * m + j] = k;
+          }
+        }
+        c += best;
+      }
+    }
+    if (unreachable(i)) {
+      throw std::runtime_error(
+          "No joint path within the limits reaches pose " + std::to_string(i) +
+          ".");
+    }
+  }
+  std::vector<double> profile(n);
+  std::vector<Vector7d> path(n);
+  size_t j = std::min_element(cost.end() - m, cost.end()) - (cost.end() - m);
+  for (size_t i = n; i-- > 0;) {
+    profile[i] = q7_first + j * settings.q7_resolution;
+    path[i] = states[i * m + j];
+    j = parent[i * m + j];
+  }
+
+  // Gauss-Newton refinement of the profile between the grid values. With
+  // the solutions linearized in q7, q_i + g_i d_i, all costs are quadratic
+  // in the changes d_i and only couple neighbors, so the normal equations
+  // are tridiagonal.
+  const Vector7d center = 0.5 * (kUpperJointLimits + kLowerJointLimits);
+  const Vector7d inverse_half_range =
+      (0.5 * (kUpperJointLimits - kLowerJointLimits)).cwiseInverse();
+  const double limit_scale = settings.limit_weight / scale;
+  auto total = [&](const std::vector<Vector7d> &p) {
+    double c = (p[0] - q_init).squaredNorm();
+    for (size_t i = 0; i < n; i++) {
+      c += limit_scale * _limitCost(p[i]);
+      if (i > 0) c += step(p[i - 1], p[i]);
+    }
+    return c;
+  };
+  constexpr double kEpsilon = 1e-6;
+  std::vector<Vector7d> gradient(n), candidate_path(n);
+  std::vector<double> diagonal(n), lower_diagonal(n), rhs(n), delta(n),
+      candidate(n);
+  std::vector<char> valid(n);
+  double current = total(path);
+  for (size_t iteration = 0; iteration < settings.refinement_iterations;
+       iteration++) {
+    _forEach(n, kChunkSize, priority, [&](size_t i) {
+      Vector7d q_i;
+      if (std::isfinite(solve(i, profile[i] + kEpsilon, q_i))) {
+        gradient[i] = (q_i - path[i]) / kEpsilon;
+      } else if (std::isfinite(solve(i, profile[i] - kEpsilon, q_i))) {
+        gradient[i] = (path[i] - q_i) / kEpsilon;
+      } else {
+        gradient[i].setZero();
+      }
+    });
+    for (size_t i = 0; i < n; i++) {
+      const Vector7d &g = gradient[i];
+      const Vector7d limit_g = g.cwiseProduct(inverse_half_range);
+      // Step into pose i, the distance from q_init for the first
+      const double weight = i > 0 ? scale : 1.0;
+      const Vector7d into = i > 0 ? Vector7d(path[i] - path[i - 1])
+                                  : Vector7d(path[0] - q_init);
+      diagonal[i] = limit_scale * limit_g.squaredNorm() +
+                    weight * g.squaredNorm() +
+                    (i + 1 < n ? scale * g.squaredNorm() : 0.0);
+      rhs[i] = -limit_scale *
+                   limit_g.dot((path[i] - center).cwiseProduct(
+                       inverse_half_range)) -
+               weight * g.dot(into);
+      if (i > 0) {
+        lower_diagonal[i] = -scale * g.dot(gradient[i - 1]);
+        rhs[i - 1] += scale * gradient[i - 1].dot(into);
+      }
+      // Levenberg-Marquardt damping, keeps frozen poses in place
+      diagonal[i] = diagonal[i] * (1.0 + 1e-3) + 1e-12;
+    }
+    // Thomas algorithm
+    for (size_t i = 1; i < n; i++) {
+      const double factor = lower_diagonal[i] / diagonal[i - 1];
+      diagonal[i] -= factor * lower_diagonal[i];
+      rhs[i] -= factor * rhs[i - 1];
+    }
+    delta[n - 1] = rhs[n - 1] / diagonal[n - 1];
+    for (size_t i = n - 1; i-- > 0;) {
+      delta[i] = (rhs[i] - lower_diagonal[i + 1] * delta[i + 1]) / diagonal[i];
+    }
+    double largest = 0.0;
+    for (size_t i = 0; i < n; i++) {
+      delta[i] = std::clamp(delta[i], -settings.q7_resolution,
+                            settings.q7_resolution);
+      largest = std::max(largest, std::abs(delta[i]));
+    }
+    if (largest < 1e-9) break;
+
+    // Backtracking until the profile improves and stays feasible
+    bool accepted = false;
+    for (double alpha = 1.0; alpha > 1e-3 && !accepted; alpha *= 0.5) {
+      _forEach(n, kChunkSize, priority, [&](size_t i) {
+        candidate[i] = profile[i] + alpha * delta[i];
+        valid[i] = std::isfinite(solve(i, candidate[i], candidate_path[i]));
+      });
+      bool feasible =
+          std::all_of(valid.begin(), valid.end(), [](char v) { return v; });
+      for (size_t i = 1; feasible && i < n; i++) {
+        feasible = std::abs(candidate[i] - candidate[i - 1]) <=
+                       settings.max_q7_step + 1e-9 &&
+                   std::isfinite(step(candidate_path[i - 1], candidate_path[i]));
+      }
+      if (!feasible) continue;
+      const double candidate_cost = total(candidate_path);
+      if (candidate_cost < current) {
+        current = candidate_cost;
+        profile.swap(candidate);
+        path.swap(candidate_path);
+        accepted = true;
+      }
+    }
+    if (!accepted) break;
+  }
+  for (size_t i = 0; i < n; i++) {
+    Eigen::Map<Vector7d>(q + 7 * i) = path[i];
+  }
+}
@@ -0,0 +1,76 @@
+#include "model_cache.h"
+
+#include <stdexcept>
+
+ModelCache &ModelCache::instance() {
+  static ModelCache cache;
+  return cache;
+}
+
+ModelCache::Loader ModelCache::defaultLoader() {
+  return [](franka::Robot &robot) {
+    return std::make_shared<franka::Model>(robot.loadModel());
+  };
+}
+
+ModelCache::ModelCache() : loader_(defaultLoader()) {}
+
+std::shared_ptr<franka::Model> ModelCache::get(franka::Robot &robot,
+                                               const Key &key,
+                                               Source *source) {
+  std::lock_guard<std::mutex> load_lock(load_mux_);
+  Loader loader;
+  {
+    std::lock_guard<std::mutex> lock(mux_);
+    if (enabled_) {
+      auto it = models_.find(key);
+      if (it != models_.end()) {
+        stats_.memory_hits++;
+        if (source) *source = Source::kMemory;
+        return it->second;
+      }
+    }
+    loader = loader_;
+  }
+
+  auto model = loader(robot);
+  if (!model) {
+    throw std::runtime_error("Model loader returned no model.");
+  }
+
+  std::lock_guard<std::mutex> lock(mux_);
+  stats_.loads++;
+  if (enabled_) {
+    models_[key] = model;
+  }
+  if (source) *source = Source::kRobot;
+  return model;
+}
+
+void ModelCache::setLoader(const Loader &loader) {
+  std::lock_guard<std::mutex> lock(mux_);
+  loader_ = loader ? loader : defaultLoader();
+}
+
+void ModelCache::setEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mux_);
+  enabled_ = enabled;
+  if (!enabled_) {
+    models_.clear();
+  }
+}
+
+bool ModelCache::isEnabled() const {
+  std::lock_guard<std::mutex> lock(mux_);
+  return enabled_;
+}
+
+void ModelCache::clear() {
+  std::lock_guard<std::mutex> lock(mux_);
+  models_.clear();
+}
+
+ModelCache::Stats ModelCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mux_);
+  return stats_;
+}
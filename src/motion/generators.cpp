@@ -1,10 +1,12 @@
 #include "motion/generators.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <numeric>
 
 #include "constants.h"
+#include "trace.h"
 
 using namespace std;
 using namespace Eigen;
@@ -13,6 +15,7 @@ using namespace motion;
 bool PandaTrajectory::_computeTrajectory(
     const time_optimal::Path &path, const Eigen::VectorXd &max_velocity,
     const Eigen::VectorXd &max_acceleration, double timeout) {
+  TraceScope scope("planning", "compute_trajectory");
   auto startTime = std::chrono::high_resolution_clock::now();
   bool success = false;
   int i = 0;
@@ -38,10 +41,22 @@ bool PandaTrajectory::_computeTrajectory(
   return success;
 }
 
+void PandaTrajectory::compile() {
+  if (isCompiled()) return;
+  TraceScope scope("planning", "compile_trajectory");
+  std::lock_guard<std::mutex> lock(compile_mux_);
+  if (!compiled_) {
+    std::atomic_store(
+        &compiled_,
+        std::shared_ptr<const time_optimal::PiecewisePolynomial>(
+            std::make_shared<time_optimal::PiecewisePolynomial>(*traj_)));
+  }
+}
+
 JointTrajectory::JointTrajectory(const std::vector<Vector7d> &waypoints,
                                  double speed_factor, double maxDeviation,
                                  double timeout) {
-  py::gil_scoped_acquire acquire;
+  TracedGilAcquire acquire("logger");
   py::object logging = py::module_::import("logging");
   logger_ = logging.attr("getLogger")("motion");
   py::gil_scoped_release release;
@@ -84,6 +99,21 @@ Vector7d JointTrajectory::getJointAccelerations(double time) {
   return traj_->getAcceleration(time);
 }
 
+std::tuple<MatrixX7d, MatrixX7d, MatrixX7d> JointTrajectory::sample(
+    const Eigen::VectorXd &times) {
+  MatrixX7d q(times.size(), 7), dq(times.size(), 7), ddq(times.size(), 7);
+  getCompiled()->sample(times.data(), times.size(), q.data(), dq.data(),
+                        ddq.data());
+  return std::make_tuple(q, dq, ddq);
+}
+
+size_t JointTrajectory::evaluate(double time, Vector7d &position,
+                                 Vector7d &velocity, Vector7d &acceleration,
+                                 size_t hint) {
+  return getCompiled()->evaluate(time, position.data(), velocity.data(),
+                                 acceleration.data(), hint);
+}
+
 CartesianTrajectory::CartesianTrajectory(
     const std::vector<Eigen::Matrix<double, 4, 4>> &poses, double speed_factor,
     double maxDeviation, double timeout) {
@@ -101,7 +131,7 @@ CartesianTrajectory::CartesianTrajectory(
     const std::vector<Eigen::Matrix<double, 3, 1>> &positions,
     const std::vector<Eigen::Matrix<double, 4, 1>> &orientations,
     double speed_factor, double maxDeviation, double timeout) {
-  py::gil_scoped_acquire acquire;
+  TracedGilAcquire acquire("logger");
   py::object logging = py::module_::import("logging");
   logger_ = logging.attr("getLogger")("motion");
   py::gil_scoped_release release;
@@ -172,3 +202,31 @@ Eigen::Vector4d CartesianTrajectory::getOrientation(double time) {
   Eigen::Quaterniond o = Eigen::Quaterniond(aa) * orientations_.at(idx);
   return o.coeffs();
 }
+
+size_t CartesianTrajectory::evaluate(double time, Eigen::Vector3d &position,
+                                     Eigen::Quaterniond &orientation,
+                                     Vector6d &velocity,
+                                     Vector6d &acceleration, size_t hint) {
+  return evaluate(*getCompiled(), time, position, orientation, velocity,
+                  acceleration, hint);
+}
+
+size_t CartesianTrajectory::evaluate(
+    const time_optimal::PiecewisePolynomial &compiled, double time,
+    Eigen::Vector3d &position, Eigen::Quaterniond &orientation,
+    Vector6d &velocity, Vector6d &acceleration, size_t hint) {
+  // Path coordinates are position and cumulative rotation angle
+  Eigen::Vector4d p, v, a;
+  hint = compiled.evaluate(time, p.data(), v.data(), a.data(), hint);
+  // The cumulative angle is non-decreasing along the path, so the rotation
+  // segment follows from it without searching the trajectory steps
+  size_t idx = std::upper_bound(angles_.begin(), angles_.end(), p[3]) -
+               angles_.begin();
+  idx = std::min(std::max<size_t>(idx, 1) - 1, axes_.size() - 1);
+  Eigen::AngleAxisd aa(p[3] - angles_[idx], axes_[idx]);
+  position = p.head(3);
+  orientation = Eigen::Quaterniond(aa) * orientations_[idx];
+  velocity << v.head(3), axes_[idx] * v[3];
+  acceleration << a.head(3), axes_[idx] * a[3];
+  return hint;
+}
@@ -0,0 +1,487 @@
+#include "motion/jerk_limited_trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "constants.h"
+#include "trace.h"
+
+using namespace motion;
+
+// Same derating of the jerk limits as the joint motion generator
+static const double kDefaultMaxJerkData[7] = {2250, 1125, 1500, 1875,
+                                              2250, 3000, 3000};
+const Vector7d JerkLimitedTrajectory::kDefaultMaxJerk =
+    Vector7d(kDefaultMaxJerkData);
+const double JerkLimitedTrajectory::kDefaultMaxDeviation = 1e-3;
+const double JerkLimitedTrajectory::kDefaultKnotSpacing = 0.01;
+
+// Limits are validated at the control rate
+constexpr double kSampleTime = 1e-3;
+// Re-timed segments are filtered on a finer grid
+constexpr long kOversampling = 10;
+constexpr double kTimeScaleFactor = 1.1;
+constexpr size_t kMaxTimeScaleIterations = 40;
+constexpr double kWindowFactor = 1.05;
+constexpr size_t kMaxWindowIterations = 20;
+constexpr double kRestVelocity = 1e-6;
+// Velocity changes over a sample larger than this times the acceleration
+// limits are jumps, blends at the limits may slightly exceed them
+constexpr double kJumpFactor = 2.0;
+// Velocity jumps are located to this precision
+constexpr double kEventTolerance = 1e-9;
+// Relative tolerance of the limit checks. The source may run at the limits
+// and the spline only approximates the smoothed segment.
+constexpr double kLimitTolerance = 1e-4;
+// Change in acceleration relative to the jerk limit that counts as a jump
+constexpr double kJumpTolerance = 1e-3;
+// Knots closer than this are merged, the quintic fit would be
+// ill-conditioned
+constexpr double kMinKnotSpacing = 0.01 * kSampleTime;
+
+JerkLimitedTrajectory::JerkLimitedTrajectory(
+    std::shared_ptr<JointTrajectory> trajectory, const Vector7d &max_jerk,
+    double max_deviation, double knot_spacing)
+    : JerkLimitedTrajectory(trajectory->getCompiled(), max_jerk,
+                            max_deviation, knot_spacing) {}
+
+JerkLimitedTrajectory::JerkLimitedTrajectory(
+    std::shared_ptr<const time_optimal::PiecewisePolynomial> trajectory,
+    const Vector7d &max_jerk, double max_deviation, double knot_spacing)
+    : source_(trajectory),
+      max_jerk_(max_jerk.cwiseAbs()),
+      max_deviation_(max_deviation),
+      knot_spacing_(std::max(knot_spacing, kSampleTime)) {
+  if (source_->getDimension() != 7) {
+    throw std::invalid_argument("Expected a 7-dimensional trajectory.");
+  }
+  TraceScope scope("planning", "jerk_limited_trajectory");
+  _findEvents();
+  double time_scale = 1.0;
+  for (size_t i = 0; i < kMaxTimeScaleIterations; i++) {
+    if (_fit(time_scale)) {
+      time_scale_ = time_scale;
+      return;
+    }
+    time_scale *= kTimeScaleFactor;
+  }
+  throw std::runtime_error("Jerk-limited smoothing failed.");
+}
+
+// Distance from the polyline through `path`, largest joint error of the
+// closest point on any of its segments
+static double _distance(const Vector7d &q, const std::vector<Vector7d> &path) {
+  double distance = (q - path.front()).cwiseAbs().maxCoeff();
+  for (size_t j = 0; j + 1 < path.size(); j++) {
+    const Vector7d segment = path[j + 1] - path[j];
+    const double length = segment.squaredNorm();
+    const double lambda =
+        length > 0.0
+            ? std::clamp((q - path[j]).dot(segment) / length, 0.0, 1.0)
+            : 0.0;
+    distance = std::min(
+        distance, (q - path[j] - lambda * segment).cwiseAbs().maxCoeff());
+  }
+  return distance;
+}
+
+void JerkLimitedTrajectory::_findEvents() {
+  // Without blending the source passes waypoints with a jump in velocity.
+  // Where the jump is more than the acceleration limits allow, the smoothed
+  // trajectory has to come to rest. Jumps are found on the sampling grid and
+  // located by bisection on the direction of motion, which changes at the
+  // waypoint while the speed may jump again at the end of the integration
+  // step around it.
+  const double duration = source_->getDuration();
+  Eigen::VectorXd v0(7), v1(7), a0(7), a1(7), v(7);
+  auto direction = [](const Eigen::VectorXd &velocity) -> Eigen::VectorXd {
+    const double speed = velocity.norm();
+    return speed > kRestVelocity ? Eigen::VectorXd(velocity / speed)
+                                 : Eigen::VectorXd::Zero(velocity.size());
+  };
+  stops_ = {0.0};
+  source_->evaluate(0.0, nullptr, v0.data(), a0.data());
+  // The source was planned for a fraction of the robot's limits, which
+  // stops are re-timed with. For the acceleration it's the largest one held
+  // for two samples, a single one can fall into the step of a jump.
+  double velocity_fraction = 0.0, acceleration_fraction = 0.0;
+  double ratio = (a0.cwiseAbs().array() / kQMaxAcceleration.array()).maxCoeff();
+  for (double t = 0.0; t < duration; t += kSampleTime) {
+    const double t_next = std::min(t + kSampleTime, duration);
+    source_->evaluate(t_next, nullptr, v1.data(), a1.data());
+    velocity_fraction = std::max(
+        velocity_fraction,
+        (v1.cwiseAbs().array() / kQMaxVelocity.array()).maxCoeff());
+    const double next_ratio =
+        (a1.cwiseAbs().array() / kQMaxAcceleration.array()).maxCoeff();
+    acceleration_fraction =
+        std::max(acceleration_fraction, std::min(ratio, next_ratio));
+    ratio = next_ratio;
+    if (((v1 - v0).cwiseAbs().array() >
+         kJumpFactor * (t_next - t) * kQMaxAcceleration.array() +
+             kRestVelocity)
+            .any()) {
+      Eigen::VectorXd d_lower = direction(v0), d_upper = direction(v1), d;
+      double lower = t, upper = t_next;
+      while (upper - lower > kEventTolerance) {
+        const double mid = 0.5 * (lower + upper);
+        source_->evaluate(mid, nullptr, v.data(), nullptr);
+        d = direction(v);
+        if ((d - d_lower).norm() > (d_upper - d).norm()) {
+          upper = mid;
+          d_upper = d;
+        } else {
+          lower = mid;
+          d_lower = d;
+        }
+      }
+      if (upper > stops_.back() + kSampleTime &&
+          upper < duration - kSampleTime) {
+        stops_.push_back(upper);
+      }
+    }
+    v0 = v1;
+  }
+  stops_.push_back(duration);
+  auto limit = [](double fraction, const Vector7d &limits) -> Vector7d {
+    return (fraction > 0.0 ? std::min(fraction, 1.0) : 1.0) * limits;
+  };
+  max_velocity_ = limit(velocity_fraction, kQMaxVelocity);
+  max_acceleration_ = limit(acceleration_fraction, kQMaxAcceleration);
+}
+
+bool JerkLimitedTrajectory::_fit(double time_scale) {
+  spline_ = std::make_shared<time_optimal::PiecewisePolynomial>(7);
+  deviation_ = 0.0;
+  for (size_t s = 0; s + 1 < stops_.size(); s++) {
+    if (!_fitSegment(stops_[s], stops_[s + 1], time_scale)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JerkLimitedTrajectory::_fitSegment(double begin, double end,
+                                        double time_scale) {
+  // Samples of the segment before smoothing, at rest at both ends
+  const double last = end - 10.0 * kEventTolerance;
+  Vector7d origin, target, q, dq, ddq;
+  source_->evaluate(begin, origin.data(), dq.data(), nullptr);
+  source_->evaluate(last, target.data(), ddq.data(), nullptr);
+  const bool at_rest =
+      dq.norm() < kRestVelocity && ddq.norm() < kRestVelocity;
+  double duration;
+  std::function<void(double, Vector7d &, Vector7d &, Vector7d &)> sample;
+  if (at_rest) {
+    // The source itself, slowed down by the time scale
+    duration = (end - begin) * time_scale;
+    sample = [&](double t, Vector7d &p, Vector7d &v, Vector7d &a) {
+      source_->evaluate(std::min(begin + t / time_scale, end), p.data(),
+                        v.data(), a.data());
+      v /= time_scale;
+      a /= time_scale * time_scale;
+    };
+  } else {
+    // Unblended waypoints are joined by straight lines, which are re-timed
+    // with a trapezoidal velocity profile within the limits of the source.
+    // Segments that aren't straight count towards the deviation.
+    const double length = (target - origin).norm();
+    if (!(length > 0.0)) {
+      return true;
+    }
+    const Vector7d direction = (target - origin) / length;
+    std::vector<Vector7d> line{origin, target};
+    for (double t = begin; t < end; t += kSampleTime) {
+      source_->evaluate(t, q.data(), nullptr, nullptr);
+      deviation_ = std::max(deviation_, _distance(q, line));
+    }
+    if (deviation_ > max_deviation_) {
+      return false;
+    }
+    const double max_velocity =
+        (max_velocity_.array() / direction.cwiseAbs().array()).minCoeff() /
+        time_scale;
+    const double max_acceleration =
+        (max_acceleration_.array() / direction.cwiseAbs().array())
+            .minCoeff() /
+        (time_scale * time_scale);
+    const double ramp = std::min(max_velocity / max_acceleration,
+                                 std::sqrt(length / max_acceleration));
+    const double peak = max_acceleration * ramp;
+    const double cruise = (length - peak * ramp) / peak;
+    duration = 2.0 * ramp + cruise;
+    sample = [=](double t, Vector7d &p, Vector7d &v, Vector7d &a) {
+      double s, ds, dds;
+      if (t < ramp) {
+        s = 0.5 * max_acceleration * t * t;
+        ds = max_acceleration * t;
+        dds = max_acceleration;
+      } else if (t < ramp + cruise) {
+        s = peak * (t - 0.5 * ramp);
+        ds = peak;
+        dds = 0.0;
+      } else {
+        const double remaining = std::max(duration - t, 0.0);
+        s = length - 0.5 * max_acceleration * remaining * remaining;
+        ds = max_acceleration * remaining;
+        dds = -max_acceleration;
+      }
+      p = origin + s * direction;
+      v = ds * direction;
+      a = dds * direction;
+    };
+  }
+  const long num_samples = kOversampling * std::max<long>(
+      1, static_cast<long>(std::ceil(duration / kSampleTime)));
+  const double dt = duration / num_samples;
+  std::vector<Vector7d> P(num_samples + 1), V(num_samples + 1),
+      A(num_samples + 1);
+  for (long n = 0; n <= num_samples; n++) {
+    sample(n * dt, P[n], V[n], A[n]);
+  }
+  V.front().setZero();
+  V.back().setZero();
+
+  // A moving average over a window of width w limits the jerk to the
+  // largest change in acceleration within the window over w. Acceleration
+  // jumps become ramps of width w, and the segment gets longer by w. Outside
+  // the segment, the trajectory is at rest. The smallest window that keeps
+  // the jerk within the limits is found by bisection on the samples.
+  const Vector7d zero = Vector7d::Zero();
+  auto acceleration = [&](long n) -> const Vector7d & {
+    return n < 0 || n > num_samples ? zero : A[n];
+  };
+  auto feasible = [&](long window) {
+    for (long n = 0; n <= num_samples + window; n++) {
+      if (((acceleration(n) - acceleration(n - window)).cwiseAbs().array() >
+           max_jerk_.array() * (window * dt))
+              .any()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  Vector7d lowest = zero, highest = zero;
+  for (const auto &acc : A) {
+    lowest = lowest.cwiseMin(acc);
+    highest = highest.cwiseMax(acc);
+  }
+  long lower = std::max<long>(
+      1, static_cast<long>(
+             ((highest.cwiseMax(-lowest).array() / max_jerk_.array())
+                  .maxCoeff() /
+              dt)));
+  long upper = std::max<long>(
+      lower, static_cast<long>(std::ceil(
+                 ((highest - lowest).array() / max_jerk_.array()).maxCoeff() /
+                 dt)));
+  if (feasible(lower)) {
+    upper = lower;
+  }
+  while (upper - lower > 1) {
+    const long mid = (lower + upper) / 2;
+    (feasible(mid) ? upper : lower) = mid;
+  }
+
+  auto state = [&](double t, Vector7d &p, Vector7d &v, Vector7d &a) {
+    if (t > 0.0 && t < duration) {
+      sample(t, p, v, a);
+      return;
+    }
+    p = t <= 0.0 ? P.front() : P.back();
+    v.setZero();
+    a.setZero();
+  };
+  // The smoothed segment is cubic between the jumps in acceleration and the
+  // same times shifted by the window, where it gets its knots. A jump stands
+  // out from the changes over the neighbouring samples, it's located by
+  // bisection. Knots are at most knot_spacing apart, the quintic spline
+  // reproduces the cubic pieces.
+  std::vector<double> jumps;
+  Vector7d a_lower, a_upper;
+  auto change = [&](long n) -> Vector7d {
+    return n < 0 || n >= num_samples ? zero : Vector7d(A[n + 1] - A[n]);
+  };
+  auto stands_out = [&](long n, long m) {
+    return ((change(n) - change(m)).cwiseAbs().array() >
+            kJumpTolerance * max_jerk_.array() * dt)
+        .any();
+  };
+  for (long n = 0; n < num_samples; n++) {
+    if (stands_out(n, n - 1) && stands_out(n, n + 1)) {
+      double t_lower = n * dt, t_upper = (n + 1) * dt;
+      a_lower = A[n];
+      a_upper = A[n + 1];
+      while (t_upper - t_lower > kEventTolerance) {
+        const double mid = 0.5 * (t_lower + t_upper);
+        sample(mid, q, dq, ddq);
+        if ((ddq - a_lower).norm() > (a_upper - ddq).norm()) {
+          t_upper = mid;
+          a_upper = ddq;
+        } else {
+          t_lower = mid;
+          a_lower = ddq;
+        }
+      }
+      jumps.push_back(t_upper);
+    }
+  }
+  // Integral of the position, exact for cubic pieces. Sample intervals are
+  // split at jumps.
+  auto trapezoid = [](double h, const Vector7d &p0, const Vector7d &v0,
+                      const Vector7d &p1, const Vector7d &v1) -> Vector7d {
+    return 0.5 * h * (p0 + p1) + h * h / 12.0 * (v0 - v1);
+  };
+  auto partial = [&](long n, double t, const Vector7d &p,
+                     const Vector7d &v) -> Vector7d {
+    const auto jump = std::upper_bound(jumps.begin(), jumps.end(), n * dt);
+    if (jump == jumps.end() || *jump >= t) {
+      return trapezoid(t - n * dt, P[n], V[n], p, v);
+    }
+    Vector7d p_jump, v_jump, a_jump;
+    sample(*jump, p_jump, v_jump, a_jump);
+    return trapezoid(*jump - n * dt, P[n], V[n], p_jump, v_jump) +
+           trapezoid(t - *jump, p_jump, v_jump, p, v);
+  };
+  std::vector<Vector7d> I(num_samples + 1);
+  I[0].setZero();
+  for (long n = 0; n < num_samples; n++) {
+    I[n + 1] = I[n] + partial(n, (n + 1) * dt, P[n + 1], V[n + 1]);
+  }
+  auto integral = [&](double t) -> Vector7d {
+    if (t <= 0.0) return t * P.front();
+    if (t >= duration) return I.back() + (t - duration) * P.back();
+    const long n = std::min(static_cast<long>(t / dt), num_samples - 1);
+    Vector7d p, v, a;
+    state(t, p, v, a);
+    return I[n] + partial(n, t, p, v);
+  };
+
+  Eigen::VectorXd p0(7), v0(7), a0(7), p1(7), v1(7), a1(7);
+  long window = upper;
+  auto filtered = [&](double t, Eigen::VectorXd &p, Eigen::VectorXd &v,
+                      Eigen::VectorXd &a) {
+    const double width = window * dt;
+    Vector7d q0, dq0, ddq0, q1, dq1, ddq1;
+    state(t - width, q0, dq0, ddq0);
+    state(t, q1, dq1, ddq1);
+    p = (integral(t) - integral(t - width)) / width;
+    v = (q1 - q0) / width;
+    a = (dq1 - dq0) / width;
+  };
+  const size_t first = spline_->getNumIntervals();
+  const double start = spline_->getDuration();
+  std::vector<double> kinks, knots;
+  for (size_t iteration = 0;; iteration++) {
+    const double width = window * dt;
+    const double total = duration + width;
+    kinks = {0.0, width, duration, total};
+    for (double jump : jumps) {
+      kinks.push_back(jump);
+      kinks.push_back(jump + width);
+    }
+    std::sort(kinks.begin(), kinks.end());
+    knots = {0.0};
+    auto fill = [&](double to) {
+      const double from = knots.back();
+      const double num_intervals =
+          std::max(1.0, std::ceil((to - from) / knot_spacing_));
+      for (double k = 1.0; k <= num_intervals; k++) {
+        knots.push_back(from + (to - from) * k / num_intervals);
+      }
+    };
+    for (double kink : kinks) {
+      if (kink - knots.back() >= kMinKnotSpacing &&
+          total - kink >= kMinKnotSpacing) {
+        fill(kink);
+      }
+    }
+    fill(total);
+
+    bool within_limits = true;
+    for (size_t i = 0; within_limits && i + 1 < knots.size(); i++) {
+      filtered(knots[i], p0, v0, a0);
+      filtered(knots[i + 1], p1, v1, a1);
+      spline_->appendInterval(knots[i + 1] - knots[i], p0, v0, a0, p1, v1,
+                              a1);
+      within_limits = (spline_->getMaxJerk(spline_->getNumIntervals() - 1)
+                           .array() <=
+                       max_jerk_.array() * (1.0 + kLimitTolerance))
+                          .all();
+    }
+    if (within_limits) break;
+    while (spline_->getNumIntervals() > first) {
+      spline_->popInterval();
+    }
+    if (iteration + 1 == kMaxWindowIterations) {
+      return false;
+    }
+    window = std::max(window + 1, static_cast<long>(std::ceil(
+                                      window * kWindowFactor)));
+  }
+
+  // Every point of the moving average lies within the convex hull of the
+  // path under its window, deviation is measured from that part of the path
+  std::vector<Vector7d> path;
+  size_t hint = first;
+  for (double t = start; t <= spline_->getDuration(); t += kSampleTime) {
+    hint = spline_->evaluate(t, q.data(), dq.data(), ddq.data(), hint);
+    if ((dq.cwiseAbs().array() >
+         kQMaxVelocity.array() * (1.0 + kLimitTolerance))
+            .any() ||
+        (ddq.cwiseAbs().array() >
+         kQMaxAcceleration.array() * (1.0 + kLimitTolerance))
+            .any()) {
+      return false;
+    }
+    const long n = static_cast<long>(std::round((t - start) / dt));
+    const long from = std::clamp<long>(n - window, 0, num_samples);
+    const long to = std::clamp<long>(n, 0, num_samples);
+    path.clear();
+    for (long m = from; m < to; m += kOversampling) {
+      path.push_back(P[m]);
+    }
+    path.push_back(P[to]);
+    deviation_ = std::max(deviation_, _distance(q, path));
+    if (deviation_ > max_deviation_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Vector7d JerkLimitedTrajectory::getJointPositions(double time) const {
+  Vector7d position;
+  spline_->evaluate(time, position.data(), nullptr, nullptr);
+  return position;
+}
+
+Vector7d JerkLimitedTrajectory::getJointVelocities(double time) const {
+  Vector7d velocity;
+  spline_->evaluate(time, nullptr, velocity.data(), nullptr);
+  return velocity;
+}
+
+Vector7d JerkLimitedTrajectory::getJointAccelerations(double time) const {
+  Vector7d acceleration;
+  spline_->evaluate(time, nullptr, nullptr, acceleration.data());
+  return acceleration;
+}
+
+size_t JerkLimitedTrajectory::evaluate(double time, Vector7d &position,
+                                       Vector7d &velocity,
+                                       Vector7d &acceleration,
+                                       size_t hint) const {
+  return spline_->evaluate(time, position.data(), velocity.data(),
+                           acceleration.data(), hint);
+}
+
+std::tuple<MatrixX7d, MatrixX7d, MatrixX7d> JerkLimitedTrajectory::sample(
+    const Eigen::VectorXd &times) const {
+  MatrixX7d q(times.size(), 7), dq(times.size(), 7), ddq(times.size(), 7);
+  spline_->sample(times.data(), times.size(), q.data(), dq.data(), ddq.data());
+  return std::make_tuple(q, dq, ddq);
+}
@@ -0,0 +1,213 @@
+#include "motion/time_optimal/piecewise_polynomial.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace motion::time_optimal;
+
+// Intervals shorter than this are represented by their Taylor expansion at
+// the left knot, the quintic fit would be ill-conditioned.
+constexpr double kMinIntervalLength = 1e-6;
+// Offset used to evaluate path derivatives on the left side of a segment
+// boundary.
+constexpr double kBoundaryOffset = 1e-12;
+
+PiecewisePolynomial::PiecewisePolynomial(const Trajectory &trajectory)
+    : dim_(trajectory.joint_num_) {
+  const Path &path = trajectory.path_;
+  const auto &steps = trajectory.trajectory_;
+
+  std::vector<double> boundaries;
+  for (const auto &point : path.getSwitchingPoints()) {
+    if (point.second) boundaries.push_back(point.first);
+  }
+
+  Eigen::VectorXd p0(dim_), v0(dim_), a0(dim_), p1(dim_), v1(dim_), a1(dim_);
+  auto evaluatePath = [&path](double s, double s_d, double s_dd, bool left,
+                              Eigen::VectorXd &p, Eigen::VectorXd &v,
+                              Eigen::VectorXd &a) {
+    p = path.getConfig(s);
+    // Tangent and curvature are taken from the segment the interval lies on
+    double s_eval = left ? std::max(0.0, s - kBoundaryOffset) : s;
+    Eigen::VectorXd tangent = path.getTangent(s_eval);
+    v = tangent * s_d;
+    a = path.getCurvature(s_eval) * s_d * s_d + tangent * s_dd;
+  };
+
+  breaks_.push_back(0.0);
+  if (steps.size() < 2) {
+    // Degenerate trajectory, hold the start configuration
+    evaluatePath(0.0, 0.0, 0.0, false, p0, v0, a0);
+    appendInterval(kMinIntervalLength, p0, v0, a0, p0, v0, a0);
+    return;
+  }
+
+  auto boundary = boundaries.begin();
+  auto previous = steps.begin();
+  for (auto it = std::next(previous); it != steps.end(); previous = it, ++it) {
+    const double h = it->time_ - previous->time_;
+    if (!(h > 0.0)) continue;
+    const double s0 = previous->path_pos_;
+    const double s_d0 = previous->path_vel_;
+    const double s_dd =
+        2.0 * (it->path_pos_ - s0 - h * s_d0) / (h * h);
+
+    // Split the step where it crosses path segment boundaries
+    std::vector<double> splits;
+    while (boundary != boundaries.end() && *boundary <= s0) ++boundary;
+    while (boundary != boundaries.end() && *boundary < it->path_pos_) {
+      const double ds = *boundary - s0;
+      const double root = std::sqrt(std::max(0.0, s_d0 * s_d0 + 2.0 * s_dd * ds));
+      const double tau = 2.0 * ds / (s_d0 + root);
+      if (tau > 0.0 && tau < h) splits.push_back(tau);
+      ++boundary;
+    }
+    splits.push_back(h);
+
+    double tau0 = 0.0;
+    for (double tau1 : splits) {
+      if (tau1 - tau0 <= 0.0) continue;
+      const double sa = s0 + s_d0 * tau0 + 0.5 * s_dd * tau0 * tau0;
+      const double sb = s0 + s_d0 * tau1 + 0.5 * s_dd * tau1 * tau1;
+      evaluatePath(sa, s_d0 + s_dd * tau0, s_dd, false, p0, v0, a0);
+      evaluatePath(sb, s_d0 + s_dd * tau1, s_dd, true, p1, v1, a1);
+      const double t_end = previous->time_ + tau1;
+      appendInterval(t_end - breaks_.back(), p0, v0, a0, p1, v1, a1);
+      tau0 = tau1;
+    }
+  }
+
+  if (coeffs_.empty()) {
+    evaluatePath(0.0, 0.0, 0.0, false, p0, v0, a0);
+    appendInterval(kMinIntervalLength, p0, v0, a0, p0, v0, a0);
+  }
+}
+
+PiecewisePolynomial::PiecewisePolynomial(size_t dim) : dim_(dim) {
+  breaks_.push_back(0.0);
+}
+
+void PiecewisePolynomial::appendInterval(
+    double h, const Eigen::VectorXd &p0, const Eigen::VectorXd &v0,
+    const Eigen::VectorXd &a0, const Eigen::VectorXd &p1,
+    const Eigen::VectorXd &v1, const Eigen::VectorXd &a1) {
+  if (!(h > 0.0)) return;
+  const size_t offset = coeffs_.size();
+  coeffs_.resize(offset + kOrder * dim_);
+  Eigen::Map<Eigen::MatrixXd> c(coeffs_.data() + offset, dim_, kOrder);
+  c.col(0) = p0;
+  c.col(1) = v0;
+  c.col(2) = 0.5 * a0;
+  if (h < kMinIntervalLength) {
+    c.rightCols<3>().setZero();
+  } else {
+    // Quintic Hermite interpolation of position, velocity and acceleration
+    const double h2 = h * h, h3 = h2 * h;
+    const Eigen::VectorXd dp = p1 - p0;
+    c.col(3) = (20.0 * dp - (8.0 * v1 + 12.0 * v0) * h -
+                (3.0 * a0 - a1) * h2) /
+               (2.0 * h3);
+    c.col(4) = (-30.0 * dp + (14.0 * v1 + 16.0 * v0) * h +
+                (3.0 * a0 - 2.0 * a1) * h2) /
+               (2.0 * h3 * h);
+    c.col(5) = (12.0 * dp - 6.0 * (v1 + v0) * h - (a0 - a1) * h2) /
+               (2.0 * h3 * h2);
+  }
+  breaks_.push_back(breaks_.back() + h);
+}
+
+size_t PiecewisePolynomial::findInterval(double time, size_t hint) const {
+  const size_t last = breaks_.size() - 2;
+  if (hint > last) hint = last;
+  // Fast path for monotonic sampling, check the hinted and next interval
+  if (time >= breaks_[hint]) {
+    if (hint == last || time < breaks_[hint + 1]) return hint;
+    if (hint + 1 == last || time < breaks_[hint + 2]) return hint + 1;
+  }
+  auto it = std::upper_bound(breaks_.begin() + 1, breaks_.end() - 1, time);
+  return std::distance(breaks_.begin() + 1, it);
+}
+
+size_t PiecewisePolynomial::evaluate(double time, double *position,
+                                     double *velocity, double *acceleration,
+                                     size_t hint) const {
+  time = std::min(std::max(time, 0.0), breaks_.back());
+  const size_t idx = findInterval(time, hint);
+  const double tau = time - breaks_[idx];
+  const double *c = coeffs_.data() + idx * kOrder * dim_;
+  for (size_t j = 0; j < dim_; j++) {
+    const double c0 = c[j], c1 = c[dim_ + j], c2 = c[2 * dim_ + j],
+                 c3 = c[3 * dim_ + j], c4 = c[4 * dim_ + j],
+                 c5 = c[5 * dim_ + j];
+    if (position)
+      position[j] =
+          ((((c5 * tau + c4) * tau + c3) * tau + c2) * tau + c1) * tau + c0;
+    if (velocity)
+      velocity[j] =
+          (((5.0 * c5 * tau + 4.0 * c4) * tau + 3.0 * c3) * tau + 2.0 * c2) *
+              tau +
+          c1;
+    if (acceleration)
+      acceleration[j] =
+          ((20.0 * c5 * tau + 12.0 * c4) * tau + 6.0 * c3) * tau + 2.0 * c2;
+  }
+  return idx;
+}
+
+Eigen::VectorXd PiecewisePolynomial::getPosition(double time) const {
+  Eigen::VectorXd position(dim_);
+  evaluate(time, position.data(), nullptr, nullptr);
+  return position;
+}
+
+Eigen::VectorXd PiecewisePolynomial::getVelocity(double time) const {
+  Eigen::VectorXd velocity(dim_);
+  evaluate(time, nullptr, velocity.data(), nullptr);
+  return velocity;
+}
+
+Eigen::VectorXd PiecewisePolynomial::getAcceleration(double time) const {
+  Eigen::VectorXd acceleration(dim_);
+  evaluate(time, nullptr, nullptr, acceleration.data());
+  return acceleration;
+}
+
+void PiecewisePolynomial::sample(const double *times, size_t num_samples,
+                                 double *positions, double *velocities,
+                                 double *accelerations) const {
+  size_t hint = 0;
+  for (size_t i = 0; i < num_samples; i++) {
+    const size_t offset = i * dim_;
+    hint = evaluate(times[i], positions ? positions + offset : nullptr,
+                    velocities ? velocities + offset : nullptr,
+                    accelerations ? accelerations + offset : nullptr, hint);
+  }
+}
+
+Eigen::VectorXd PiecewisePolynomial::getMaxJerk(size_t interval) const {
+  // The jerk 6 c3 + 24 c4 t + 60 c5 t^2 is extremal at the interval bounds
+  // or at the vertex of the parabola
+  const double h = breaks_[interval + 1] - breaks_[interval];
+  const double *c = coeffs_.data() + interval * kOrder * dim_;
+  Eigen::VectorXd max_jerk(dim_);
+  for (size_t j = 0; j < dim_; j++) {
+    const double c3 = c[3 * dim_ + j], c4 = c[4 * dim_ + j],
+                 c5 = c[5 * dim_ + j];
+    auto jerk = [&](double t) {
+      return std::abs(6.0 * c3 + (24.0 * c4 + 60.0 * c5 * t) * t);
+    };
+    double m = std::max(jerk(0.0), jerk(h));
+    if (c5 != 0.0) {
+      const double vertex = -c4 / (5.0 * c5);
+      if (vertex > 0.0 && vertex < h) m = std::max(m, jerk(vertex));
+    }
+    max_jerk[j] = m;
+  }
+  return max_jerk;
+}
+
+void PiecewisePolynomial::popInterval() {
+  if (breaks_.size() < 2) return;
+  breaks_.pop_back();
+  coeffs_.resize(coeffs_.size() - kOrder * dim_);
+}
@@ -42,6 +42,8 @@
 #include <iostream>
 #include <limits>
 
+#include "trace.h"
+
 using namespace Eigen;
 using namespace std;
 using namespace motion::time_optimal;
@@ -62,7 +64,7 @@ Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity,
       valid_(true),
       time_step_(time_step),
       cached_time_(std::numeric_limits<double>::max()) {
-  py::gil_scoped_acquire acquire;
+  TracedGilAcquire acquire("logger");
   py::object logging = py::module_::import("logging");
   logger_ = logging.attr("getLogger")("motion");
   py::gil_scoped_release release;
@@ -298,7 +300,7 @@ bool Trajectory::integrateForward(std::list<TrajectoryStep>& trajectory,
       return true;
     } else if (path_vel < 0.0) {
       valid_ = false;
-      py::gil_scoped_acquire acquire;
+      TracedGilAcquire acquire("log");
       logger_.attr("debug")("Negative path velocity while integrating forward.");
       return true;
     }
@@ -387,7 +389,7 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
 
       if (path_vel < 0.0) {
         valid_ = false;
-        py::gil_scoped_acquire acquire;
+        TracedGilAcquire acquire("log");
         logger_.attr("debug")("Negative path velocity while integrating forward.");
         end_trajectory_ = trajectory;
         return;
@@ -420,7 +422,7 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
   }
 
   valid_ = false;
-  py::gil_scoped_acquire acquire;
+  TracedGilAcquire acquire("log");
   logger_.attr("debug")("Did not hit start trajectory while integrating backward.");
   end_trajectory_ = trajectory;
 }
@@ -0,0 +1,54 @@
+#include "motion/trajectory_set.h"
+
+#include <stdexcept>
+
+#include "trace.h"
+
+using namespace motion;
+
+TrajectorySet::TrajectorySet(
+    const std::vector<std::shared_ptr<JointTrajectory>> &trajectories,
+    ThreadPool::Priority priority)
+    : trajectories_(trajectories), priority_(priority) {}
+
+void TrajectorySet::add(std::shared_ptr<JointTrajectory> trajectory) {
+  trajectories_.push_back(trajectory);
+}
+
+void TrajectorySet::clear() { trajectories_.clear(); }
+
+std::shared_ptr<JointTrajectory> TrajectorySet::get(size_t index) const {
+  if (index >= trajectories_.size()) {
+    throw std::out_of_range("Trajectory index out of range.");
+  }
+  return trajectories_[index];
+}
+
+Eigen::VectorXd TrajectorySet::getDurations() const {
+  Eigen::VectorXd durations(trajectories_.size());
+  for (size_t i = 0; i < trajectories_.size(); i++) {
+    durations[i] = trajectories_[i]->getDuration();
+  }
+  return durations;
+}
+
+void TrajectorySet::compile() {
+  TraceScope scope("planning", "compile_trajectory_set");
+  ThreadPool::instance().parallelFor(
+      trajectories_.size(), [this](size_t i) { trajectories_[i]->compile(); },
+      priority_);
+}
+
+void TrajectorySet::evaluate(const double *times, size_t num_times,
+                             double *positions, double *velocities,
+                             double *accelerations) {
+  TraceScope scope("planning", "evaluate_trajectory_set");
+  const size_t stride = num_times * 7;
+  ThreadPool::instance().parallelFor(trajectories_.size(), [&](size_t i) {
+    const size_t offset = i * stride;
+    trajectories_[i]->getCompiled()->sample(
+        times, num_times, positions ? positions + offset : nullptr,
+        velocities ? velocities + offset : nullptr,
+        accelerations ? accelerations + offset : nullptr);
+  }, priority_);
+}
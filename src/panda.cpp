@@ -2,6 +2,7 @@
 
 #include <franka/exception.h>
 
+#include <chrono>
 #include <iostream>
 #include <typeinfo>
 
@@ -9,6 +10,7 @@
 #include "motion/generators.h"
 #include "motion/generator.h"
 #include "motion/joint_motion_generator.hpp"
+#include "trace.h"
 
 namespace std
 {
@@ -25,6 +27,10 @@ namespace std
 
 bool PandaContext::ok()
 {
+  if (tick_group_)
+  {
+    return _okBlock();
+  }
   panda_.raiseError();
   auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
                      std::chrono::high_resolution_clock::now() - t_prev_)
@@ -32,6 +38,7 @@ bool PandaContext::ok()
                  1e6;
   if (elapsed < dt_)
   {
+    TraceScope scope("context", "sleep");
     std::this_thread::sleep_for(
         std::chrono::microseconds(int((dt_ - elapsed) * 1e6)));
   }
@@ -51,14 +58,63 @@ bool PandaContext::ok()
   }
 }
 
+bool PandaContext::_okBlock()
+{
+  panda_.raiseError();
+  bool fresh = false;
+  {
+    py::gil_scoped_release release;
+    TraceScope scope("context", "wait_block");
+    // Wait for the control thread to publish the next block, give up once
+    // the control loop has terminated
+    while (!fresh)
+    {
+      fresh = tick_group_->wait(0.1);
+      if (!fresh && !panda_.isMoving())
+      {
+        break;
+      }
+    }
+  }
+  panda_.raiseError();
+  if (!fresh)
+  {
+    return false;
+  }
+  uint64_t sequence = block_.sequence;
+  block_ = tick_group_->read();
+  if (sequence > 0 && block_.sequence > sequence + 1)
+  {
+    num_dropped_blocks_ += block_.sequence - sequence - 1;
+  }
+  t_prev_ = std::chrono::high_resolution_clock::now();
+  num_ticks_ += tick_group_->getBlockSize();
+  if (max_ticks_ > 0 && num_ticks_ > max_ticks_)
+  {
+    return false;
+  }
+  else if (t_max_ > 0.0 && getTime() >= t_max_)
+  {
+    return false;
+  }
+  return true;
+}
+
 PandaContext::PandaContext(Panda &panda, const double &frequency,
-                           const double &t_max, const uint64_t &max_ticks)
+                           const double &t_max, const uint64_t &max_ticks,
+                           const size_t &block_size)
     : dt_(1.0 / frequency),
       t_prev_(t_start_),
       max_ticks_(max_ticks),
       t_max_(t_max),
       num_ticks_(0),
-      panda_(panda) {}
+      panda_(panda)
+{
+  if (block_size > 0)
+  {
+    tick_group_ = std::make_shared<TickGroup>(block_size);
+  }
+}
 
 double PandaContext::getTime()
 {
@@ -71,21 +127,84 @@ double PandaContext::getTime()
 const PandaContext &PandaContext::enter()
 {
   t_start_ = std::chrono::high_resolution_clock::now();
+  t_prev_ = t_start_;
+  if (tick_group_)
+  {
+    panda_._setTickGroup(tick_group_);
+  }
   return *this;
 }
 
 bool PandaContext::exit(const py::object &type, const py::object &value,
                         const py::object &traceback)
 {
+  if (tick_group_)
+  {
+    panda_._setTickGroup(nullptr);
+  }
   return false;
 }
 
 uint64_t PandaContext::getNumTicks() { return num_ticks_; }
 
+size_t PandaContext::getBlockSize()
+{
+  return tick_group_ ? tick_group_->getBlockSize() : 0;
+}
+
+uint64_t PandaContext::getNumDroppedBlocks() { return num_dropped_blocks_; }
+
+std::map<std::string, TickGroup::RowMatrixXd> PandaContext::getStates()
+{
+  if (!tick_group_)
+  {
+    throw std::runtime_error(
+        "States are only available for contexts with a block size.");
+  }
+  std::map<std::string, TickGroup::RowMatrixXd> states;
+  states.emplace("q", block_.q);
+  states.emplace("dq", block_.dq);
+  states.emplace("tau_J", block_.tau_J);
+  states.emplace("tau_ext_hat_filtered", block_.tau_ext_hat_filtered);
+  states.emplace("O_T_EE", block_.O_T_EE);
+  states.emplace("O_F_ext_hat_K", block_.O_F_ext_hat_K);
+  states.emplace("time", block_.time);
+  return states;
+}
+
+void PandaContext::setSetpoints(const TickGroup::RowMatrixXd &setpoints)
+{
+  if (!tick_group_)
+  {
+    throw std::runtime_error(
+        "Setpoints can only be set for contexts with a block size.");
+  }
+  if (setpoints.rows() == 0)
+  {
+    throw std::invalid_argument("Setpoints must have at least one row.");
+  }
+  auto controller = panda_.current_controller_;
+  if (!controller || !controller->acceptsSetpoint(setpoints.cols()))
+  {
+    throw std::invalid_argument(
+        "The active controller doesn't accept setpoints with " +
+        std::to_string(setpoints.cols()) + " columns.");
+  }
+  tick_group_->setSetpoints(setpoints);
+}
+
+static std::shared_ptr<controllers::joint_limits::VirtualWallController>
+_createVirtualWalls()
+{
+  return std::make_shared<controllers::joint_limits::VirtualWallController>(
+      kUpperJointLimits, kLowerJointLimits, kPDZoneWidth, kDZoneWidth,
+      kPDZoneStiffness, kPDZoneDamping, kDZoneDamping);
+}
+
 template <typename... Args>
 void Panda::_log(const std::string level, Args &&...args)
 {
-  py::gil_scoped_acquire acquire;
+  TracedGilAcquire acquire("log");
   logger_.attr(level.c_str())(args...);
 }
 
@@ -97,17 +216,42 @@ Panda::Panda(std::string hostname, std::string name,
   logger_ = logging.attr("getLogger")(name);
   moving_ = false;
   py::gil_scoped_release release;
+  auto seconds = [](std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         since)
+        .count();
+  };
+  auto start = std::chrono::steady_clock::now();
   robot_ = std::shared_ptr<franka::Robot>(
       new franka::Robot(hostname, realtime_config));
-  model_ = std::make_shared<franka::Model>(robot_->loadModel());
+  connection_timing_.connect = seconds(start);
+  auto model_start = std::chrono::steady_clock::now();
+  model_ = ModelCache::instance().get(
+      *robot_, {hostname, robot_->serverVersion()},
+      &connection_timing_.model_source);
+  robot_model_ = std::make_shared<FrankaRobotModel>(model_);
+  connection_timing_.load_model = seconds(model_start);
   hostname_ = hostname;
-  _log("info", "Connected to robot (%s).", hostname_);
+  auto state_start = std::chrono::steady_clock::now();
   _setState(robot_->readOnce());
-  virtual_walls_ =
-      std::shared_ptr<controllers::joint_limits::VirtualWallController>(
-          new controllers::joint_limits::VirtualWallController(
-              kUpperJointLimits, kLowerJointLimits, kPDZoneWidth, kDZoneWidth,
-              kPDZoneStiffness, kPDZoneDamping, kDZoneDamping));
+  connection_timing_.read_state = seconds(state_start);
+  connection_timing_.total = seconds(start);
+  static const char *kModelSources[] = {"robot", "memory"};
+  _log("info", "Connected to robot (%s) in %.0f ms, model loaded from %s.",
+       hostname_, 1e3 * connection_timing_.total,
+       kModelSources[static_cast<int>(connection_timing_.model_source)]);
+  virtual_walls_ = _createVirtualWalls();
+}
+
+Panda::Panda(const std::string &name, std::shared_ptr<RobotModel> model)
+    : name_(name)
+{
+  py::object logging = py::module_::import("logging");
+  logger_ = logging.attr("getLogger")(name);
+  moving_ = false;
+  hostname_ = "simulation";
+  robot_model_ = model;
+  virtual_walls_ = _createVirtualWalls();
 }
 
 Panda::~Panda()
@@ -117,15 +261,19 @@ Panda::~Panda()
 }
 
 const PandaContext Panda::createContext(double frequency, double max_runtime,
-                                        uint64_t max_iter)
+                                        uint64_t max_iter, size_t block_size)
 {
-  return PandaContext(*this, frequency, max_runtime, max_iter);
+  return PandaContext(*this, frequency, max_runtime, max_iter, block_size);
 }
 
 franka::Robot &Panda::getRobot() { return *robot_; }
 
 franka::Model &Panda::getModel() { return *model_; }
 
+const Panda::ConnectionTiming &Panda::getConnectionTiming() const {
+  return connection_timing_;
+}
+
 franka::RobotState Panda::getState()
 {
   refreshState();
@@ -250,17 +398,44 @@ void Panda::_setState(const franka::RobotState &state)
       log_.pop_front();
     }
   }
+  tick_group_busy_.store(true);
+  if (TickGroup *tick_group = tick_group_.load())
+  {
+    tick_group->push(state);
+  }
+  tick_group_busy_.store(false, std::memory_order_release);
+}
+
+void Panda::_setTickGroup(std::shared_ptr<TickGroup> tick_group)
+{
+  std::lock_guard<std::mutex> lock(tick_group_mux_);
+  tick_group_.store(tick_group.get());
+  // Sequentially consistent with the control thread's busy flag: once the
+  // flag reads false, the control thread either finished with the previous
+  // group or will load the new pointer, so the previous group is released
+  // here rather than on the control thread.
+  while (tick_group_busy_.load())
+  {
+    std::this_thread::yield();
+  }
+  tick_group_owner_ = std::move(tick_group);
 }
 void Panda::startGenerator(std::shared_ptr<motion::Generator> generator_ptr)
 {
+  TraceScope scope("panda", "start_generator");
   moving_ = true;
   stopGenerator();
   joinMotionThread();
   recover();
   _log("info", "Starting new generator (%s).", generator_ptr->name());
+  if (Tracer::instance().isEnabled())
+  {
+    Tracer::instance().instant("panda",
+                               Tracer::instance().intern(generator_ptr->name()));
+  }
   this->current_generator_ = generator_ptr;
   current_generator_->setTime(0);
-  current_generator_->start(this, robot_->readOnce(), model_);
+  current_generator_->start(this, robot_->readOnce(), robot_model_);
 
   auto callback = std::bind(&motion::Generator::runController, current_generator_);
   current_thread_ = std::thread(callback);
@@ -270,12 +445,14 @@ void Panda::stopGenerator()
 {
   if (current_generator_ && current_generator_->isRunning())
   {
-     current_generator_->stop(state_, model_);
+     TraceScope scope("panda", "stop_generator");
+     current_generator_->stop(state_, robot_model_);
   }
 }
 
 void Panda::startController(std::shared_ptr<TorqueController> controller_ptr)
 {
+  TraceScope scope("panda", "start_controller");
   moving_ = true;
   stopController();
   _startController(controller_ptr);
@@ -287,10 +464,15 @@ void Panda::_startController(std::shared_ptr<TorqueController> controller_ptr)
 {
   recover();
   _log("info", "Starting new controller (%s).", controller_ptr->name());
+  if (Tracer::instance().isEnabled())
+  {
+    Tracer::instance().instant("panda",
+                               Tracer::instance().intern(controller_ptr->name()));
+  }
   virtual_walls_->reset();
   this->current_controller_ = controller_ptr;
   current_controller_->setTime(0);
-  current_controller_->start(robot_->readOnce(), model_);
+  current_controller_->start(robot_->readOnce(), robot_model_);
 }
 
 TorqueCallback Panda::_createTorqueCallback()
@@ -298,14 +480,30 @@ TorqueCallback Panda::_createTorqueCallback()
   return TorqueCallback([&](const franka::RobotState &robot_state,
                             franka::Duration duration) -> franka::Torques
                         {
-    _setState(robot_state);
+    TraceScope tick_scope("control", "tick");
+    {
+      TraceScope scope("control", "state");
+      _setState(robot_state);
+    }
     franka::Torques tau = franka::Torques({0, 0, 0, 0, 0, 0, 0});
+    tick_group_busy_.store(true);
+    if (TickGroup *tick_group = tick_group_.load()) {
+      TraceScope scope("control", "setpoint");
+      size_t size;
+      const double *setpoint = tick_group->nextSetpoint(size);
+      if (setpoint && current_controller_) {
+        current_controller_->applySetpoint(setpoint, size);
+      }
+    }
+    tick_group_busy_.store(false, std::memory_order_release);
     if (current_controller_) {
+      TraceScope scope("control", "step");
       current_controller_->setTime(current_controller_->getTime() +
                                    duration.toSec());
       tau = current_controller_->step(robot_state, duration);
     }
     // Virtual joint walls
+    TraceScope scope("control", "limits");
     Array7d tau_virtual_wall, tau_saturated, tau_clipped;
     virtual_walls_->computeTorque(robot_state.q, robot_state.dq,
                                   tau_virtual_wall);
@@ -320,11 +518,12 @@ TorqueCallback Panda::_createTorqueCallback()
 
 void Panda::stopController()
 {
+  TraceScope scope("panda", "stop_controller");
   if (current_controller_ && current_controller_->isRunning())
   {
     _log("info", "Stopping active controller (%s).",
          current_controller_->name());
-    current_controller_->stop(state_, model_);
+    current_controller_->stop(state_, robot_model_);
   }
   if (current_thread_.joinable())
   {
@@ -334,24 +533,29 @@ void Panda::stopController()
 
 void Panda::recover()
 {
+  TraceScope scope("panda", "recover");
   auto state = robot_->readOnce();
   if (state.current_errors || state.robot_mode == franka::RobotMode::kReflex ||
       state.robot_mode == franka::RobotMode::kOther)
   {
     _log("warning",
          "Irregular state detected. Attempting automatic error recovery.");
+    TraceScope recovery_scope("panda", "automatic_error_recovery");
     robot_->automaticErrorRecovery();
   }
 }
 
 void Panda::_runController(TorqueCallback &control_callback)
 {
+  Tracer::instance().setThreadName("control (" + name_ + ")");
+  Tracer::instance().prepareRealTimeThread();
   try
   {
     robot_->control(control_callback);
   }
   catch (const franka::Exception &e)
   {
+    Tracer::instance().instant("panda", "control_error");
     _log("error", "Control loop interruped: %s", e.what());
     last_error_ = std::make_shared<franka::Exception>(e);
   }
@@ -426,3 +630,32 @@ void Panda::setDefaultBehavior()
   robot_->setJointImpedance({{3000, 3000, 3000, 2500, 2500, 2000, 2000}});
   robot_->setCartesianImpedance({{3000, 3000, 3000, 300, 300, 300}});
 }
+
+void Panda::setKinematics(std::shared_ptr<kinematics::Kinematics> kinematics)
+{
+  if (!kinematics)
+  {
+    throw std::invalid_argument("Kinematics must not be None.");
+  }
+  if (isMoving())
+  {
+    throw std::runtime_error(
+        "The end effector can't be changed while the robot is moving.");
+  }
+  // libfranka's end effector is relative to the nominal one set in Desk
+  const auto state = robot_->readOnce();
+  const Eigen::Matrix4d F_T_NE = Eigen::Matrix4d::Map(state.F_T_NE.data());
+  const Eigen::Matrix4d NE_T_EE =
+      Eigen::Affine3d(F_T_NE).inverse(Eigen::Isometry).matrix() *
+      kinematics->getTransform();
+  std::array<double, 16> NE_T_EE_array;
+  Eigen::Matrix4d::Map(NE_T_EE_array.data()) = NE_T_EE;
+  robot_->setEE(NE_T_EE_array);
+  kinematics_ = kinematics;
+  refreshState();
+}
+
+std::shared_ptr<kinematics::Kinematics> Panda::getKinematics()
+{
+  return kinematics_;
+}
@@ -9,5 +9,11 @@ that allows you to program and control the robot in real-time.
 """
 
 # pylint: disable=no-name-in-module
-from ._core import fk, ik, ik_full, JointMotion, CartesianMotion, ReferenceFrame
+from ._core import fk, ik, ik_full, JointMotion, CartesianMotion, ReferenceFrame,\
+                   configure_thread_pool, get_thread_pool_config, TaskPriority,\
+                   configure_model_cache, get_model_cache_stats, clear_model_cache,\
+                   set_model_loader,\
+                   rollout, RolloutObjective, configure_tracing, save_trace,\
+                   get_trace_stats, clear_trace, StressTest, Kinematics,\
+                   CycleTimeBenchmark, MotionStrategy
 from .robot import Panda
@@ -3,8 +3,9 @@ import numpy
 import panda_py.libfranka
 import pybind11_stubgen.typing_ext
 import typing
-__all__ = ['AppliedForce', 'AppliedTorque', 'CartesianImpedance', 'CartesianMotion', 'CartesianMotionGenerator', 'CartesianTrajectory', 'Force', 'Generator', 'IntegratedVelocity', 'JointMotion', 'JointMotionGenerator', 'JointPosition', 'JointTrajectory', 'MotionData', 'Panda', 'PandaContext', 'ReferenceFrame', 'TorqueController', 'fk', 'ik', 'ik_full']
+__all__ = ['AppliedForce', 'AppliedTorque', 'CartesianImpedance', 'CartesianMotion', 'CartesianMotionGenerator', 'CartesianTrajectory', 'CartesianTrajectoryFollower', 'CartesianTrajectoryFuture', 'CartesianVelocityStreamGenerator', 'CycleTimeBenchmark', 'Force', 'Generator', 'HybridForceImpedance', 'IntegratedVelocity', 'JerkLimitedTrajectory', 'JointMotion', 'JointMotionGenerator', 'JointPosition', 'JointTrajectory', 'JointTrajectoryFollower', 'JointTrajectoryFuture', 'JointTrajectoryGenerator', 'JointTrajectoryMPC', 'JointVelocityStreamGenerator', 'Kinematics', 'MotionData', 'MotionStrategy', 'NullspaceObjective', 'Panda', 'PandaContext', 'ReferenceFrame', 'RolloutObjective', 'SetpointBuffer', 'StressTest', 'TaskPriority', 'TimeScaling', 'TorqueController', 'TrajectorySet', 'clear_model_cache', 'clear_trace', 'configure_model_cache', 'configure_thread_pool', 'configure_tracing', 'fk', 'get_model_cache_stats', 'get_thread_pool_config', 'get_trace_stats', 'ik', 'ik_full', 'rollout', 'save_trace', 'set_model_loader']
 M = typing.TypeVar("M", bound=int)
+N = typing.TypeVar("N", bound=int)
 class AppliedForce(TorqueController):
     @staticmethod
     def _pybind11_conduit_v1_(*args, **kwargs):
@@ -46,16 +47,58 @@ class CartesianImpedance(TorqueController):
                          nullspace_stiffness: Control gain of the nullspace term.
                          filter_coeff: TP1 filter coefficient used to filter input signals.
         """
-    def set_control(self, position: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]], orientation: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]], q_nullspace: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ...) -> None:
-        ...
+    def set_control(self, position: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]], orientation: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]], q_nullspace: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] | None = None) -> None:
+        """
+                  Set the end-effector pose and, optionally, the nullspace joint
+                  positions the posture objective pulls towards. The nullspace
+                  target starts at the joint positions the controller was started
+                  with and is kept if `q_nullspace` is None.
+        """
     def set_damping_ratio(self, damping: float) -> None:
         ...
     def set_filter(self, filter_coeff: float) -> None:
         ...
     def set_impedance(self, impedance: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[6]], numpy.dtype[numpy.float64]]) -> None:
         ...
+    def set_nullspace_objective(self, objective: NullspaceObjective, manipulability_weight: float = 1.0, joint_limit_weight: float = 1.0) -> None:
+        """
+              Select what the nullspace term drives the joints towards.
+              `POSTURE` (default) pulls towards the nullspace joint positions of
+              :py:meth:`set_control`. `MANIPULABILITY` follows the analytic
+              gradient of the weighted sum of the log-manipulability and the
+              normalized distance to the joint limits, computed from the
+              Jacobian each tick, to keep the arm away from singularities
+              during long Cartesian motions. The nullspace stiffness scales the
+              gradient in both cases.
+    
+              Args:
+                objective: :py:class:`NullspaceObjective` to follow.
+                manipulability_weight: Weight of the log-manipulability.
+                joint_limit_weight: Weight of the joint-limit distance.
+        """
     def set_nullspace_stiffness(self, nullspace_stiffness: float) -> None:
         ...
+    def set_singularity_damping(self, manipulability_threshold: float = 0.05, max_damping: float = 0.2) -> None:
+        """
+              Configure the damping of the nullspace projection close to
+              singularities. Below the manipulability threshold the damping
+              grows linearly up to `max_damping` at the singularity, so the
+              projection doesn't swing the joints where the Jacobian is
+              ill-conditioned. Above it, the projection is exact and the
+              nullspace term doesn't disturb the task. Enabled by default.
+    
+              Args:
+                manipulability_threshold: Manipulability sqrt(det(J J^T)) below
+                  which damping is applied, zero disables it.
+                max_damping: Damping at an exact singularity.
+        """
+    @property
+    def setpoint(self) -> SetpointBuffer:
+        """
+                  :py:class:`SetpointBuffer` holding position, orientation quaternion
+                  (scalar last) and nullspace joint positions (14 values). Initialized
+                  with the current pose when the controller is started.
+        """
 class CartesianMotion:
     acceleration_rel: float
     jerk_rel: float
@@ -78,10 +121,32 @@ class CartesianMotionGenerator(Generator):
         ...
     def add_waypoint(self, waypoint: CartesianMotion) -> None:
         ...
+    @typing.overload
     def add_waypoints(self, waypoints: list[CartesianMotion]) -> None:
         ...
+    @typing.overload
+    def add_waypoints(self, poses: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], velocity_rel: typing.Any = None, acceleration_rel: typing.Any = None, jerk_rel: typing.Any = None, reference_frame: ReferenceFrame = ...) -> None:
+        """
+                      Append waypoints from an array in one pass, without creating
+                      :py:class:`CartesianMotion` objects.
+        
+                      Args:
+                        poses: Homogeneous transforms of shape (N, 4, 4) or positions
+                          followed by quaternions (x, y, z, w) of shape (N, 7).
+                        velocity_rel: Velocity scale, a scalar or one per waypoint.
+                        acceleration_rel: Acceleration scale, a scalar or one per
+                          waypoint.
+                        jerk_rel: Jerk scale, a scalar or one per waypoint.
+                        reference_frame: Frame the poses are expressed in.
+        """
     def clear_waypoints(self) -> None:
         ...
+    @property
+    def speed_scale(self) -> float:
+        """
+                  Current scale of the Cartesian velocity limits. Lowered where the
+                  profile would exceed the joint limits, e.g. close to singularities.
+        """
 class CartesianTrajectory:
     @staticmethod
     def _pybind11_conduit_v1_(*args, **kwargs):
@@ -92,6 +157,25 @@ class CartesianTrajectory:
     @typing.overload
     def __init__(self, poses: list[numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0) -> None:
         ...
+    @staticmethod
+    @typing.overload
+    def compute_async(positions: list[numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]]], orientations: list[numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0, priority: TaskPriority = ...) -> CartesianTrajectoryFuture:
+        """
+                      Compute the trajectory in the background on the shared thread
+                      pool. Takes the same arguments as the constructor.
+        
+                      Args:
+                        priority: Scheduling priority among pending computations.
+        
+                      Returns:
+                        :py:class:`CartesianTrajectoryFuture` holding the trajectory.
+        """
+    @staticmethod
+    @typing.overload
+    def compute_async(poses: list[numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0, priority: TaskPriority = ...) -> CartesianTrajectoryFuture:
+        ...
+    def compile(self) -> None:
+        ...
     def get_duration(self) -> float:
         ...
     def get_orientation(self, time: float) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]]:
@@ -100,6 +184,171 @@ class CartesianTrajectory:
         ...
     def get_position(self, time: float) -> numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]]:
         ...
+    @property
+    def compiled(self) -> bool:
+        ...
+class CartesianTrajectoryFollower(TorqueController):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, trajectory: CartesianTrajectory, q_nullspace: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., impedance: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[6]], numpy.dtype[numpy.float64]] = ..., damping_ratio: float = 1.0, nullspace_stiffness: float = 15.0, dq_threshold: float = 0.001, time_offset: float = 0.0, preview: float = 0.0) -> None:
+        """
+                       Follows a :py:class:`CartesianTrajectory` with a Cartesian impedance
+                       law. Pose, twist and twist derivative are evaluated once per tick
+                       from the compiled trajectory and fed to the tracking law directly,
+                       the reference twist is used as damping target.
+        
+                       Args:
+                         trajectory: Trajectory to follow, compiled when the controller starts.
+                         q_nullspace: Nullspace joint positions.
+                         impedance: Cartesian impedance expressed as a matrix
+                           :math:`\in \mathbb{R}^{6\times 6}`.
+                         damping_ratio: Cartesian damping is computed based on the given
+                           impedance and damping ratio.
+                         nullspace_stiffness: Control gain of the nullspace term.
+                         dq_threshold: Joint velocity below which the robot is considered
+                           at rest after the trajectory ended.
+                         time_offset: Shift of the trajectory time, a negative offset
+                           delays the start.
+                         preview: Look-ahead of the reference in seconds.
+        """
+    def get_duration(self) -> float:
+        ...
+    @property
+    def preview(self) -> float:
+        ...
+    @preview.setter
+    def preview(self, arg1: float) -> None:
+        ...
+    @property
+    def time_offset(self) -> float:
+        ...
+    @time_offset.setter
+    def time_offset(self, arg1: float) -> None:
+        ...
+    @property
+    def time_scaling(self) -> TimeScaling:
+        ...
+    @time_scaling.setter
+    def time_scaling(self, arg1: TimeScaling) -> None:
+        ...
+class CartesianTrajectoryFuture:
+    """
+    
+              Trajectory computed in the background, see `compute_async`. Can be
+              awaited from asyncio and trio coroutines.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __await__(self) -> typing.Generator[typing.Any, None, CartesianTrajectory]:
+        ...
+    def add_done_callback(self, callback: typing.Callable[[], None]) -> None:
+        """
+                       Call `callback` without arguments once done, right away if the
+                       future is already done. Runs on a background thread.
+        """
+    def cancel(self) -> bool:
+        """
+                       Cancel the computation. Pending computations are skipped,
+                       running ones complete but their result is discarded. Returns
+                       False if the computation has already finished.
+        """
+    def cancelled(self) -> bool:
+        ...
+    def done(self) -> bool:
+        ...
+    def result(self, timeout: float = -1.0) -> CartesianTrajectory:
+        """
+                       Wait for the trajectory and return it. Raises the error of a
+                       failed computation, or if the computation was cancelled or
+                       `timeout` seconds passed. A negative timeout waits
+                       indefinitely.
+        """
+    def running(self) -> bool:
+        ...
+    def wait(self, timeout: float = -1.0) -> bool:
+        """
+                       Wait until done, returns whether the future is done.
+        """
+class CartesianVelocityStreamGenerator(Generator):
+    """
+    
+              Streams end-effector twists in the base frame on the Cartesian
+              velocity interface, translational followed by angular velocity.
+              Limited and guarded by a timeout like
+              :py:class:`JointVelocityStreamGenerator`, except that the
+              translational and angular velocity are limited by their norms.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, timeout: float = 0.1, velocity_rel: float = 1.0, acceleration_rel: float = 1.0, jerk_rel: float = 1.0, done_callback: typing.Callable[[], None] = None) -> None:
+        ...
+    def set_twist(self, twist: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        """
+                  Command an end-effector twist, picked up at the next control tick.
+        """
+    @property
+    def command(self) -> SetpointBuffer:
+        """
+                  :py:class:`SetpointBuffer` holding the commanded twist,
+                  write into its array and commit to avoid copies.
+        """
+    @property
+    def timed_out(self) -> bool:
+        """
+                  Whether the last command is older than the timeout.
+        """
+class CycleTimeBenchmark:
+    """
+              Compares the cycle time of motion strategies offline. Each run
+              moves from the first waypoint through the others at 1 kHz and
+              faster than real time: :py:class:`JointTrajectory` is sampled,
+              generators are stepped like on a connected :py:class:`Panda` with
+              their commands echoed back as robot state. Cartesian motions are
+              mapped to joint positions by inverse kinematics holding joint 7,
+              which approximates the elbow held by the robot. Joint torques are
+              computed by the rigid-body model used by :py:func:`rollout`, which
+              also provides the Jacobian the Cartesian generator scales its
+              limits with. See :py:mod:`panda_py.benchmark` for the suite of
+              representative paths.
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, speed_factor: float = 1.0, max_deviation: float = 0.0, velocity_rel: float = 1.0, acceleration_rel: float = 1.0, jerk_rel: float = 1.0, timeout: float = 60.0, load_mass: float = ..., load_com: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., load_inertia: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[3]], numpy.dtype[numpy.float64]] = ..., F_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]] = ...) -> None:
+        """
+                  Args:
+                    speed_factor: Speed factor of the joint trajectory, scales the
+                  joint limits like `velocity_rel` for the generators.
+                    max_deviation: Blending deviation of the joint trajectory.
+                    velocity_rel: Relative velocity of the generators.
+                    acceleration_rel: Relative acceleration of the generators.
+                    jerk_rel: Relative jerk of the generators.
+                    timeout: Generators still moving after this many seconds
+                      fail.
+                    load_mass: Mass of the load at the flange, end effector
+                      included, defaults to the Franka Hand.
+                    load_com: Center of mass of the load in the flange frame.
+                    load_inertia: Inertia of the load about its center of mass.
+                    F_T_EE: Transform from the flange to the end effector that
+                      Cartesian waypoints refer to.
+        """
+    def run(self, waypoints: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], strategy: MotionStrategy) -> dict:
+        """
+                  Move through joint waypoints (N x 7) with `strategy`, starting
+                  at rest at the first one.
+    
+                  Returns:
+                    Dictionary with the motion duration, planning_time before
+                    the first command and max_tick_time of later commands in
+                    seconds, the per-joint peak_velocity and peak_torque, their
+                    velocity_utilization and torque_utilization, i.e. the
+                    largest ratio to the joint limits, failed and error.
+        """
 class Force(TorqueController):
     @staticmethod
     def _pybind11_conduit_v1_(*args, **kwargs):
@@ -123,6 +372,105 @@ class Generator:
         ...
     def set_done_callback(self, done_callback: typing.Callable[[], None]) -> None:
         ...
+class HybridForceImpedance(TorqueController):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, impedance: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[6]], numpy.dtype[numpy.float64]] = ..., damping_ratio: float = 1.0, nullspace_stiffness: float = 0.5, k_p: float = 0.5, k_i: float = 5.0, force_damping: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., filter_coeff: float = 1.0) -> None:
+        """
+                       Hybrid force/impedance controller. The selection vector assigns
+                       each task space axis (base frame) to force control (1) or
+                       impedance control (0), intermediate values blend both. Force
+                       axes use feedforward plus PI control on the wrench estimated from
+                       joint torques, impedance axes behave like :py:class:`CartesianImpedance`.
+        
+                       Args:
+                         impedance: Cartesian impedance expressed as a matrix
+                           :math:`\in \mathbb{R}^{6\times 6}`.
+                         damping_ratio: Cartesian damping is computed based on the given
+                           impedance and damping ratio.
+                         nullspace_stiffness: Control gain of the nullspace term.
+                         k_p: Proportional gain of the wrench error.
+                         k_i: Integral gain of the wrench error.
+                         force_damping: Task space damping along force controlled axes.
+                         filter_coeff: TP1 filter coefficient used to filter input signals.
+                           The selection vector ramps linearly instead, see
+                           :py:meth:`set_selection_ramp_time`.
+        """
+    def set_contact_transition(self, selection: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]], force: float) -> None:
+        """
+                  Arm a transition to `selection` that is taken inside the control
+                  loop once the measured force along its translational axes exceeds
+                  `force`. A non-positive force disarms the transition.
+        """
+    def set_control(self, position: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]], orientation: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]], wrench: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]], q_nullspace: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ...) -> None:
+        """
+                  Set the pose for impedance controlled axes and the wrench exerted
+                  along force controlled axes.
+        """
+    def set_damping_ratio(self, damping_ratio: float) -> None:
+        ...
+    def set_displacement_limit(self, distance: float) -> None:
+        """
+                  Fall back to impedance control at the current pose if the
+                  end-effector moves further than `distance` along force controlled
+                  axes, e.g. when contact is lost. Zero disables the limit.
+        """
+    def set_feedforward(self, wrench: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        """
+                  Wrench added on all axes, e.g. to compensate a tool.
+        """
+    def set_filter(self, filter_coeff: float) -> None:
+        ...
+    def set_force_damping(self, force_damping: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_force_gains(self, k_p: float, k_i: float) -> None:
+        ...
+    def set_impedance(self, impedance: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[6]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_integral_limit(self, limit: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_nullspace_stiffness(self, nullspace_stiffness: float) -> None:
+        ...
+    def set_selection(self, selection: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_selection_ramp_time(self, duration: float) -> None:
+        """
+                  Time in seconds the selection takes to ramp from impedance (0) to
+                  force control (1), independent of the filter coefficient. Zero
+                  switches immediately.
+        """
+    def set_singularity_damping(self, manipulability_threshold: float = 0.05, max_damping: float = 0.2) -> None:
+        """
+                  Configure the damping of the wrench estimate and the nullspace
+                  projection close to singularities. Below the manipulability
+                  threshold the damping grows linearly up to `max_damping` at the
+                  singularity, so the estimated wrench and with it the force loop
+                  stay bounded where the Jacobian is ill-conditioned, at the cost of
+                  underestimating wrenches along the weak directions. Above it, both
+                  are exact. Enabled by default.
+    
+                  Args:
+                    manipulability_threshold: Manipulability sqrt(det(J J^T)) below
+                      which damping is applied, zero disables it.
+                    max_damping: Damping at an exact singularity.
+        """
+    def set_wrench_limit(self, limit: numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    @property
+    def in_contact(self) -> bool:
+        ...
+    @property
+    def limit_exceeded(self) -> bool:
+        ...
+    @property
+    def selection(self) -> numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    @property
+    def wrench(self) -> numpy.ndarray[tuple[typing.Literal[6], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        """
+                  Wrench exerted by the end-effector, estimated from joint torques.
+        """
 class IntegratedVelocity(TorqueController):
     @staticmethod
     def _pybind11_conduit_v1_(*args, **kwargs):
@@ -131,74 +479,519 @@ class IntegratedVelocity(TorqueController):
         ...
     def get_qd(self) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
         ...
-    def set_control(self, velocity: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+    def set_control(self, velocity: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_damping(self, damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_stiffness(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+class JerkLimitedTrajectory:
+    """
+    
+              Jerk-limited version of a joint trajectory for execution on the
+              joint position interface, see :py:class:`JointTrajectoryGenerator`.
+              Unblended waypoints become stops and acceleration jumps become jerk
+              ramps, roughly acceleration over jerk long. The result is a quintic
+              spline that respects the velocity, acceleration and jerk limits. The
+              trajectory is only slowed down if it would otherwise leave the limits
+              or deviate from its path by more than `max_deviation`.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, trajectory: JointTrajectory, max_jerk: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., max_deviation: float = 0.001, knot_spacing: float = 0.01) -> None:
+        ...
+    def get_duration(self) -> float:
+        ...
+    def get_joint_accelerations(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def get_joint_positions(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def get_joint_velocities(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def sample(self, times: numpy.ndarray[tuple[M, typing.Literal[1]], numpy.dtype[numpy.float64]]) -> tuple[numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]], numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]], numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]]]:
+        ...
+    @property
+    def deviation(self) -> float:
+        """
+                       Largest position deviation from the path of the time-optimal
+                       trajectory.
+        """
+    @property
+    def time_scale(self) -> float:
+        """
+                       Factor by which the trajectory was slowed down, 1 if it wasn't.
+        """
+class JointMotion:
+    acceleration_rel: float
+    jerk_rel: float
+    velocity_rel: float
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, target: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]) -> None:
+        ...
+    @property
+    def target(self) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+class JointMotionGenerator(Generator):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, keep_running: bool = False, done_callback: typing.Callable[[], None] = None) -> None:
+        ...
+    def add_waypoint(self, waypoint: JointMotion) -> None:
+        ...
+    @typing.overload
+    def add_waypoints(self, waypoints: list[JointMotion]) -> None:
+        ...
+    @typing.overload
+    def add_waypoints(self, targets: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], velocity_rel: typing.Any = None, acceleration_rel: typing.Any = None, jerk_rel: typing.Any = None) -> None:
+        """
+                      Append waypoints from an array in one pass, without creating
+                      :py:class:`JointMotion` objects.
+        
+                      Args:
+                        targets: Joint positions of shape (N, 7).
+                        velocity_rel: Velocity scale, a scalar or one per waypoint.
+                        acceleration_rel: Acceleration scale, a scalar or one per
+                          waypoint.
+                        jerk_rel: Jerk scale, a scalar or one per waypoint.
+        """
+    def clear_waypoints(self) -> None:
+        ...
+class JointPosition(TorqueController):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., filter_coeff: float = 1.0) -> None:
+        ...
+    def set_control(self, position: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]], velocity: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ...) -> None:
+        ...
+    def set_damping(self, damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    def set_filter(self, filter_coeff: float) -> None:
+        ...
+    def set_stiffness(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        ...
+    @property
+    def setpoint(self) -> SetpointBuffer:
+        """
+                  :py:class:`SetpointBuffer` holding joint positions followed by joint
+                  velocities (14 values). Initialized with the current configuration
+                  when the controller is started.
+        """
+class JointTrajectory:
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, waypoints: list[numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0) -> None:
+        ...
+    @staticmethod
+    def compute_async(waypoints: list[numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0, priority: TaskPriority = ...) -> JointTrajectoryFuture:
+        """
+                      Compute the trajectory in the background on the shared thread
+                      pool. Takes the same arguments as the constructor.
+        
+                      Args:
+                        priority: Scheduling priority among pending computations.
+        
+                      Returns:
+                        :py:class:`JointTrajectoryFuture` holding the trajectory.
+        """
+    def compile(self) -> None:
+        """
+                       Convert the trajectory into contiguous piecewise-polynomial
+                       form, used by :py:meth:`sample` and the trajectory followers to
+                       evaluate position, velocity and acceleration in a single pass
+                       without walking the path. The compiled form interpolates the
+                       integration steps of the time-optimal trajectory, so its
+                       velocities and accelerations differ slightly from the
+                       `get_joint_*` methods, which always evaluate the trajectory itself.
+        """
+    def get_duration(self) -> float:
+        ...
+    def get_joint_accelerations(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def get_joint_positions(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def get_joint_velocities(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def sample(self, times: numpy.ndarray[tuple[M, typing.Literal[1]], numpy.dtype[numpy.float64]]) -> tuple[numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]], numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]], numpy.ndarray[tuple[M, typing.Literal[7]], numpy.dtype[numpy.float64]]]:
+        """
+                       Evaluate the trajectory at many points in time. Compiles the
+                       trajectory on first use.
+        
+                       Args:
+                         times: Vector of shape (N,) holding the sample times.
+        
+                       Returns:
+                         Tuple of joint positions, velocities and accelerations,
+                         each of shape (N, 7).
+        """
+    @property
+    def compiled(self) -> bool:
+        ...
+class JointTrajectoryFollower(TorqueController):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, trajectory: JointTrajectory, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., feedforward: bool = False, dq_threshold: float = 0.001, time_offset: float = 0.0, preview: float = 0.0) -> None:
+        """
+                       Follows a :py:class:`JointTrajectory` with a joint impedance law.
+                       Position, velocity and acceleration are evaluated once per tick
+                       from the compiled trajectory and fed to the tracking law directly.
+        
+                       Args:
+                         trajectory: Trajectory to follow, compiled when the controller starts.
+                         stiffness: Joint stiffness.
+                         damping: Joint damping, applied to the velocity tracking error.
+                         feedforward: Add inverse dynamics feedforward of the reference
+                           acceleration.
+                         dq_threshold: Joint velocity below which the robot is considered
+                           at rest after the trajectory ended.
+                         time_offset: Shift of the trajectory time, a negative offset
+                           delays the start.
+                         preview: Look-ahead of the reference in seconds.
+        """
+    def get_duration(self) -> float:
+        ...
+    def queue(self, trajectory: JointTrajectory) -> float:
+        """
+                       Blend `trajectory` into the end of the motion without coming to
+                       rest or restarting the controller. The trajectory has to start
+                       where the queued motion ends. The blend window is the longest
+                       overlap that keeps the joint velocities and accelerations within
+                       the peaks of either trajectory. Trajectories queued while the
+                       controller runs blend no earlier than 50 ms from now, segments
+                       that were already executed are dropped. Once the controller
+                       finished, the trajectory replaces the executed motion and runs
+                       on the next start.
+        
+                       Args:
+                         trajectory: Trajectory to append.
+        
+                       Returns:
+                         Duration of the blend window in seconds.
+        """
+    @property
+    def preview(self) -> float:
+        ...
+    @preview.setter
+    def preview(self, arg1: float) -> None:
+        ...
+    @property
+    def time_offset(self) -> float:
+        ...
+    @time_offset.setter
+    def time_offset(self, arg1: float) -> None:
+        ...
+    @property
+    def time_scaling(self) -> TimeScaling:
+        ...
+    @time_scaling.setter
+    def time_scaling(self, arg1: TimeScaling) -> None:
+        ...
+class JointTrajectoryFuture:
+    """
+    
+              Trajectory computed in the background, see `compute_async`. Can be
+              awaited from asyncio and trio coroutines.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __await__(self) -> typing.Generator[typing.Any, None, JointTrajectory]:
+        ...
+    def add_done_callback(self, callback: typing.Callable[[], None]) -> None:
+        """
+                       Call `callback` without arguments once done, right away if the
+                       future is already done. Runs on a background thread.
+        """
+    def cancel(self) -> bool:
+        """
+                       Cancel the computation. Pending computations are skipped,
+                       running ones complete but their result is discarded. Returns
+                       False if the computation has already finished.
+        """
+    def cancelled(self) -> bool:
+        ...
+    def done(self) -> bool:
+        ...
+    def result(self, timeout: float = -1.0) -> JointTrajectory:
+        """
+                       Wait for the trajectory and return it. Raises the error of a
+                       failed computation, or if the computation was cancelled or
+                       `timeout` seconds passed. A negative timeout waits
+                       indefinitely.
+        """
+    def running(self) -> bool:
+        ...
+    def wait(self, timeout: float = -1.0) -> bool:
+        """
+                       Wait until done, returns whether the future is done.
+        """
+class JointTrajectoryGenerator(Generator):
+    """
+    
+              Executes a :py:class:`JerkLimitedTrajectory` on the joint position
+              interface. The trajectory has to start at the current joint
+              positions.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, trajectory: JerkLimitedTrajectory, done_callback: typing.Callable[[], None] = None) -> None:
+        ...
+class JointTrajectoryMPC(TorqueController):
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, trajectory: JointTrajectory, block_duration: float = 0.01, position_weight: float = 1.0, velocity_weight: float = 0.001, acceleration_weight: float = 1e-08, max_iterations: int = 50, torque_margin: float = 0.9, dq_threshold: float = 0.001) -> None:
+        """
+                       Follows a :py:class:`JointTrajectory` with linear model-predictive
+                       control. Each tick the arm is linearized at the current state and
+                       the joint accelerations over a horizon of 5 blocks are optimized
+                       such that the previewed reference is tracked while the joint
+                       torque and torque rate limits are respected. The QP has a fixed
+                       size and is solved with a warm-started ADMM iteration. Compared to
+                       :py:class:`JointTrajectoryFollower` this anticipates the
+                       reference and degrades gracefully when it demands more torque
+                       than available.
+        
+                       Args:
+                         trajectory: Trajectory to follow, compiled when the controller starts.
+                         block_duration: Duration of each horizon block in seconds.
+                         position_weight: Weight of the position tracking error.
+                         velocity_weight: Weight of the velocity tracking error.
+                         acceleration_weight: Weight of the deviation from the reference
+                           acceleration, regularizes the torques.
+                         max_iterations: Maximum number of ADMM iterations per tick.
+                         torque_margin: Fraction of the joint torque limits available to
+                           the controller.
+                         dq_threshold: Joint velocity below which the robot is considered
+                           at rest after the trajectory ended.
+        """
+    def get_solve_stats(self) -> dict:
+        """
+                      Get the number of solves, how many of them stopped at the
+                      iteration limit, solve time statistics in seconds and the mean
+                      number of iterations. Percentiles are resolved to 10 µs.
+        """
+    def reset_solve_stats(self) -> None:
+        ...
+class JointVelocityStreamGenerator(Generator):
+    """
+    
+              Streams joint velocity commands on the joint velocity interface,
+              e.g. for teleoperation. The latest command is tracked within the
+              velocity, acceleration and jerk limits. If no new command arrives
+              within `timeout` seconds, the robot decelerates to rest and waits
+              for the next command.
+          
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, timeout: float = 0.1, velocity_rel: float = 1.0, acceleration_rel: float = 1.0, jerk_rel: float = 1.0, done_callback: typing.Callable[[], None] = None) -> None:
+        ...
+    def set_velocity(self, velocity: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+        """
+                  Command joint velocities, picked up at the next control tick.
+        """
+    @property
+    def command(self) -> SetpointBuffer:
+        """
+                  :py:class:`SetpointBuffer` holding the commanded joint velocities,
+                  write into its array and commit to avoid copies.
+        """
+    @property
+    def timed_out(self) -> bool:
+        """
+                  Whether the last command is older than the timeout.
+        """
+class Kinematics:
+    """
+              Forward and inverse kinematics for a tool mounted on the flange.
+              The tool transform is folded into the analytical solutions once,
+              so the methods cost about the same as :py:func:`fk` and
+              :py:func:`ik` for the Franka Hand. Pass it to
+              :py:meth:`Panda.set_kinematics` to make the tool the robot's end
+              effector for controllers and generators.
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, F_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]] = ...) -> None:
+        """
+                  Args:
+                    F_T_EE: Homogeneous transform from the flange to the tool
+                      frame, defaults to the Franka Hand.
+        """
+    def fk(self, q: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]]:
+        """
+                  Pose of the tool frame in the base frame.
+        """
+    def fk_batch(self, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], priority: TaskPriority = ...) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Tool poses (N x 4 x 4) for each row of `q` (N x 7), computed on
+                  the process-wide thread pool without holding the GIL.
+        """
+    @typing.overload
+    def ik(self, O_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q_7: float = 0.7853981633974483) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        """
+                  Joint positions placing the tool frame at `O_T_EE`, see
+                  :py:func:`ik`.
+        """
+    @typing.overload
+    def ik(self, position: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]], orientation: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q_7: float = 0.7853981633974483) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def ik_batch(self, O_T_EE: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], q_init: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]] = ..., q_7: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]] = 0.7853981633974483, priority: TaskPriority = ...) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Joint positions (N x 7) placing the tool frame at each pose
+                  (N x 4 x 4), computed on the process-wide thread pool without
+                  holding the GIL. Rows without solution are NaN.
+    
+                  Args:
+                    O_T_EE: Tool poses.
+                    q_init: Reference configuration, one for all poses (7,) or
+                      one per pose (N x 7).
+                    q_7: Position of joint 7, a scalar or one per pose.
+                    priority: Priority of the computation on the thread pool.
+        """
+    def ik_full(self, O_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q_7: float = 0.7853981633974483) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[7]], numpy.dtype[numpy.float64]]:
+        """
+                  All four solutions placing the tool frame at `O_T_EE`, see
+                  :py:func:`ik_full`.
+        """
+    def ik_path(self, O_T_EE: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q7_resolution: float = 0.1, max_q7_step: float = 0.2, max_joint_step: float = 0.5, limit_margin: float = 0.05, limit_weight: float = 1.0, refinement_iterations: int = 10, priority: TaskPriority = ...) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Joint path (N x 7) through a densely sampled Cartesian path
+                  (N x 4 x 4) with the position of joint 7 chosen along the
+                  whole path, rather than fixed per pose like in
+                  :py:meth:`ik_batch`. Solutions are evaluated on a grid of q7
+                  values for all poses on the process-wide thread pool, dynamic
+                  programming selects the q7 profile that best trades the
+                  distance from the center of the joint ranges against
+                  smoothness, and Gauss-Newton iterations refine it between
+                  the grid values. Runs without holding the GIL.
+    
+                  Args:
+                    O_T_EE: Tool poses along the path.
+                    q_init: Reference configuration selecting the solution
+                      branch, the first solution is pulled towards it.
+                    q7_resolution: Spacing of the q7 grid.
+                    max_q7_step: Largest change of q7 between poses.
+                    max_joint_step: Largest change of any joint between poses.
+                    limit_margin: Distance all joints keep from their limits.
+                    limit_weight: Weight of the distance from the center of the
+                      joint ranges against smoothness.
+                    refinement_iterations: Gauss-Newton iterations.
+                    priority: Priority of the computation on the thread pool.
+    
+                  Raises:
+                    RuntimeError: If no path within the limits reaches all
+                      poses.
+        """
+    @property
+    def F_T_EE(self) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]]:
+        ...
+class MotionData:
+    acceleration_rel: float
+    jerk_rel: float
+    velocity_rel: float
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, velocity: float = 1.0, acceleration: float = 1.0, jerk: float = 1.0) -> None:
+        ...
+    def with_max_dynamics(self) -> MotionData:
+        ...
+class MotionStrategy:
+    """
+    Members:
+    
+      JOINT_TRAJECTORY
+    
+      JOINT_MOTION_GENERATOR
+    
+      CARTESIAN_MOTION_GENERATOR
+    """
+    CARTESIAN_MOTION_GENERATOR: typing.ClassVar[MotionStrategy]  # value = <MotionStrategy.CARTESIAN_MOTION_GENERATOR: 2>
+    JOINT_MOTION_GENERATOR: typing.ClassVar[MotionStrategy]  # value = <MotionStrategy.JOINT_MOTION_GENERATOR: 1>
+    JOINT_TRAJECTORY: typing.ClassVar[MotionStrategy]  # value = <MotionStrategy.JOINT_TRAJECTORY: 0>
+    __members__: typing.ClassVar[dict[str, MotionStrategy]]  # value = {'JOINT_TRAJECTORY': <MotionStrategy.JOINT_TRAJECTORY: 0>, 'JOINT_MOTION_GENERATOR': <MotionStrategy.JOINT_MOTION_GENERATOR: 1>, 'CARTESIAN_MOTION_GENERATOR': <MotionStrategy.CARTESIAN_MOTION_GENERATOR: 2>}
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
         ...
-    def set_damping(self, damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+    def __hash__(self) -> int:
         ...
-    def set_stiffness(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+    def __index__(self) -> int:
         ...
-class JointMotion:
-    acceleration_rel: float
-    jerk_rel: float
-    velocity_rel: float
-    @staticmethod
-    def _pybind11_conduit_v1_(*args, **kwargs):
+    def __init__(self, value: int) -> None:
         ...
-    def __init__(self, target: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]) -> None:
+    def __int__(self) -> int:
         ...
-    @property
-    def target(self) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+    def __ne__(self, other: typing.Any) -> bool:
         ...
-class JointMotionGenerator(Generator):
-    @staticmethod
-    def _pybind11_conduit_v1_(*args, **kwargs):
+    def __repr__(self) -> str:
         ...
-    def __init__(self, keep_running: bool = False, done_callback: typing.Callable[[], None] = None) -> None:
+    def __setstate__(self, state: int) -> None:
         ...
-    def add_waypoint(self, waypoint: JointMotion) -> None:
+    def __str__(self) -> str:
         ...
-    def add_waypoints(self, waypoints: list[JointMotion]) -> None:
+    @property
+    def name(self) -> str:
         ...
-    def clear_waypoints(self) -> None:
+    @property
+    def value(self) -> int:
         ...
-class JointPosition(TorqueController):
+class NullspaceObjective:
+    """
+    Members:
+    
+      POSTURE
+    
+      MANIPULABILITY
+    """
+    MANIPULABILITY: typing.ClassVar[NullspaceObjective]  # value = <NullspaceObjective.MANIPULABILITY: 1>
+    POSTURE: typing.ClassVar[NullspaceObjective]  # value = <NullspaceObjective.POSTURE: 0>
+    __members__: typing.ClassVar[dict[str, NullspaceObjective]]  # value = {'POSTURE': <NullspaceObjective.POSTURE: 0>, 'MANIPULABILITY': <NullspaceObjective.MANIPULABILITY: 1>}
     @staticmethod
     def _pybind11_conduit_v1_(*args, **kwargs):
         ...
-    def __init__(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., filter_coeff: float = 1.0) -> None:
-        ...
-    def set_control(self, position: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]], velocity: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ...) -> None:
-        ...
-    def set_damping(self, damping: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+    def __eq__(self, other: typing.Any) -> bool:
         ...
-    def set_filter(self, filter_coeff: float) -> None:
+    def __getstate__(self) -> int:
         ...
-    def set_stiffness(self, stiffness: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> None:
+    def __hash__(self) -> int:
         ...
-class JointTrajectory:
-    @staticmethod
-    def _pybind11_conduit_v1_(*args, **kwargs):
+    def __index__(self) -> int:
         ...
-    def __init__(self, waypoints: list[numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]], speed_factor: float = 0.2, max_deviation: float = 0, timeout: float = 30.0) -> None:
+    def __init__(self, value: int) -> None:
         ...
-    def get_duration(self) -> float:
+    def __int__(self) -> int:
         ...
-    def get_joint_accelerations(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+    def __ne__(self, other: typing.Any) -> bool:
         ...
-    def get_joint_positions(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+    def __repr__(self) -> str:
         ...
-    def get_joint_velocities(self, time: float) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
+    def __setstate__(self, state: int) -> None:
         ...
-class MotionData:
-    acceleration_rel: float
-    jerk_rel: float
-    velocity_rel: float
-    @staticmethod
-    def _pybind11_conduit_v1_(*args, **kwargs):
+    def __str__(self) -> str:
         ...
-    def __init__(self, velocity: float = 1.0, acceleration: float = 1.0, jerk: float = 1.0) -> None:
+    @property
+    def name(self) -> str:
         ...
-    def with_max_dynamics(self) -> MotionData:
+    @property
+    def value(self) -> int:
         ...
 class Panda:
     """
@@ -214,14 +1007,33 @@ class Panda:
         ...
     def __init__(self, hostname: str, name: str = 'panda', realtime_config: panda_py.libfranka.RealtimeConfig = panda_py.libfranka.RealtimeConfig.kIgnore) -> None:
         ...
-    def create_context(self, frequency: float, max_runtime: float = 0.0, max_iter: int = 0) -> PandaContext:
-        ...
+    def create_context(self, frequency: float, max_runtime: float = 0.0, max_iter: int = 0, block_size: int = 0) -> PandaContext:
+        """
+                  Create a context to run a control loop at the given frequency.
+                  With a positive `block_size` the context runs in tick-group mode:
+                  :py:meth:`PandaContext.ok` blocks until the control thread has
+                  collected the next `block_size` states, which are retrieved with
+                  :py:meth:`PandaContext.get_states`, and the frequency is ignored.
+                  Setpoints for the following ticks are provided as a block with
+                  :py:meth:`PandaContext.set_setpoints`. A controller must be running
+                  before the loop is entered.
+        """
     def disable_logging(self) -> None:
         ...
     def enable_logging(self, buffer_size: int) -> None:
         ...
     def get_log(self) -> dict[str, list[numpy.ndarray[tuple[M, typing.Literal[1]], numpy.dtype[numpy.float64]]]]:
         ...
+    def get_connection_timing(self) -> dict:
+        """
+                  Durations in seconds of the steps taken to connect to the robot,
+                  and where the model was loaded from (robot or memory).
+        """
+    def get_kinematics(self) -> Kinematics:
+        """
+                  Kinematics of the current end effector, the Franka Hand unless
+                  set with :py:meth:`set_kinematics`.
+        """
     def get_model(self) -> panda_py.libfranka.Model:
         ...
     def get_orientation(self, scalar_first: bool = False) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]]:
@@ -264,6 +1076,14 @@ class Panda:
         ...
     def set_default_behavior(self) -> None:
         ...
+    def set_kinematics(self, kinematics: Kinematics) -> None:
+        """
+                  Use the tool frame of `kinematics` as the robot's end effector.
+                  The robot then reports `O_T_EE` and the end-effector Jacobian for
+                  the tool, so Cartesian controllers and generators act on it
+                  without additional cost in the control loop. The robot must not
+                  be moving.
+        """
     def start_controller(self, controller: TorqueController) -> None:
         ...
     def start_generator(self, generator: ...) -> None:
@@ -290,8 +1110,36 @@ class PandaContext:
         ...
     def __exit__(self, arg0: typing.Any, arg1: typing.Any, arg2: typing.Any) -> bool:
         ...
+    def get_states(self) -> dict[str, numpy.ndarray[tuple[M, N], numpy.dtype[numpy.float64]]]:
+        """
+                  States of the last block received with :py:meth:`ok`. Returns a
+                  dictionary of arrays with one row per control tick, i.e.
+                  q, dq, tau_J, tau_ext_hat_filtered (K x 7), O_T_EE (K x 16,
+                  column-major), O_F_ext_hat_K (K x 6) and time (K x 1).
+        """
     def ok(self) -> bool:
         ...
+    def set_setpoints(self, setpoints: numpy.ndarray[tuple[M, N], numpy.dtype[numpy.float64]]) -> None:
+        """
+                  Provide a block of future setpoints for the active controller.
+                  The control thread applies one row per tick starting with the next
+                  tick and holds the last row if no new block arrives in time.
+                  :py:class:`JointPosition` takes joint positions, optionally
+                  followed by joint velocities (7 or 14 columns).
+                  :py:class:`CartesianImpedance` takes position and orientation
+                  quaternion (scalar last), optionally followed by nullspace joint
+                  positions (7 or 14 columns).
+                  :py:class:`Force` takes the desired force (3 columns).
+        """
+    @property
+    def block_size(self) -> int:
+        ...
+    @property
+    def num_dropped_blocks(self) -> int:
+        """
+                  Number of state blocks that were published but superseded before
+                  :py:meth:`ok` picked them up.
+        """
     @property
     def num_ticks(self) -> int:
         ...
@@ -338,6 +1186,222 @@ class ReferenceFrame:
     @property
     def value(self) -> int:
         ...
+class RolloutObjective:
+    """
+    Members:
+    
+      JOINT_POSITION
+    
+      CARTESIAN_POSITION
+    
+      FORCE
+    """
+    CARTESIAN_POSITION: typing.ClassVar[RolloutObjective]  # value = <RolloutObjective.CARTESIAN_POSITION: 1>
+    FORCE: typing.ClassVar[RolloutObjective]  # value = <RolloutObjective.FORCE: 2>
+    JOINT_POSITION: typing.ClassVar[RolloutObjective]  # value = <RolloutObjective.JOINT_POSITION: 0>
+    __members__: typing.ClassVar[dict[str, RolloutObjective]]  # value = {'JOINT_POSITION': <RolloutObjective.JOINT_POSITION: 0>, 'CARTESIAN_POSITION': <RolloutObjective.CARTESIAN_POSITION: 1>, 'FORCE': <RolloutObjective.FORCE: 2>}
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: int) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: int) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class SetpointBuffer:
+    """
+              Controller-owned setpoint array for low-overhead streaming. Write
+              into :py:attr:`array` and call :py:meth:`commit` to hand the values
+              to the control thread. Keep a reference to :py:attr:`array` rather
+              than accessing the property on every update, writing into the
+              view and committing avoids all argument conversion.
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __len__(self) -> int:
+        ...
+    def commit(self) -> None:
+        """
+                  Publish the staging array to the control thread.
+        """
+    @property
+    def array(self) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Writable numpy view of the staging array. Changes take effect
+                  with the next :py:meth:`commit`.
+        """
+    @property
+    def version(self) -> int:
+        """
+                  Number of commits so far, including the controller's resets to
+              the current state when it starts.
+        """
+class StressTest:
+    """
+              Fake 1 kHz robot loop that runs controllers and generators through
+              the same control path as a connected :py:class:`Panda` while
+              injecting disturbances: CPU burners, delayed callbacks, threads
+              holding the GIL and bursts of setpoint updates. Torque controllers
+              drive the rigid-body model used by :py:func:`rollout`, generators
+              see their commands echoed back as robot state. Runs execute on a
+              dedicated thread in real time and release the GIL, combine them
+              with :py:func:`configure_tracing` to see where time is spent.
+    """
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, duration: float = 5.0, deadline: float = 0.001, blocking_threshold: float = 0.0001, realtime: bool = False, cpu: int = -1, simulate: bool = True, q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., cpu_burners: int = 0, delay: float = 0.0, delay_probability: float = 0.0, gil_holders: int = 0, gil_hold_time: float = 0.005, gil_period: float = 0.01, block_size: int = 0, setpoints: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]] | None = None, burst_size: int = 0, burst_interval: float = 0.1, producer: typing.Any = None, seed: int = 0) -> None:
+        """
+                  Args:
+                    duration: Length of each run in seconds.
+                    deadline: Latest completion of a callback after the nominal
+                      start of its tick in seconds.
+                    blocking_threshold: Callbacks taking longer than this,
+                      injected delays excluded, count as blocked.
+                    realtime: Run the loop with SCHED_FIFO like
+                      `RealtimeConfig.kEnforce`, requires the privilege.
+                    cpu: CPU to pin the loop thread to, -1 leaves it unpinned.
+                    simulate: Integrate the arm for torque controllers,
+                      otherwise the robot state holds still.
+                    q_init: Initial joint positions.
+                    cpu_burners: Threads spinning on the CPU during runs.
+                    delay: Busy wait in seconds injected before callbacks.
+                    delay_probability: Probability of delaying a callback.
+                    gil_holders: Threads holding the GIL for `gil_hold_time`
+                      once every `gil_period` seconds.
+                    gil_hold_time: Time each GIL holder keeps the GIL.
+                    gil_period: Period of the GIL holders.
+                    block_size: Tick group block size, 0 disables it. A
+                      consumer thread reads the state blocks like
+                      :py:class:`PandaContext` does.
+                    setpoints: Setpoint rows published to the tick group in
+                      bursts, requires a block size.
+                    burst_size: Publications per burst, each publishes the
+                      setpoints and calls `producer`.
+                    burst_interval: Time between bursts in seconds.
+                    producer: Callable invoked with the GIL held in each
+                      publication, e.g. a planner updating setpoints.
+                    seed: Seed of the delay injection.
+        """
+    @typing.overload
+    def run(self, controller: TorqueController) -> dict:
+        ...
+    @typing.overload
+    def run(self, generator: Generator) -> dict:
+        """
+                  Run a torque controller or a generator for the configured
+                  duration with the configured disturbances.
+        
+                  Returns:
+                    Dictionary with the number of ticks, deadline_misses,
+                    max_consecutive_misses, blocked_ticks and injected_delays,
+                    latency statistics in seconds (mean, p50, p90, p99, p99.9,
+                    max) of the wakeup, the callback and the response, i.e.
+                    completion after the nominal tick start, worst_tick_time,
+                    latency statistics of the producer and producer_calls,
+                    blocks_read and blocks_dropped of the consumer, gil_holds,
+                    whether realtime scheduling was applied, failed and error.
+        """
+class TaskPriority:
+    """
+    Members:
+    
+      HIGH
+    
+      NORMAL
+    
+      LOW
+    """
+    HIGH: typing.ClassVar[TaskPriority]  # value = <TaskPriority.HIGH: 0>
+    LOW: typing.ClassVar[TaskPriority]  # value = <TaskPriority.LOW: 2>
+    NORMAL: typing.ClassVar[TaskPriority]  # value = <TaskPriority.NORMAL: 1>
+    __members__: typing.ClassVar[dict[str, TaskPriority]]  # value = {'HIGH': <TaskPriority.HIGH: 0>, 'NORMAL': <TaskPriority.NORMAL: 1>, 'LOW': <TaskPriority.LOW: 2>}
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: int) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
+class TimeScaling:
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __init__(self, error_threshold: float = 0.02, error_limit: float = 0.1, torque_threshold: float = 5.0, torque_limit: float = 15.0, min_rate: float = 0.1, slowdown: float = 10.0, recovery: float = 2.0, log_size: int = 60000) -> None:
+        """
+                       Trajectory clock for path following, attached to a trajectory
+                       follower through its `time_scaling` property. The trajectory
+                       time advances at a rate between `min_rate` and one instead of
+                       with wall time. The rate drops smoothly while the tracking error
+                       or the largest estimated external joint torque exceed their
+                       thresholds and recovers to nominal speed afterwards, so a
+                       disturbed motion slows down instead of triggering reflexes.
+        
+                       Args:
+                         error_threshold: Tracking error above which the motion slows
+                           down, in rad for joint and m for Cartesian followers.
+                         error_limit: Tracking error at which `min_rate` is reached.
+                         torque_threshold: External torque in Nm above which the motion
+                           slows down.
+                         torque_limit: External torque at which `min_rate` is reached.
+                         min_rate: Slowest rate of the trajectory clock, zero allows
+                           pausing.
+                         slowdown: Largest rate decrease per second.
+                         recovery: Largest rate increase per second.
+                         log_size: Number of ticks kept in the time-warp log.
+        """
+    def get_log(self) -> dict:
+        """
+                      Get the time-warp profile of the last ticks as a dictionary of
+                      arrays: controller time, trajectory time, rate, tracking error
+                      and external torque.
+        """
+    @property
+    def rate(self) -> float:
+        ...
+    @property
+    def trajectory_time(self) -> float:
+        ...
 class TorqueController:
     """
     
@@ -353,10 +1417,116 @@ class TorqueController:
         """
                   Get time in seconds since this controller was started.
         """
+class TrajectorySet:
+    """
+    
+              Collection of joint trajectories that are evaluated at common
+              points in time. Evaluation is parallelised over trajectories and
+              each trajectory is compiled on first use.
+          
+    """
+    priority: TaskPriority
+    @staticmethod
+    def _pybind11_conduit_v1_(*args, **kwargs):
+        ...
+    def __getitem__(self, index: int) -> JointTrajectory:
+        ...
+    def __init__(self, trajectories: list[JointTrajectory] = [], priority: TaskPriority = ...) -> None:
+        ...
+    def __len__(self) -> int:
+        ...
+    def add(self, trajectory: JointTrajectory) -> None:
+        ...
+    def clear(self) -> None:
+        ...
+    def compile(self) -> None:
+        ...
+    def get_durations(self) -> numpy.ndarray[tuple[M, typing.Literal[1]], numpy.dtype[numpy.float64]]:
+        ...
+    def get_joint_positions(self, times: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                      Evaluate the joint positions of all trajectories.
+        
+                      Args:
+                        times: Vector of shape (M,) holding the sample times.
+        
+                      Returns:
+                        Array of shape (K, M, 7) for K trajectories.
+        """
+    def sample(self, times: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]) -> tuple:
+        """
+                      Evaluate joint positions, velocities and accelerations of all
+                      trajectories.
+        
+                      Args:
+                        times: Vector of shape (M,) holding the sample times.
+        
+                      Returns:
+                        Tuple of three arrays of shape (K, M, 7) for K trajectories.
+        """
+def clear_model_cache() -> None:
+    """
+              Drop all robot models cached in memory.
+    """
+def clear_trace() -> None:
+    """
+              Drop all recorded events.
+    """
+def configure_model_cache(enabled: bool = True) -> None:
+    """
+              Configure the process-wide robot model cache. Loading the model
+              downloads the model library from the robot, cached models are
+              shared by all :py:class:`Panda` instances connected to the same
+              robot running the same server version.
+    
+              Args:
+                enabled: Share models within the process.
+    """
+def configure_thread_pool(num_threads: int = 0, excluded_cpus: list[int] = []) -> None:
+    """
+              Configure the process-wide thread pool used by all parallel
+              computations of panda-py.
+    
+              Args:
+                num_threads: Number of worker threads. If 0, all CPUs available
+                  to the process except the excluded ones are used.
+                excluded_cpus: CPUs the workers must not run on, e.g. the core
+                  reserved for the real-time control thread. If empty, the last
+                  CPU available to the process is excluded.
+    """
+def configure_tracing(enabled: bool = True, buffer_size: int = 65536) -> None:
+    """
+              Record a timeline of control ticks, controller and generator
+              switches, error recovery, trajectory computations, GIL
+              acquisitions and done callbacks. Every thread keeps its most
+              recent events in a ring buffer, an event costs two clock reads,
+              typically well below a microsecond. Enabling drops previously
+              recorded events. Control loops acquire their buffer when they
+              start, a loop already running when tracing is enabled or cleared
+              is recorded from its next start.
+    
+              Args:
+                enabled: Record events, recorded events are kept when disabled.
+                buffer_size: Number of events kept per thread.
+    """
 def fk(q: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]]:
     """
          Computes end-effector pose in base frame from joint positions.
     """
+def get_model_cache_stats() -> dict:
+    """
+              Get the number of models loaded from the robot and taken from
+              memory.
+    """
+def get_thread_pool_config() -> dict:
+    """
+              Get the configuration of the process-wide thread pool.
+    """
+def get_trace_stats() -> dict:
+    """
+              Get the number of per-thread buffers, of recorded events and of
+              events overwritten by newer ones.
+    """
 @typing.overload
 def ik(O_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q_7: float = 0.7853981633974483) -> numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]]:
     """
@@ -385,6 +1555,69 @@ def ik_full(O_T_EE: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[4]], n
 @typing.overload
 def ik_full(position: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]], orientation: numpy.ndarray[tuple[typing.Literal[4], typing.Literal[1]], numpy.dtype[numpy.float64]], q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., q_7: float = 0.7853981633974483) -> numpy.ndarray[tuple[typing.Literal[4], typing.Literal[7]], numpy.dtype[numpy.float64]]:
     ...
+def rollout(controllers: list[TorqueController], setpoints: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], duration: float = 2.0, objective: RolloutObjective = RolloutObjective.CARTESIAN_POSITION, q_init: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., substeps: int = 2, cutoff_frequency: float = 100.0, armature: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., viscous_friction: numpy.ndarray[tuple[typing.Literal[7], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., payload_mass: float = 0.0, payload_com: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., contact_point: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]] | None = None, contact_normal: numpy.ndarray[tuple[typing.Literal[3], typing.Literal[1]], numpy.dtype[numpy.float64]] = ..., contact_stiffness: float = 10000.0, contact_damping: float = 100.0, settling_tolerance: float = 0.02, record: bool = False, priority: TaskPriority = ...) -> dict:
+    """
+              Simulate each controller on a rigid-body model of the arm, in
+              parallel on the process-wide thread pool and faster than real
+              time. Every rollout starts at rest in `q_init` and receives the
+              setpoint rows through the same mechanism as
+              :py:meth:`PandaContext.set_setpoints`, one row per tick with the
+              last row held. Commands pass the same torque rate saturation and
+              clipping as on the robot, and gravity is compensated for the
+              configured Franka Hand. Controllers are modified by the rollout
+              and must be distinct instances, e.g. one per parameter set.
+    
+              Args:
+                controllers: Controllers to simulate.
+                setpoints: A single setpoint row or one row per tick (T x K).
+                  The leading columns are the reference of the objective.
+                duration: Simulated time in seconds.
+                objective: Signal compared to the setpoints, joint positions,
+                  end-effector position or force exerted on the contact plane.
+                q_init: Initial joint positions.
+                substeps: Integration steps per 1 ms control tick.
+                cutoff_frequency: Cutoff frequency of libfranka's low-pass filter
+                  on the commanded torques in Hz, disabled at 1000 and above.
+                armature: Reflected rotor inertia of the simulated joints.
+                viscous_friction: Viscous joint friction of the simulated arm.
+                payload_mass: Mass of a payload unknown to the controller.
+                payload_com: Center of mass of the payload in the flange frame.
+                contact_point: Point on a contact plane, no contact if None.
+                contact_normal: Normal of the contact plane pointing into free
+                  space.
+                contact_stiffness: Stiffness of the contact plane in N/m.
+                contact_damping: Damping of the contact plane in Ns/m.
+                settling_tolerance: Settling band as fraction of the step to the
+                  final setpoint.
+                record: Also return the objective signal of every tick.
+                priority: Priority of the rollouts on the thread pool.
+    
+              Returns:
+                Dictionary of arrays with one entry per controller: duration,
+                rms_error, max_error, final_error, overshoot (fraction of the
+                step), settling_time (inf if not settled), the number of ticks
+                whose commands exceed the torque rate or torque limits
+                (torque_rate_violations, torque_limit_violations),
+                max_torque_rate in Nm/s and failed. `error` lists the failure
+                reasons and `trace` the recorded signals (T x D).
+    """
+def save_trace(path: str) -> int:
+    """
+              Write the recorded events in the Chrome trace event format to
+              `path`, which can be opened with https://ui.perfetto.dev or
+              chrome://tracing. Returns the number of events written.
+    """
+def set_model_loader(loader: typing.Callable[[panda_py.libfranka.Robot], panda_py.libfranka.Model] | None) -> None:
+    """
+              Replace the loader of the robot model cache, e.g. with a stand-in
+              for testing. Cached models are kept.
+    
+              Args:
+                loader: Called with the connected :py:class:`libfranka.Robot`
+                  on a cache miss, returns its :py:class:`libfranka.Model`.
+                  None restores the default loader, which downloads the model
+                  from the robot.
+    """
 _DTAU_J_MAX: numpy.ndarray  # value = array([1000., 1000., 1000., 1000., 1000., 1000., 1000.])
 _JOINT_LIMITS_LOWER: numpy.ndarray  # value = array([-2.8973, -1.7628, -2.8973, -3.0718, -2.8973, -0.0175, -2.8973])
 _JOINT_LIMITS_UPPER: numpy.ndarray  # value = array([ 2.8973,  1.7628,  2.8973, -0.0698,  2.8973,  3.7525,  2.8973])
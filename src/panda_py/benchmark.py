@@ -0,0 +1,296 @@
+"""
+Cycle-time benchmark of the motion strategies on representative paths.
+Each path is driven offline with :py:class:`panda_py.motion.JointTrajectory`
+(time-optimal), the joint motion generator (ruckig, stopping at each
+waypoint) and the Cartesian motion generator, see
+:py:class:`panda_py.CycleTimeBenchmark`. The report holds the motion
+duration, planning latency and peak joint velocities and torques of each
+combination and is written as JSON to be tracked over releases::
+
+    python -m panda_py.benchmark --output cycle_time.json
+
+:py:func:`setpoint_overhead` measures the Python-side cost of streaming
+setpoints to the torque controllers::
+
+    python -m panda_py.benchmark --setpoints
+
+"""
+import argparse
+import datetime
+import json
+import platform
+import sys
+import time
+
+import numpy as np
+
+# pylint: disable=no-name-in-module
+from ._core import CartesianImpedance, CycleTimeBenchmark, JointPosition,\
+                   MotionStrategy, fk, ik
+
+__all__ = [
+    'STRATEGIES', 'paths', 'run', 'format_table', 'setpoint_overhead', 'main'
+]
+
+STRATEGIES = {
+    'joint_trajectory': MotionStrategy.JOINT_TRAJECTORY,
+    'joint_motion_generator': MotionStrategy.JOINT_MOTION_GENERATOR,
+    'cartesian_motion_generator': MotionStrategy.CARTESIAN_MOTION_GENERATOR,
+}
+"""
+Strategies by the names used in the report.
+"""
+
+# End effector pointing down, like Panda.rotate_to_start
+_DOWN = np.array([[1, 0, 0], [0, -1, 0], [0, 0, -1]], dtype=float)
+
+
+def _pick_place():
+    pick, place = np.array([0.45, -0.25, 0.15]), np.array([0.45, 0.25, 0.15])
+    above = np.array([0.0, 0.0, 0.15])
+    return [
+        pick + above, pick, pick + above, place + above, place, place + above,
+        pick + above
+    ]
+
+
+def _palletizing():
+    pick = np.array([0.35, -0.35, 0.15])
+    above = np.array([0.0, 0.0, 0.2])
+    positions = [pick + above]
+    for x in (0.45, 0.6):
+        for y in (0.2, 0.35):
+            place = np.array([x, y, 0.1])
+            positions += [pick, pick + above, place + above, place,
+                          place + above, pick + above]
+    return positions
+
+
+def _scan():
+    positions = []
+    for i, x in enumerate(np.linspace(0.35, 0.6, 4)):
+        ys = (-0.2, 0.2) if i % 2 == 0 else (0.2, -0.2)
+        positions += [np.array([x, y, 0.3]) for y in ys]
+    return positions
+
+
+def _to_joints(name, positions):
+    waypoints = []
+    q = None
+    for position in positions:
+        pose = np.eye(4)
+        pose[:3, :3] = _DOWN
+        pose[:3, 3] = position
+        q = ik(pose) if q is None else ik(pose, q)
+        if not np.all(np.isfinite(q)):
+            raise RuntimeError(
+                f'Path {name} is not reachable at {position.tolist()}.')
+        waypoints.append(q)
+    return np.array(waypoints)
+
+
+def paths():
+    """
+    Representative paths as joint waypoints (N x 7), by name.
+
+    * ``pick_place``: Approach, grasp and retreat at a pick and a place
+      location 0.5 m apart.
+    * ``palletizing``: Four pick and place cycles onto a 2 x 2 pallet.
+    * ``scan``: Serpentine raster over a 0.25 x 0.4 m area.
+    """
+    return {
+        'pick_place': _to_joints('pick_place', _pick_place()),
+        'palletizing': _to_joints('palletizing', _palletizing()),
+        'scan': _to_joints('scan', _scan()),
+    }
+
+
+def _version():
+    try:
+        from importlib import metadata  # pylint: disable=import-outside-toplevel
+        return metadata.version('panda-python')
+    except Exception:  # pylint: disable=broad-except
+        return 'unknown'
+
+
+def run(path_names=None, strategy_names=None, **settings):
+    """
+    Run the strategies on the paths.
+
+    Args:
+      path_names: Paths of :py:func:`paths` to run, all by default.
+      strategy_names: Keys of :py:data:`STRATEGIES` to run, all by default.
+      settings: Keyword arguments of :py:class:`panda_py.CycleTimeBenchmark`.
+
+    Returns:
+      Report with the package version, a UTC timestamp, the settings and one
+      result per path and strategy.
+    """
+    all_paths = paths()
+    path_names = list(all_paths) if path_names is None else path_names
+    strategy_names = list(
+        STRATEGIES) if strategy_names is None else strategy_names
+    benchmark = CycleTimeBenchmark(**settings)
+    results = []
+    for path_name in path_names:
+        waypoints = all_paths[path_name]
+        for strategy_name in strategy_names:
+            result = benchmark.run(waypoints, STRATEGIES[strategy_name])
+            result['peak_velocity'] = np.asarray(
+                result['peak_velocity']).flatten().tolist()
+            result['peak_torque'] = np.asarray(
+                result['peak_torque']).flatten().tolist()
+            results.append({
+                'path': path_name,
+                'strategy': strategy_name,
+                'waypoints': len(waypoints),
+                **result
+            })
+    return {
+        'version': _version(),
+        'timestamp': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        'python': platform.python_version(),
+        'machine': platform.machine(),
+        'settings': settings,
+        'results': results,
+    }
+
+
+def format_table(report):
+    """
+    Format the results of a report as a text table.
+    """
+    header = ('path', 'strategy', 'duration [s]', 'planning [ms]',
+              'max tick [us]', 'velocity [%]', 'torque [%]')
+    rows = [header]
+    for r in report['results']:
+        if r['failed']:
+            rows.append((r['path'], r['strategy'], 'failed: ' + r['error'],
+                         '', '', '', ''))
+            continue
+        rows.append((r['path'], r['strategy'], f"{r['duration']:.3f}",
+                     f"{1e3 * r['planning_time']:.2f}",
+                     f"{1e6 * r['max_tick_time']:.1f}",
+                     f"{100 * r['velocity_utilization']:.0f}",
+                     f"{100 * r['torque_utilization']:.0f}"))
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    lines = ['  '.join(cell.ljust(width)
+                       for cell, width in zip(row, widths)).rstrip()
+             for row in rows]
+    lines.insert(1, '  '.join('-' * width for width in widths))
+    return '\n'.join(lines)
+
+
+def _per_call(function, iterations):
+    start = time.perf_counter()
+    for _ in range(iterations):
+        function()
+    return (time.perf_counter() - start) / iterations
+
+
+def setpoint_overhead(iterations=100000):
+    """
+    Measure the Python-side cost of handing a setpoint to a controller,
+    offline and without a running control loop. Compares ``set_control``,
+    which converts its arguments and takes the controller's lock, with
+    writing into the cached :py:attr:`panda_py.SetpointBuffer.array` and
+    committing.
+
+    Args:
+      iterations: Updates timed per method.
+
+    Returns:
+      Seconds per update by controller and method.
+    """
+    q = np.array([0.0, -np.pi / 4, 0.0, -3 * np.pi / 4, 0.0, np.pi / 2, np.pi / 4])
+    position = fk(q)[:3, 3].copy()
+    orientation = np.array([1.0, 0.0, 0.0, 0.0])
+    results = {}
+
+    joint = JointPosition()
+    dq = np.zeros(7)
+    buffer = joint.setpoint
+    array = buffer.array
+
+    def joint_buffer():
+        array[:7] = q
+        array[7:] = dq
+        buffer.commit()
+
+    results['JointPosition'] = {
+        'set_control': _per_call(lambda: joint.set_control(q, dq), iterations),
+        'setpoint_buffer': _per_call(joint_buffer, iterations),
+    }
+
+    cartesian = CartesianImpedance()
+    cartesian_buffer = cartesian.setpoint
+    cartesian_array = cartesian_buffer.array
+
+    def cartesian_commit():
+        cartesian_array[:3] = position
+        cartesian_array[3:7] = orientation
+        cartesian_buffer.commit()
+
+    results['CartesianImpedance'] = {
+        'set_control':
+            _per_call(lambda: cartesian.set_control(position, orientation),
+                      iterations),
+        'setpoint_buffer': _per_call(cartesian_commit, iterations),
+    }
+    return results
+
+
+def main(argv=None):
+    """
+    Run the benchmark, print the table and optionally write the JSON report.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('--output', type=str, help='Path of the JSON report.')
+    parser.add_argument('--paths',
+                        nargs='+',
+                        choices=['pick_place', 'palletizing', 'scan'],
+                        help='Paths to run, all by default.')
+    parser.add_argument('--strategies',
+                        nargs='+',
+                        choices=list(STRATEGIES),
+                        help='Strategies to run, all by default.')
+    parser.add_argument('--speed-factor', type=float, default=None,
+                        help='Speed factor of the joint trajectory, '
+                        'the relative velocity by default.')
+    parser.add_argument('--max-deviation', type=float, default=0.0,
+                        help='Blending deviation of the joint trajectory.')
+    parser.add_argument('--velocity-rel', type=float, default=1.0,
+                        help='Relative velocity of the generators.')
+    parser.add_argument('--acceleration-rel', type=float, default=1.0,
+                        help='Relative acceleration of the generators.')
+    parser.add_argument('--jerk-rel', type=float, default=1.0,
+                        help='Relative jerk of the generators.')
+    parser.add_argument('--setpoints',
+                        action='store_true',
+                        help='Measure the setpoint streaming overhead instead.')
+    args = parser.parse_args(argv)
+
+    if args.setpoints:
+        for controller, methods in setpoint_overhead().items():
+            for method, seconds in methods.items():
+                print(f'{controller:<20}{method:<18}{1e9 * seconds:8.0f} ns')
+        return 0
+
+    speed_factor = args.velocity_rel if args.speed_factor is None \
+        else args.speed_factor
+    report = run(args.paths,
+                 args.strategies,
+                 speed_factor=speed_factor,
+                 max_deviation=args.max_deviation,
+                 velocity_rel=args.velocity_rel,
+                 acceleration_rel=args.acceleration_rel,
+                 jerk_rel=args.jerk_rel)
+    print(format_table(report))
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            json.dump(report, f, indent=2)
+    return 1 if any(r['failed'] for r in report['results']) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
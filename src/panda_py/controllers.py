@@ -7,10 +7,15 @@ function :py:func:`panda_py.Panda.start_controller`.
 
 # pylint: disable=no-name-in-module
 from ._core import AppliedForce, AppliedTorque,\
-                    CartesianImpedance, Force, IntegratedVelocity,\
-                    JointPosition, TorqueController
+                    CartesianImpedance, CartesianTrajectoryFollower, Force,\
+                    HybridForceImpedance, IntegratedVelocity, JointPosition,\
+                    JointTrajectoryFollower, JointTrajectoryMPC, NullspaceObjective,\
+                    SetpointBuffer, TimeScaling, TorqueController
 
 __all__ = [
     'TorqueController', 'CartesianImpedance', 'IntegratedVelocity',
-    'JointPosition', 'AppliedTorque', 'AppliedForce', 'Force'
+    'JointPosition', 'AppliedTorque', 'AppliedForce', 'Force',
+    'SetpointBuffer', 'JointTrajectoryFollower', 'CartesianTrajectoryFollower',
+    'HybridForceImpedance', 'JointTrajectoryMPC', 'TimeScaling',
+    'NullspaceObjective'
 ]
@@ -6,5 +6,5 @@ function :py:func:`panda_py.Panda.start_controller`.
 """
 
 # pylint: disable=no-name-in-module
-from ._core import JointMotionGenerator, Generator, CartesianMotionGenerator
+from ._core import JointMotionGenerator, Generator, CartesianMotionGenerator, JointTrajectoryGenerator, JointVelocityStreamGenerator, CartesianVelocityStreamGenerator
                     
@@ -1,5 +1,7 @@
 from __future__ import annotations
 import datetime
+import numpy
+import panda_py._core
 import pybind11_stubgen.typing_ext
 import typing
 __all__ = ['CartesianPose', 'CartesianVelocities', 'ControllerMode', 'Duration', 'Errors', 'Frame', 'Gripper', 'GripperState', 'JointPositions', 'JointVelocities', 'MAX_TORQUE_RATE', 'Model', 'RealtimeConfig', 'Robot', 'RobotMode', 'RobotState', 'Torques', 'VacuumGripper', 'VacuumGripperDeviceStatus', 'VacuumGripperProductionSetupProfile', 'VacuumGripperState', 'has_realtime_kernel', 'is_homogeneous_transformation', 'is_valid_elbow', 'limit_rate', 'motion_finished', 'set_current_thread_to_highest_scheduler_priority']
@@ -334,36 +336,64 @@ class Model:
     @typing.overload
     def body_jacobian(self, frame: Frame, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(42)]:
         ...
+    def body_jacobian_batch(self, frame: Frame, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Body Jacobians of `frame` for each row of `q` (N x 6 x 7).
+        """
     @typing.overload
     def coriolis(self, robot_state: RobotState) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]:
         ...
     @typing.overload
     def coriolis(self, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], dq: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], I_total: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(9)], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]:
         ...
+    def coriolis_batch(self, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], dq: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], I_total: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(9)], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Coriolis torques for each row of `q` and `dq` (N x 7).
+        """
     @typing.overload
     def gravity(self, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)], gravity_earth: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)] = [0.0, 0.0, -9.81]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]:
         ...
     @typing.overload
     def gravity(self, robot_state: RobotState, gravity_earth: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)] = [0.0, 0.0, -9.81]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)]:
         ...
+    def gravity_batch(self, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)], gravity_earth: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)] = [0.0, 0.0, -9.81], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Gravity torques for each row of `q` (N x 7).
+        """
     @typing.overload
     def mass(self, robot_state: RobotState) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(49)]:
         ...
     @typing.overload
     def mass(self, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], I_total: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(9)], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(49)]:
         ...
+    def mass_batch(self, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], I_total: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(9)], m_total: float, F_x_Ctotal: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(3)], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Joint space inertia matrices for each row of `q`
+                  (N x 7 x 7).
+        """
     @typing.overload
     def pose(self, frame: Frame, robot_state: RobotState) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)]:
         ...
     @typing.overload
     def pose(self, frame: Frame, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)]:
         ...
+    def pose_batch(self, frame: Frame, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Poses of `frame` for each row of `q` (N x 7) as array of
+                  4x4 matrices (N x 4 x 4). Like all batched methods, the
+                  configurations are evaluated on the process-wide thread
+                  pool without holding the GIL.
+        """
     @typing.overload
     def zero_jacobian(self, frame: Frame, robot_state: RobotState) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(42)]:
         ...
     @typing.overload
     def zero_jacobian(self, frame: Frame, q: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(7)], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)]) -> typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(42)]:
         ...
+    def zero_jacobian_batch(self, frame: Frame, q: numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]], F_T_EE: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], EE_T_K: typing.Annotated[list[float], pybind11_stubgen.typing_ext.FixedSize(16)], priority: panda_py._core.TaskPriority = panda_py._core.TaskPriority.NORMAL) -> numpy.ndarray[typing.Any, numpy.dtype[numpy.float64]]:
+        """
+                  Zero Jacobians of `frame` for each row of `q` (N x 6 x 7).
+        """
 class RealtimeConfig:
     """
     Members:
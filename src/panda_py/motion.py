@@ -2,8 +2,78 @@
 Motion generation for the Panda robot. These are also directly
 integrated as convenience methods of the :py:class:`panda_py.Panda` class.
 """
+import asyncio
+import sys
 
 # pylint: disable=no-name-in-module
-from ._core import JointTrajectory, CartesianTrajectory
+from ._core import JointTrajectory, CartesianTrajectory, TrajectorySet, JerkLimitedTrajectory
+from ._core import JointTrajectoryFuture, CartesianTrajectoryFuture
 
-__all__ = ['JointTrajectory', 'CartesianTrajectory']
+__all__ = [
+    'JointTrajectory', 'CartesianTrajectory', 'TrajectorySet',
+    'JerkLimitedTrajectory', 'JointTrajectoryFuture',
+    'CartesianTrajectoryFuture'
+]
+
+
+def _in_trio():
+    if 'trio' not in sys.modules:
+        return False
+    try:
+        sys.modules['trio'].lowlevel.current_task()
+    except RuntimeError:
+        return False
+    return True
+
+
+async def _wait_trio(future):
+    trio = sys.modules['trio']
+    token = trio.lowlevel.current_trio_token()
+    task = trio.lowlevel.current_task()
+    waiting = [True]
+
+    def wake():
+        if waiting[0]:
+            waiting[0] = False
+            trio.lowlevel.reschedule(task)
+
+    def abort(_):
+        waiting[0] = False
+        future.cancel()
+        return trio.lowlevel.Abort.SUCCEEDED
+
+    # The callback runs on a worker thread, wake up the task in trio's thread
+    future.add_done_callback(lambda: token.run_sync_soon(wake))
+    await trio.lowlevel.wait_task_rescheduled(abort)
+    return future.result()
+
+
+async def _wait_asyncio(future):
+    loop = asyncio.get_running_loop()
+    waiter = loop.create_future()
+
+    def wake():
+        if not waiter.done():
+            waiter.set_result(None)
+
+    future.add_done_callback(lambda: loop.call_soon_threadsafe(wake))
+    try:
+        await waiter
+    except asyncio.CancelledError:
+        future.cancel()
+        raise
+    return future.result()
+
+
+def _await(future):
+    """
+    Awaits a trajectory future from asyncio or trio without blocking the event
+    loop. Cancelling the awaiting task also cancels the computation.
+    """
+    if _in_trio():
+        return _wait_trio(future).__await__()
+    return _wait_asyncio(future).__await__()
+
+
+JointTrajectoryFuture.__await__ = _await
+CartesianTrajectoryFuture.__await__ = _await
@@ -44,12 +44,9 @@ class Panda(_Panda):
         if rotations.ndim == 2:
             rotations = rotations.reshape(1, 3, 3)
 
-        poses = []
-        for r in rotations:
-            pose = np.eye(4)
-            pose[:3, 3] = current_position
-            pose[:3, :3] = r
-            poses.append(pose)
+        poses = np.tile(np.eye(4), (rotations.shape[0], 1, 1))
+        poses[:, :3, 3] = current_position
+        poses[:, :3, :3] = rotations
 
         await self.movex(poses, speed=speed, reference_frame=reference_frame)
 
@@ -72,12 +69,9 @@ class Panda(_Panda):
         if positions.ndim == 1:
             positions = positions.reshape(1, 3)
 
-        poses = []
-        for p in positions:
-            pose = np.eye(4)
-            pose[:3, 3] = p
-            pose[:3, :3] = current_rotation
-            poses.append(pose)
+        poses = np.tile(np.eye(4), (positions.shape[0], 1, 1))
+        poses[:, :3, 3] = positions
+        poses[:, :3, :3] = current_rotation
 
         await self.movex(poses, speed=speed, reference_frame=reference_frame)
 
@@ -95,20 +89,10 @@ class Panda(_Panda):
         if pose.ndim == 2:
             pose = pose.reshape(1, 4, 4)
 
-        num_waypoints = pose.shape[0]
-
-        if isinstance(speed, float):
-            speed = [speed] * num_waypoints
-
-        cartesian_motions = []
-        for i, p in enumerate(pose):
-            cartesian_motion = CartesianMotion(p, reference_frame=reference_frame)
-            cartesian_motion.velocity_rel = speed[i]
-            cartesian_motion.jerk_rel = 0.1
-            cartesian_motions.append(cartesian_motion)
-
         ctrl = CartesianMotionGenerator(keep_running=False)
-        ctrl.add_waypoints(cartesian_motions)
+        ctrl.add_waypoints(
+            pose, velocity_rel=speed, jerk_rel=0.1, reference_frame=reference_frame
+        )
         await self._run_generator(ctrl)
         self.raise_error()
 
@@ -121,19 +105,8 @@ class Panda(_Panda):
         if joints.ndim == 1:
             joints = joints.reshape(1, 7)
 
-        num_waypoints = joints.shape[0]
-
-        if isinstance(speed, float):
-            speed = [speed] * num_waypoints
-
-        joint_motions = []
-        for i, j in enumerate(joints):
-            joint_motion = JointMotion(j)
-            joint_motion.velocity_rel = speed[i]
-            joint_motions.append(joint_motion)
-
         ctrl = JointMotionGenerator(keep_running=False)
-        ctrl.add_waypoints(joint_motions)
+        ctrl.add_waypoints(joints, velocity_rel=speed)
         await self._run_generator(ctrl)
         self.raise_error()
 
@@ -0,0 +1,24 @@
+#include "robot_model.h"
+
+FrankaRobotModel::FrankaRobotModel(std::shared_ptr<franka::Model> model)
+    : model_(model) {}
+
+std::array<double, 49> FrankaRobotModel::mass(
+    const franka::RobotState &robot_state) const {
+  return model_->mass(robot_state);
+}
+
+std::array<double, 7> FrankaRobotModel::coriolis(
+    const franka::RobotState &robot_state) const {
+  return model_->coriolis(robot_state);
+}
+
+std::array<double, 7> FrankaRobotModel::gravity(
+    const franka::RobotState &robot_state) const {
+  return model_->gravity(robot_state);
+}
+
+std::array<double, 42> FrankaRobotModel::zeroJacobian(
+    franka::Frame frame, const franka::RobotState &robot_state) const {
+  return model_->zeroJacobian(frame, robot_state);
+}
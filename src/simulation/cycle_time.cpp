@@ -0,0 +1,249 @@
+#include "simulation/cycle_time.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "constants.h"
+#include "motion/cartesian_motion_generator.hpp"
+#include "motion/joint_motion_generator.hpp"
+#include "simulation/plant.h"
+#include "trace.h"
+
+using namespace simulation;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double _seconds(Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+// Peak joint velocities and torques along a motion
+class Peaks {
+ public:
+  explicit Peaks(const Load &load) : model_(Plant::model()), load_(load) {}
+
+  void add(const Vector7d &q, const Vector7d &dq, const Vector7d &ddq) {
+    model_->dynamics(q, dq, load_, mass_, bias_);
+    velocity_ = velocity_.cwiseMax(dq.cwiseAbs());
+    torque_ = torque_.cwiseMax((mass_ * ddq + bias_).cwiseAbs());
+  }
+
+  void store(CycleTimeResult &result) const {
+    result.peak_velocity = velocity_;
+    result.peak_torque = torque_;
+    result.velocity_utilization =
+        velocity_.cwiseQuotient(kQMaxVelocity).maxCoeff();
+    result.torque_utilization = torque_.cwiseQuotient(kTauJMax).maxCoeff();
+  }
+
+ private:
+  std::shared_ptr<RigidBodyModel> model_;
+  Load load_;
+  Eigen::Matrix<double, 7, 7> mass_;
+  Vector7d bias_;
+  Vector7d velocity_ = Vector7d::Zero(), torque_ = Vector7d::Zero();
+};
+
+/**
+ * Step a generator from `state` until it finishes. `tick` computes the
+ * command and returns whether the motion finished, `advance` echoes the
+ * command into the robot state and returns the joint positions reached,
+ * non-finite if there are none. Only `tick` counts as computation.
+ */
+template <typename Tick, typename Advance>
+CycleTimeResult _step(franka::RobotState state, const Tick &tick,
+                      const Advance &advance,
+                      const CycleTimeSettings &settings) {
+  const double dt = CycleTimeSettings::kControlPeriod;
+  const size_t max_ticks =
+      static_cast<size_t>(std::ceil(settings.timeout / dt));
+  CycleTimeResult result;
+  Peaks peaks(settings.load);
+  Vector7d q_prev = ArrayToVector<7>(state.q);
+  Vector7d dq_prev = Vector7d::Zero();
+  for (size_t k = 0;; k++) {
+    if (k > max_ticks) {
+      result.failed = true;
+      result.error = "Still moving after the timeout.";
+      break;
+    }
+    const auto begin = Clock::now();
+    const bool finished = tick(state, franka::Duration(k == 0 ? 0 : 1));
+    const double elapsed = _seconds(Clock::now() - begin);
+    if (k == 0) {
+      result.planning_time = elapsed;
+    } else {
+      result.max_tick_time = std::max(result.max_tick_time, elapsed);
+    }
+    if (finished) break;
+
+    const Vector7d q = advance(state);
+    if (!q.allFinite()) {
+      result.failed = true;
+      result.error = "No joint positions reach the commanded pose at " +
+                     std::to_string(k * dt) + " s.";
+      break;
+    }
+    const Vector7d dq = (q - q_prev) / dt;
+    const Vector7d ddq = (dq - dq_prev) / dt;
+    state.q = state.q_d = VectorToArray(q);
+    state.dq = state.dq_d = VectorToArray(dq);
+    state.ddq_d = VectorToArray(ddq);
+    peaks.add(q, dq, ddq);
+    if ((q - q_prev).cwiseAbs().maxCoeff() > 1e-9) {
+      result.duration = (k + 1) * dt;
+    }
+    q_prev = q;
+    dq_prev = dq;
+  }
+  peaks.store(result);
+  return result;
+}
+}  // namespace
+
+CycleTimeBenchmark::CycleTimeBenchmark(const CycleTimeSettings &settings)
+    : settings_(settings), kinematics_(settings.F_T_EE) {
+  if (settings.speed_factor <= 0.0 || settings.speed_factor > 1.0) {
+    throw std::invalid_argument("Speed factor must be in (0, 1].");
+  }
+  if (settings.max_deviation < 0.0) {
+    throw std::invalid_argument("Deviation must be non-negative.");
+  }
+  for (double rel : {settings.velocity_rel, settings.acceleration_rel,
+                     settings.jerk_rel}) {
+    if (rel <= 0.0 || rel > 1.0) {
+      throw std::invalid_argument("Relative dynamics must be in (0, 1].");
+    }
+  }
+  if (settings.timeout <= 0.0) {
+    throw std::invalid_argument("Timeout must be positive.");
+  }
+  panda_ = std::unique_ptr<Panda>(new Panda("benchmark", Plant::model()));
+  panda_->velocity_rel = settings.velocity_rel;
+  panda_->acceleration_rel = settings.acceleration_rel;
+  panda_->jerk_rel = settings.jerk_rel;
+}
+
+CycleTimeBenchmark::~CycleTimeBenchmark() = default;
+
+CycleTimeResult CycleTimeBenchmark::run(const std::vector<Vector7d> &waypoints,
+                                        Strategy strategy) {
+  if (waypoints.size() < 2) {
+    throw std::invalid_argument("At least two waypoints are required.");
+  }
+  TraceScope scope("benchmark", "cycle_time");
+  try {
+    switch (strategy) {
+      case Strategy::kJointTrajectory:
+        return _trajectory(waypoints);
+      case Strategy::kJointMotionGenerator:
+        return _jointGenerator(waypoints);
+      case Strategy::kCartesianMotionGenerator:
+        return _cartesianGenerator(waypoints);
+    }
+  } catch (const std::exception &e) {
+    CycleTimeResult result;
+    result.failed = true;
+    result.error = e.what();
+    return result;
+  }
+  throw std::invalid_argument("Unknown strategy.");
+}
+
+CycleTimeResult CycleTimeBenchmark::_trajectory(
+    const std::vector<Vector7d> &waypoints) {
+  CycleTimeResult result;
+  const auto begin = Clock::now();
+  motion::JointTrajectory trajectory(waypoints, settings_.speed_factor,
+                                     settings_.max_deviation);
+  // Followers evaluate the compiled form
+  trajectory.compile();
+  result.planning_time = _seconds(Clock::now() - begin);
+  result.duration = trajectory.getDuration();
+
+  const double dt = CycleTimeSettings::kControlPeriod;
+  const size_t ticks =
+      static_cast<size_t>(std::ceil(result.duration / dt)) + 1;
+  Peaks peaks(settings_.load);
+  Vector7d q, dq, ddq;
+  size_t hint = 0;
+  for (size_t k = 0; k < ticks; k++) {
+    const auto tick_begin = Clock::now();
+    hint = trajectory.evaluate(std::min(k * dt, result.duration), q, dq, ddq,
+                               hint);
+    result.max_tick_time =
+        std::max(result.max_tick_time, _seconds(Clock::now() - tick_begin));
+    peaks.add(q, dq, ddq);
+  }
+  peaks.store(result);
+  return result;
+}
+
+CycleTimeResult CycleTimeBenchmark::_jointGenerator(
+    const std::vector<Vector7d> &waypoints) {
+  PlantSettings plant;
+  plant.q_init = waypoints.front();
+  plant.end_effector = settings_.load;
+  plant.F_T_EE = settings_.F_T_EE;
+  const franka::RobotState initial = Plant(plant).getState();
+
+  auto generator = std::make_shared<motion::JointMotionGenerator>(false);
+  std::vector<motion::JointMotion> targets;
+  for (size_t i = 1; i < waypoints.size(); i++) {
+    targets.emplace_back(waypoints[i]);
+  }
+  generator->addWaypoints(targets);
+  generator->setTime(0);
+  generator->start(panda_.get(), initial, Plant::model());
+
+  franka::JointPositions command(initial.q);
+  return _step(
+      initial,
+      [&](const franka::RobotState &state, franka::Duration period) {
+        command = generator->step(state, period);
+        return command.motion_finished;
+      },
+      [&](franka::RobotState &) { return ArrayToVector<7>(command.q); },
+      settings_);
+}
+
+CycleTimeResult CycleTimeBenchmark::_cartesianGenerator(
+    const std::vector<Vector7d> &waypoints) {
+  PlantSettings plant;
+  plant.q_init = waypoints.front();
+  plant.end_effector = settings_.load;
+  plant.F_T_EE = settings_.F_T_EE;
+  const franka::RobotState initial = Plant(plant).getState();
+
+  auto generator = std::make_shared<motion::CartesianMotionGenerator>(false);
+  std::vector<motion::CartesianMotion> targets;
+  for (size_t i = 1; i < waypoints.size(); i++) {
+    targets.emplace_back(kinematics_.fk(waypoints[i]));
+  }
+  generator->addWaypoints(targets);
+  generator->setTime(0);
+  // The model enables the generator's Jacobian-based scaling
+  generator->start(panda_.get(), initial, Plant::model());
+
+  franka::CartesianPose command(initial.O_T_EE);
+  return _step(
+      initial,
+      [&](const franka::RobotState &state, franka::Duration period) {
+        command = generator->step(state, period);
+        return command.motion_finished;
+      },
+      // libfranka's Cartesian interface holds the elbow, the position of
+      // joint 3 plus the sign of joint 4, which the analytical IK can't
+      // hold. Keeping joint 7 and the solution closest to the previous
+      // configuration approximates it.
+      [&](franka::RobotState &state) {
+        state.O_T_EE = state.O_T_EE_d = state.O_T_EE_c = command.O_T_EE;
+        const Vector7d q = ArrayToVector<7>(state.q);
+        return kinematics_.ik(Eigen::Matrix4d::Map(command.O_T_EE.data()), q,
+                              q[6]);
+      },
+      settings_);
+}
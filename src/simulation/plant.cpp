@@ -0,0 +1,153 @@
+#include "simulation/plant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace simulation;
+
+namespace {
+// Lump two loads given in the flange frame into one
+Load _combine(const Load &a, const Load &b) {
+  Load load;
+  load.mass = a.mass + b.mass;
+  if (load.mass <= 0.0) return load;
+  load.com = (a.mass * a.com + b.mass * b.com) / load.mass;
+  for (const Load *part : {&a, &b}) {
+    const Eigen::Vector3d d = part->com - load.com;
+    load.inertia += part->inertia +
+                    part->mass * (d.squaredNorm() * Eigen::Matrix3d::Identity() -
+                                  d * d.transpose());
+  }
+  return load;
+}
+
+// Force of the contact plane acting on the end effector
+Eigen::Vector3d _contactForce(const Contact &contact,
+                              const Eigen::Vector3d &position,
+                              const Eigen::Vector3d &velocity) {
+  const Eigen::Vector3d normal = contact.normal.normalized();
+  const double penetration = -(position - contact.point).dot(normal);
+  if (penetration <= 0.0) return Eigen::Vector3d::Zero();
+  const double force = std::max(
+      contact.stiffness * penetration - contact.damping * velocity.dot(normal),
+      0.0);
+  return force * normal;
+}
+}  // namespace
+
+std::shared_ptr<RigidBodyModel> Plant::model() {
+  static const std::shared_ptr<RigidBodyModel> model =
+      std::make_shared<RigidBodyModel>();
+  return model;
+}
+
+Plant::Plant(const PlantSettings &settings) : settings_(settings) {
+  if (settings.substeps < 1) {
+    throw std::invalid_argument("At least one integration step is required.");
+  }
+  if (settings.cutoff_frequency <= 0.0) {
+    throw std::invalid_argument("Cutoff frequency must be positive.");
+  }
+  const double dt = PlantSettings::kControlPeriod;
+  load_ = _combine(settings.end_effector, settings.payload);
+  payload_ = settings.payload.mass > 0.0;
+  // First-order low-pass like libfranka's control loop
+  filter_gain_ =
+      settings.cutoff_frequency < 1e3
+          ? dt / (dt + 1.0 / (2.0 * M_PI * settings.cutoff_frequency))
+          : 1.0;
+
+  Eigen::Map<Eigen::Matrix4d>(state_.F_T_EE.data()) = settings.F_T_EE;
+  Eigen::Map<Eigen::Matrix4d>(state_.EE_T_K.data()).setIdentity();
+  Eigen::Map<Eigen::Matrix4d>(state_.NE_T_EE.data()).setIdentity();
+  Eigen::Map<Eigen::Matrix4d>(state_.F_T_NE.data()) = settings.F_T_EE;
+  for (auto *m : {&state_.m_ee, &state_.m_total}) {
+    *m = settings.end_effector.mass;
+  }
+  for (auto *com : {&state_.F_x_Cee, &state_.F_x_Ctotal}) {
+    Eigen::Map<Eigen::Vector3d>(com->data()) = settings.end_effector.com;
+  }
+  for (auto *inertia : {&state_.I_ee, &state_.I_total}) {
+    Eigen::Map<Eigen::Matrix3d>(inertia->data()) =
+        settings.end_effector.inertia;
+  }
+  state_.robot_mode = franka::RobotMode::kMove;
+
+  // Holding still, the sensors measure the plant's gravity
+  q_ = settings.q_init;
+  dq_.setZero();
+  model()->dynamics(q_, dq_, load_, mass_, bias_);
+  tau_J_ = bias_;
+  Eigen::Map<Vector7d>(state_.tau_J.data()) = tau_J_;
+  _observe();
+}
+
+void Plant::step(const Vector7d &command) {
+  const double h = PlantSettings::kControlPeriod / settings_.substeps;
+  const auto &model = *Plant::model();
+  const Vector7d tau_limited = ArrayToVector<7>(clipTorques(
+      saturateTorqueRate(VectorToArray(command), VectorToArray(tau_J_d_))));
+  tau_J_d_ += filter_gain_ * (tau_limited - tau_J_d_);
+
+  // The robot compensates gravity of the load it knows about
+  const Vector7d tau_motor =
+      tau_J_d_ + Eigen::Map<const Vector7d>(model.gravity(state_).data());
+  Vector7d friction;
+  for (int i = 0; i < settings_.substeps; i++) {
+    model.dynamics(q_, dq_, load_, mass_, bias_);
+    mass_.diagonal() += settings_.armature;
+    friction = settings_.viscous_friction.cwiseProduct(dq_);
+    Vector7d tau = tau_motor - friction - bias_;
+    if (settings_.contact) {
+      const Eigen::Matrix<double, 6, 7> jacobian =
+          model.jacobian(q_, settings_.F_T_EE);
+      const Eigen::Vector3d position =
+          model.pose(q_, settings_.F_T_EE).block<3, 1>(0, 3);
+      const Eigen::Vector3d contact_force = _contactForce(
+          settings_.contact_plane, position, jacobian.topRows<3>() * dq_);
+      tau += jacobian.topRows<3>().transpose() * contact_force;
+      force_ = -contact_force;
+    }
+    // Semi-implicit Euler
+    dq_ += h * mass_.llt().solve(tau);
+    q_ += h * dq_;
+  }
+  tau_J_ = tau_motor - friction;
+  time_ += PlantSettings::kControlPeriod;
+  _observe();
+}
+
+void Plant::_observe() {
+  const auto &model = *Plant::model();
+  Eigen::Map<Vector7d>(state_.q.data()) = q_;
+  Eigen::Map<Vector7d>(state_.q_d.data()) = q_;
+  Eigen::Map<Vector7d>(state_.dq.data()) = dq_;
+  Eigen::Map<Vector7d>(state_.dq_d.data()) = dq_;
+  const Eigen::Matrix4d O_T_EE = model.pose(q_, settings_.F_T_EE);
+  Eigen::Map<Eigen::Matrix4d>(state_.O_T_EE.data()) = O_T_EE;
+  Eigen::Map<Eigen::Matrix4d>(state_.O_T_EE_d.data()) = O_T_EE;
+  Eigen::Map<Eigen::Matrix4d>(state_.O_T_EE_c.data()) = O_T_EE;
+  Eigen::Map<Vector7d>(state_.dtau_J.data()) =
+      (tau_J_ - Eigen::Map<const Vector7d>(state_.tau_J.data())) /
+      PlantSettings::kControlPeriod;
+  Eigen::Map<Vector7d>(state_.tau_J.data()) = tau_J_;
+  Eigen::Map<Vector7d>(state_.tau_J_d.data()) = tau_J_d_;
+  // Torque estimate of the unmodeled payload and the contact, like the
+  // difference of measured and model torques on the robot
+  Vector7d tau_ext = Vector7d::Zero();
+  if (payload_) {
+    Eigen::Matrix<double, 7, 7> mass;
+    model.dynamics(q_, Vector7d::Zero(), load_, mass, tau_ext);
+    tau_ext -= Eigen::Map<const Vector7d>(model.gravity(state_).data());
+  }
+  if (settings_.contact) {
+    const Eigen::Matrix<double, 6, 7> jacobian =
+        model.jacobian(q_, settings_.F_T_EE);
+    tau_ext += jacobian.topRows<3>().transpose() * force_;
+  }
+  Eigen::Map<Vector7d>(state_.tau_ext_hat_filtered.data()) = tau_ext;
+  Eigen::Map<Eigen::Vector3d>(state_.O_F_ext_hat_K.data()) = force_;
+  state_.time =
+      franka::Duration(static_cast<uint64_t>(std::round(time_ * 1e3)));
+}
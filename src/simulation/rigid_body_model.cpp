@@ -0,0 +1,290 @@
+#include "simulation/rigid_body_model.h"
+
+#include <cmath>
+
+using namespace simulation;
+
+namespace {
+// Modified Denavit-Hartenberg parameters, a and alpha refer to the previous
+// link
+const double kA[7] = {0.0, 0.0, 0.0, 0.0825, -0.0825, 0.0, 0.088};
+const double kD[7] = {0.333, 0.0, 0.316, 0.0, 0.384, 0.0, 0.0};
+// Cosine and sine of alpha, which is 0 for the first joint and ±pi/2 else
+const double kCosAlpha[7] = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+const double kSinAlpha[7] = {0.0, -1.0, 1.0, 1.0, -1.0, 1.0, 1.0};
+const double kFlangeOffset = 0.107;
+
+const double kLinkMass[7] = {4.970684, 0.646926, 3.228604, 3.587895,
+                             1.225946, 1.666555, 0.735522};
+const double kLinkCom[7][3] = {{0.003875, 0.002081, -0.04762},
+                               {-0.003141, -0.02872, 0.003495},
+                               {0.027518, 0.039252, -0.066502},
+                               {-0.05317, 0.104419, 0.027454},
+                               {-0.011953, 0.041065, -0.038437},
+                               {0.060149, -0.014117, -0.010517},
+                               {0.010517, -0.004252, 0.061597}};
+// xx, xy, xz, yy, yz, zz
+const double kLinkInertia[7][6] = {
+    {0.70337, -0.000139, 0.006772, 0.70661, 0.019169, 0.009117},
+    {0.007962, -0.003925, 0.010254, 0.02811, 0.000704, 0.025995},
+    {0.037242, -0.004761, -0.011396, 0.036155, -0.012805, 0.01083},
+    {0.025853, 0.007796, -0.001332, 0.019552, 0.008641, 0.028323},
+    {0.035549, -0.002117, -0.004037, 0.029474, 0.000229, 0.008627},
+    {0.001964, 0.000109, -0.001158, 0.004354, 0.000341, 0.005433},
+    {0.012516, -0.000428, -0.001196, 0.010027, -0.000741, 0.004815}};
+
+const Eigen::Vector3d kGravity(0.0, 0.0, -9.81);
+
+Eigen::Matrix3d _inertia(const double *i) {
+  Eigen::Matrix3d inertia;
+  inertia << i[0], i[1], i[2], i[1], i[3], i[4], i[2], i[4], i[5];
+  return inertia;
+}
+
+// Inertia with respect to a point displaced by `offset` from the center of
+// mass
+Eigen::Matrix3d _parallelAxis(const Eigen::Matrix3d &inertia, double mass,
+                              const Eigen::Vector3d &offset) {
+  return inertia + mass * (offset.squaredNorm() * Eigen::Matrix3d::Identity() -
+                           offset * offset.transpose());
+}
+
+Load _hand() {
+  Load hand;
+  hand.mass = 0.73;
+  hand.com << -0.01, 0.0, 0.03;
+  hand.inertia.diagonal() << 0.001, 0.0025, 0.0017;
+  return hand;
+}
+
+Eigen::Matrix4d _handTransform() {
+  Eigen::Affine3d transform(Eigen::AngleAxisd(-M_PI_4, Eigen::Vector3d::UnitZ()));
+  transform.translation() << 0.0, 0.0, 0.1034;
+  return transform.matrix();
+}
+}  // namespace
+
+const Load RigidBodyModel::kFrankaHand = _hand();
+const Eigen::Matrix4d RigidBodyModel::kFrankaHandTransform = _handTransform();
+
+Load RigidBodyModel::stateLoad(const franka::RobotState &robot_state) {
+  Load load;
+  load.mass = robot_state.m_total;
+  load.com = Eigen::Map<const Eigen::Vector3d>(robot_state.F_x_Ctotal.data());
+  load.inertia = Eigen::Map<const Eigen::Matrix3d>(robot_state.I_total.data());
+  return load;
+}
+
+std::array<double, 49> RigidBodyModel::mass(
+    const franka::RobotState &robot_state) const {
+  Frames frames;
+  _frames(Eigen::Map<const Vector7d>(robot_state.q.data()), frames);
+  Eigen::Matrix<double, 7, 7> mass = _mass(frames, _links(stateLoad(robot_state)));
+  std::array<double, 49> array;
+  Eigen::Map<Eigen::Matrix<double, 7, 7>>(array.data()) = mass;
+  return array;
+}
+
+std::array<double, 7> RigidBodyModel::coriolis(
+    const franka::RobotState &robot_state) const {
+  Frames frames;
+  _frames(Eigen::Map<const Vector7d>(robot_state.q.data()), frames);
+  return VectorToArray<7>(
+      _bias(frames, Eigen::Map<const Vector7d>(robot_state.dq.data()),
+            _links(stateLoad(robot_state)), false));
+}
+
+std::array<double, 7> RigidBodyModel::gravity(
+    const franka::RobotState &robot_state) const {
+  Frames frames;
+  _frames(Eigen::Map<const Vector7d>(robot_state.q.data()), frames);
+  return VectorToArray<7>(
+      _bias(frames, Vector7d::Zero(), _links(stateLoad(robot_state)), true));
+}
+
+std::array<double, 42> RigidBodyModel::zeroJacobian(
+    franka::Frame frame, const franka::RobotState &robot_state) const {
+  Frames frames;
+  _frames(Eigen::Map<const Vector7d>(robot_state.q.data()), frames);
+  Eigen::Matrix<double, 6, 7> jacobian;
+  const int index = static_cast<int>(frame);
+  if (index < 7) {
+    // Joint frames only move with the joints up to their own
+    jacobian = _jacobian(frames, index, frames.origin[index]);
+  } else {
+    const Eigen::Matrix4d F_T_X = _frameTransform(frame, robot_state);
+    jacobian = _jacobian(frames, 6,
+                         frames.origin[7] +
+                             frames.rotation[7] * F_T_X.block<3, 1>(0, 3));
+  }
+  std::array<double, 42> array;
+  Eigen::Map<Eigen::Matrix<double, 6, 7>>(array.data()) = jacobian;
+  return array;
+}
+
+void RigidBodyModel::dynamics(const Vector7d &q, const Vector7d &dq,
+                              const Load &load,
+                              Eigen::Matrix<double, 7, 7> &mass,
+                              Vector7d &bias) const {
+  Frames frames;
+  _frames(q, frames);
+  const Links links = _links(load);
+  mass = _mass(frames, links);
+  bias = _bias(frames, dq, links, true);
+}
+
+Eigen::Matrix4d RigidBodyModel::pose(const Vector7d &q,
+                                     const Eigen::Matrix4d &F_T_X) const {
+  Frames frames;
+  _frames(q, frames);
+  Eigen::Matrix4d O_T_F = Eigen::Matrix4d::Identity();
+  O_T_F.block<3, 3>(0, 0) = frames.rotation[7];
+  O_T_F.block<3, 1>(0, 3) = frames.origin[7];
+  return O_T_F * F_T_X;
+}
+
+Eigen::Matrix<double, 6, 7> RigidBodyModel::jacobian(
+    const Vector7d &q, const Eigen::Matrix4d &F_T_X) const {
+  Frames frames;
+  _frames(q, frames);
+  return _jacobian(
+      frames, 6,
+      frames.origin[7] + frames.rotation[7] * F_T_X.block<3, 1>(0, 3));
+}
+
+void RigidBodyModel::_frames(const Vector7d &q, Frames &frames) const {
+  Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+  Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  for (int i = 0; i < 7; i++) {
+    const double ca = kCosAlpha[i], sa = kSinAlpha[i];
+    const double ct = std::cos(q[i]), st = std::sin(q[i]);
+    Eigen::Matrix3d local;
+    local << ct, -st, 0.0, ca * st, ca * ct, -sa, sa * st, sa * ct, ca;
+    origin += rotation.col(0) * kA[i];
+    rotation = rotation * local;
+    origin += rotation.col(2) * kD[i];
+    frames.rotation[i] = rotation;
+    frames.origin[i] = origin;
+  }
+  frames.rotation[7] = rotation;
+  frames.origin[7] = origin + rotation.col(2) * kFlangeOffset;
+}
+
+RigidBodyModel::Links RigidBodyModel::_links(const Load &load) const {
+  Links links;
+  for (int i = 0; i < 7; i++) {
+    links.mass[i] = kLinkMass[i];
+    links.com[i] = Eigen::Map<const Eigen::Vector3d>(kLinkCom[i]);
+    links.inertia[i] = _inertia(kLinkInertia[i]);
+  }
+  if (load.mass <= 0.0) return links;
+  // The flange frame is the last link frame shifted along its z-axis
+  const Eigen::Vector3d load_com =
+      load.com + Eigen::Vector3d(0.0, 0.0, kFlangeOffset);
+  const double mass = links.mass[6] + load.mass;
+  const Eigen::Vector3d com =
+      (links.mass[6] * links.com[6] + load.mass * load_com) / mass;
+  links.inertia[6] =
+      _parallelAxis(links.inertia[6], links.mass[6], links.com[6] - com) +
+      _parallelAxis(load.inertia, load.mass, load_com - com);
+  links.mass[6] = mass;
+  links.com[6] = com;
+  return links;
+}
+
+Eigen::Matrix<double, 7, 7> RigidBodyModel::_mass(const Frames &frames,
+                                                  const Links &links) const {
+  // Composite rigid body algorithm in the base frame. The bodies distal to
+  // joint i are lumped with their mass, first moment and inertia about the
+  // base origin. Column i of the mass matrix is the momentum of the
+  // composite rotating about joint i at unit rate, projected on the joint
+  // axes about their origins.
+  Eigen::Matrix<double, 7, 7> mass;
+  double composite_mass = 0.0;
+  Eigen::Vector3d moment = Eigen::Vector3d::Zero();
+  Eigen::Matrix3d inertia = Eigen::Matrix3d::Zero();
+  for (int i = 6; i >= 0; i--) {
+    const Eigen::Matrix3d &rotation = frames.rotation[i];
+    const Eigen::Vector3d com = frames.origin[i] + rotation * links.com[i];
+    composite_mass += links.mass[i];
+    moment += links.mass[i] * com;
+    inertia += rotation * links.inertia[i] * rotation.transpose() +
+               links.mass[i] * (com.squaredNorm() * Eigen::Matrix3d::Identity() -
+                                com * com.transpose());
+
+    const Eigen::Vector3d axis = rotation.col(2);
+    const Eigen::Vector3d velocity = -axis.cross(frames.origin[i]);
+    const Eigen::Vector3d linear =
+        composite_mass * velocity + axis.cross(moment);
+    const Eigen::Vector3d angular = inertia * axis + moment.cross(velocity);
+    for (int j = 0; j <= i; j++) {
+      mass(j, i) = frames.rotation[j].col(2).dot(
+          angular - frames.origin[j].cross(linear));
+      mass(i, j) = mass(j, i);
+    }
+  }
+  return mass;
+}
+
+Vector7d RigidBodyModel::_bias(const Frames &frames, const Vector7d &dq,
+                               const Links &links, bool with_gravity) const {
+  // Forward pass in the base frame, gravity enters as acceleration of the
+  // base
+  std::array<Eigen::Vector3d, 7> w, dw, a_com, r_com;
+  Eigen::Vector3d w_parent = Eigen::Vector3d::Zero();
+  Eigen::Vector3d dw_parent = Eigen::Vector3d::Zero();
+  Eigen::Vector3d a_origin =
+      with_gravity ? Eigen::Vector3d(-kGravity) : Eigen::Vector3d::Zero();
+  Eigen::Vector3d origin_parent = Eigen::Vector3d::Zero();
+  for (int i = 0; i < 7; i++) {
+    const Eigen::Vector3d axis = frames.rotation[i].col(2);
+    const Eigen::Vector3d offset = frames.origin[i] - origin_parent;
+    a_origin += dw_parent.cross(offset) + w_parent.cross(w_parent.cross(offset));
+    w[i] = w_parent + axis * dq[i];
+    dw[i] = dw_parent + w_parent.cross(axis * dq[i]);
+    r_com[i] = frames.rotation[i] * links.com[i];
+    a_com[i] = a_origin + dw[i].cross(r_com[i]) + w[i].cross(w[i].cross(r_com[i]));
+    w_parent = w[i];
+    dw_parent = dw[i];
+    origin_parent = frames.origin[i];
+  }
+
+  // Backward pass, forces and moments about the link frame origins
+  Vector7d tau;
+  Eigen::Vector3d f = Eigen::Vector3d::Zero();
+  Eigen::Vector3d n = Eigen::Vector3d::Zero();
+  for (int i = 6; i >= 0; i--) {
+    const Eigen::Matrix3d inertia =
+        frames.rotation[i] * links.inertia[i] * frames.rotation[i].transpose();
+    const Eigen::Vector3d force = links.mass[i] * a_com[i];
+    const Eigen::Vector3d moment =
+        inertia * dw[i] + w[i].cross(inertia * w[i]);
+    if (i < 6) {
+      n += (frames.origin[i + 1] - frames.origin[i]).cross(f);
+    }
+    f += force;
+    n += moment + r_com[i].cross(force);
+    tau[i] = frames.rotation[i].col(2).dot(n);
+  }
+  return tau;
+}
+
+Eigen::Matrix<double, 6, 7> RigidBodyModel::_jacobian(
+    const Frames &frames, int frame, const Eigen::Vector3d &point) const {
+  Eigen::Matrix<double, 6, 7> jacobian = Eigen::Matrix<double, 6, 7>::Zero();
+  for (int j = 0; j <= frame; j++) {
+    const Eigen::Vector3d axis = frames.rotation[j].col(2);
+    jacobian.block<3, 1>(0, j) = axis.cross(point - frames.origin[j]);
+    jacobian.block<3, 1>(3, j) = axis;
+  }
+  return jacobian;
+}
+
+Eigen::Matrix4d RigidBodyModel::_frameTransform(
+    franka::Frame frame, const franka::RobotState &robot_state) const {
+  if (frame == franka::Frame::kFlange) return Eigen::Matrix4d::Identity();
+  const Eigen::Matrix4d F_T_EE =
+      Eigen::Map<const Eigen::Matrix4d>(robot_state.F_T_EE.data());
+  if (frame == franka::Frame::kEndEffector) return F_T_EE;
+  return F_T_EE * Eigen::Map<const Eigen::Matrix4d>(robot_state.EE_T_K.data());
+}
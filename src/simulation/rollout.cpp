@@ -0,0 +1,178 @@
+#include "simulation/rollout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+using namespace simulation;
+
+namespace {
+void _validate(const RolloutSettings &settings) {
+  if (settings.duration <= 0.0) {
+    throw std::invalid_argument("Rollout duration must be positive.");
+  }
+  if (settings.setpoint_size < objectiveSize(settings.objective)) {
+    throw std::invalid_argument(
+        "Setpoint rows must start with the objective signal.");
+  }
+  if (settings.setpoints.empty() ||
+      settings.setpoints.size() % settings.setpoint_size != 0) {
+    throw std::invalid_argument(
+        "Setpoints must hold at least one complete row.");
+  }
+}
+}  // namespace
+
+size_t simulation::objectiveSize(Objective objective) {
+  return objective == Objective::kJointPosition ? 7 : 3;
+}
+
+RolloutResult simulation::rollout(TorqueController &controller,
+                                  const RolloutSettings &settings) {
+  _validate(settings);
+  if (!controller.acceptsSetpoint(settings.setpoint_size)) {
+    throw std::invalid_argument(controller.name() +
+                                " doesn't accept setpoints of size " +
+                                std::to_string(settings.setpoint_size) + ".");
+  }
+  const double dt = RolloutSettings::kControlPeriod;
+  const size_t ticks = static_cast<size_t>(std::round(settings.duration / dt));
+  const size_t size = settings.setpoint_size;
+  const size_t rows = settings.setpoints.size() / size;
+  const size_t objective_size = objectiveSize(settings.objective);
+  const auto model = Plant::model();
+  Plant plant(settings);
+  const franka::RobotState &state = plant.getState();
+
+  RolloutResult result;
+  if (settings.record) result.trace.reserve(ticks * objective_size);
+
+  auto objective = [&](Eigen::Ref<Eigen::VectorXd> y) {
+    switch (settings.objective) {
+      case Objective::kJointPosition:
+        y = plant.getJointPositions();
+        break;
+      case Objective::kCartesianPosition:
+        y = Eigen::Map<const Eigen::Matrix4d>(state.O_T_EE.data())
+                .block<3, 1>(0, 3);
+        break;
+      case Objective::kForce:
+        y = plant.getForce();
+        break;
+    }
+  };
+
+  Eigen::VectorXd y(objective_size), y_init(objective_size);
+  objective(y_init);
+
+  // Overshoot and settling refer to the step to the final setpoint
+  const Eigen::Map<const Eigen::VectorXd> reference_final(
+      settings.setpoints.data() + (rows - 1) * size, objective_size);
+  const Eigen::VectorXd step = reference_final - y_init;
+  const double step_size = step.norm();
+  const double band = settings.settling_tolerance * step_size;
+  double sum = 0.0, excursion = 0.0;
+  size_t count = 0, last_outside = 0;
+  bool outside = false;
+
+  controller.setTime(0);
+  controller.start(state, model);
+  franka::Duration period(1);
+  for (size_t tick = 0; tick < ticks; tick++) {
+    const double *row = settings.setpoints.data() + std::min(tick, rows - 1) * size;
+    if (tick < rows) controller.applySetpoint(row, size);
+    controller.setTime(controller.getTime() + dt);
+
+    Vector7d command;
+    bool finished = false;
+    try {
+      franka::Torques torques = controller.step(state, period);
+      command = Eigen::Map<const Vector7d>(torques.tau_J.data());
+      finished = torques.motion_finished;
+    } catch (const std::exception &e) {
+      result.failed = true;
+      result.error = e.what();
+      break;
+    }
+    if (!command.allFinite()) {
+      result.failed = true;
+      result.error = "Commanded torques are not finite.";
+      break;
+    }
+
+    const Vector7d rate = (command - plant.getCommandedTorques()).cwiseAbs();
+    if ((rate.array() > kDeltaTauMax).any()) result.torque_rate_violations++;
+    if ((command.cwiseAbs().array() > kTauJMax.array()).any()) {
+      result.torque_limit_violations++;
+    }
+    result.max_torque_rate = std::max(result.max_torque_rate, rate.maxCoeff() / dt);
+    plant.step(command);
+    result.duration = plant.getTime();
+
+    const Vector7d &q = plant.getJointPositions();
+    if (!q.allFinite() || !plant.getJointVelocities().allFinite()) {
+      result.failed = true;
+      result.error = "Simulation diverged.";
+      break;
+    }
+    if ((q.array() < kLowerJointLimits.array()).any() ||
+        (q.array() > kUpperJointLimits.array()).any()) {
+      result.failed = true;
+      result.error = "Joint position limits violated.";
+      break;
+    }
+
+    objective(y);
+    const Eigen::Map<const Eigen::VectorXd> reference(row, objective_size);
+    const double error = (y - reference).norm();
+    sum += error * error;
+    count++;
+    result.max_error = std::max(result.max_error, error);
+    result.final_error = error;
+    if (step_size > 0.0) {
+      excursion = std::max(excursion, (y - reference_final).dot(step));
+    }
+    if (tick + 1 >= rows && (y - reference_final).norm() > band) {
+      outside = true;
+      last_outside = tick;
+    }
+    if (settings.record) {
+      result.trace.insert(result.trace.end(), y.data(), y.data() + y.size());
+    }
+    if (finished) break;
+  }
+  controller.stop(state, model);
+
+  if (count == 0) return result;
+  result.rms_error = std::sqrt(sum / count);
+  if (step_size > 0.0) result.overshoot = excursion / (step_size * step_size);
+  // Time from the last setpoint change until the error last left the band
+  const double change = (rows - 1) * dt;
+  if (!result.failed && (!outside || last_outside + 1 < count)) {
+    result.settling_time =
+        outside ? std::max((last_outside + 1) * dt - change, 0.0) : 0.0;
+  }
+  return result;
+}
+
+std::vector<RolloutResult> simulation::rollouts(
+    const std::vector<std::shared_ptr<TorqueController>> &controllers,
+    const RolloutSettings &settings, ThreadPool::Priority priority) {
+  _validate(settings);
+  std::set<TorqueController *> instances;
+  for (const auto &controller : controllers) {
+    if (!controller) throw std::invalid_argument("Controller is None.");
+    if (!instances.insert(controller.get()).second) {
+      throw std::invalid_argument(
+          "Controllers are modified by the rollout and must be distinct "
+          "instances.");
+    }
+  }
+  std::vector<RolloutResult> results(controllers.size());
+  ThreadPool::instance().parallelFor(
+      controllers.size(),
+      [&](size_t i) { results[i] = rollout(*controllers[i], settings); },
+      priority);
+  return results;
+}
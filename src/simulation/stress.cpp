@@ -0,0 +1,456 @@
+#include "simulation/stress.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "trace.h"
+
+using namespace simulation;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double _seconds(Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+Clock::duration _duration(double seconds) {
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(seconds));
+}
+
+void _spinUntil(Clock::time_point until) {
+  while (Clock::now() < until) {
+  }
+}
+
+// Sleep in short slices so threads notice the end of the run
+void _sleepUntil(Clock::time_point until, const std::atomic<bool> &done) {
+  while (!done.load(std::memory_order_relaxed)) {
+    const auto now = Clock::now();
+    if (now >= until) return;
+    std::this_thread::sleep_for(
+        std::min<Clock::duration>(until - now, std::chrono::milliseconds(10)));
+  }
+}
+
+// Same scheduling libfranka requests with RealtimeConfig::kEnforce
+bool _setRealtime() {
+#ifdef __linux__
+  sched_param param;
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+  return false;
+#endif
+}
+
+bool _pin(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+}  // namespace
+
+LatencyStats LatencyStats::of(std::vector<double> samples) {
+  LatencyStats stats;
+  if (samples.empty()) return stats;
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double p) {
+    const size_t i = static_cast<size_t>(std::ceil(p * samples.size()));
+    return samples[std::min(std::max<size_t>(i, 1), samples.size()) - 1];
+  };
+  stats.mean =
+      std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  stats.p999 = percentile(0.999);
+  stats.max = samples.back();
+  return stats;
+}
+
+StressTest::StressTest(const StressSettings &settings) : settings_(settings) {
+  if (settings.duration <= 0.0) {
+    throw std::invalid_argument("Duration must be positive.");
+  }
+  if (settings.deadline <= 0.0) {
+    throw std::invalid_argument("Deadline must be positive.");
+  }
+  if (settings.delay < 0.0 || settings.delay_probability < 0.0 ||
+      settings.delay_probability > 1.0) {
+    throw std::invalid_argument(
+        "Delay must be non-negative and its probability in [0, 1].");
+  }
+  if (settings.gil_hold_time < 0.0 || settings.gil_period <= 0.0) {
+    throw std::invalid_argument(
+        "GIL hold time must be non-negative and its period positive.");
+  }
+  if (settings.burst_size > 0 && settings.burst_interval <= 0.0) {
+    throw std::invalid_argument("Burst interval must be positive.");
+  }
+  if (!settings.setpoints.empty()) {
+    if (settings.block_size == 0) {
+      throw std::invalid_argument(
+          "Setpoints are published through the tick group, a block size is "
+          "required.");
+    }
+    if (settings.setpoint_size == 0 ||
+        settings.setpoints.size() % settings.setpoint_size != 0) {
+      throw std::invalid_argument(
+          "Setpoints must consist of whole rows of the setpoint size.");
+    }
+  }
+  if (settings.cpu < -1) {
+    throw std::invalid_argument("CPU must be -1 or a valid index.");
+  }
+  // Validates the plant settings
+  Plant plant(settings.plant);
+  panda_ = std::unique_ptr<Panda>(new Panda("stress", Plant::model()));
+}
+
+StressTest::~StressTest() = default;
+
+StressResult StressTest::run(std::shared_ptr<TorqueController> controller) {
+  if (!controller) {
+    throw std::invalid_argument("Controller must not be None.");
+  }
+  if (!settings_.setpoints.empty() &&
+      !controller->acceptsSetpoint(settings_.setpoint_size)) {
+    throw std::invalid_argument(
+        "The controller doesn't accept setpoints with " +
+        std::to_string(settings_.setpoint_size) + " columns.");
+  }
+  Panda &panda = *panda_;
+  Plant plant(settings_.plant);
+  panda.virtual_walls_->reset();
+  panda.current_controller_ = controller;
+  controller->setTime(0);
+  controller->start(plant.getState(), panda.robot_model_);
+  // The control path of a connected robot
+  TorqueCallback callback = panda._createTorqueCallback();
+  franka::Torques command({0, 0, 0, 0, 0, 0, 0});
+  const bool simulate = settings_.simulate;
+
+  StressResult result = _run(
+      plant.getState(),
+      [&](const franka::RobotState &state, franka::Duration period) {
+        command = callback(state, period);
+        return false;
+      },
+      [&](franka::RobotState &state) {
+        if (simulate) {
+          plant.step(ArrayToVector<7>(command.tau_J));
+          state = plant.getState();
+        } else {
+          state.tau_J_d = command.tau_J;
+          state.time = state.time + franka::Duration(1);
+        }
+      });
+  if (controller->isRunning()) {
+    controller->stop(plant.getState(), panda.robot_model_);
+  }
+  panda.current_controller_ = nullptr;
+  return result;
+}
+
+StressResult StressTest::run(std::shared_ptr<motion::Generator> generator) {
+  if (!generator) {
+    throw std::invalid_argument("Generator must not be None.");
+  }
+  if (!settings_.setpoints.empty()) {
+    throw std::invalid_argument("Generators don't accept setpoints.");
+  }
+  const double dt = StressSettings::kControlPeriod;
+  Panda &panda = *panda_;
+  const franka::RobotState initial = Plant(settings_.plant).getState();
+  generator->setTime(0);
+  generator->start(&panda, initial, nullptr);
+
+  // The robot follows the commands exactly
+  Tick tick;
+  Advance advance;
+  if (auto joint =
+          std::dynamic_pointer_cast<motion::JointGenerator>(generator)) {
+    auto command = std::make_shared<franka::JointPositions>(initial.q);
+    tick = [joint, command](const franka::RobotState &state,
+                            franka::Duration period) {
+      *command = joint->step(state, period);
+      return command->motion_finished;
+    };
+    advance = [command, dt](franka::RobotState &state) {
+      const Vector7d q = ArrayToVector<7>(command->q);
+      const Vector7d dq = (q - ArrayToVector<7>(state.q)) / dt;
+      Eigen::Map<Vector7d>(state.ddq_d.data()) =
+          (dq - ArrayToVector<7>(state.dq)) / dt;
+      state.q = state.q_d = command->q;
+      Eigen::Map<Vector7d>(state.dq.data()) = dq;
+      state.dq_d = state.dq;
+    };
+  } else if (auto velocity = std::dynamic_pointer_cast<
+                 motion::JointVelocityGenerator>(generator)) {
+    auto command = std::make_shared<franka::JointVelocities>(initial.dq);
+    tick = [velocity, command](const franka::RobotState &state,
+                               franka::Duration period) {
+      *command = velocity->step(state, period);
+      return command->motion_finished;
+    };
+    advance = [command, dt](franka::RobotState &state) {
+      const Vector7d dq = ArrayToVector<7>(command->dq);
+      Eigen::Map<Vector7d>(state.ddq_d.data()) =
+          (dq - ArrayToVector<7>(state.dq)) / dt;
+      Eigen::Map<Vector7d>(state.q.data()) += dt * dq;
+      state.q_d = state.q;
+      state.dq = state.dq_d = command->dq;
+    };
+  } else if (auto cartesian =
+                 std::dynamic_pointer_cast<motion::CartesianGenerator>(
+                     generator)) {
+    auto command = std::make_shared<franka::CartesianPose>(initial.O_T_EE);
+    tick = [cartesian, command](const franka::RobotState &state,
+                                franka::Duration period) {
+      *command = cartesian->step(state, period);
+      return command->motion_finished;
+    };
+    advance = [command](franka::RobotState &state) {
+      state.O_T_EE = state.O_T_EE_d = state.O_T_EE_c = command->O_T_EE;
+      if (command->hasElbow()) {
+        state.elbow = state.elbow_d = state.elbow_c = command->elbow;
+      }
+    };
+  } else if (auto twist = std::dynamic_pointer_cast<
+                 motion::CartesianVelocityGenerator>(generator)) {
+    auto command =
+        std::make_shared<franka::CartesianVelocities>(initial.O_dP_EE_c);
+    tick = [twist, command](const franka::RobotState &state,
+                            franka::Duration period) {
+      *command = twist->step(state, period);
+      return command->motion_finished;
+    };
+    advance = [command, dt](franka::RobotState &state) {
+      const Eigen::Map<const Eigen::Matrix<double, 6, 1>> velocity(
+          command->O_dP_EE.data());
+      Eigen::Map<Eigen::Matrix<double, 6, 1>> acceleration(
+          state.O_ddP_EE_c.data());
+      acceleration =
+          (velocity - Eigen::Map<const Eigen::Matrix<double, 6, 1>>(
+                          state.O_dP_EE_c.data())) /
+          dt;
+      Eigen::Map<Eigen::Matrix4d> pose(state.O_T_EE.data());
+      pose.block<3, 1>(0, 3) += dt * velocity.head<3>();
+      const double angle = dt * velocity.tail<3>().norm();
+      if (angle > 0.0) {
+        pose.block<3, 3>(0, 0) =
+            Eigen::AngleAxisd(angle, velocity.tail<3>().normalized())
+                .toRotationMatrix() *
+            pose.block<3, 3>(0, 0);
+      }
+      state.O_T_EE_d = state.O_T_EE_c = state.O_T_EE;
+      state.O_dP_EE_d = state.O_dP_EE_c = command->O_dP_EE;
+    };
+  } else {
+    throw std::invalid_argument("Unsupported generator " + generator->name() +
+                                ".");
+  }
+
+  StressResult result = _run(initial, tick, advance);
+  if (generator->isRunning()) {
+    generator->stop(panda.state_, nullptr);
+  }
+  return result;
+}
+
+StressResult StressTest::_run(const franka::RobotState &initial,
+                              const Tick &tick, const Advance &advance) {
+  TraceScope scope("stress", "run");
+  const auto &settings = settings_;
+  const size_t num_ticks = static_cast<size_t>(
+      std::ceil(settings.duration / StressSettings::kControlPeriod));
+  StressResult result;
+  std::mutex error_mux;
+  auto fail = [&](const std::string &error) {
+    std::lock_guard<std::mutex> lock(error_mux);
+    if (!result.failed) {
+      result.failed = true;
+      result.error = error;
+    }
+  };
+
+  std::shared_ptr<TickGroup> tick_group;
+  if (settings.block_size > 0) {
+    tick_group = std::make_shared<TickGroup>(settings.block_size);
+  }
+  panda_->_setTickGroup(tick_group);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < settings.cpu_burners; i++) {
+    threads.emplace_back([&done]() {
+      Tracer::instance().setThreadName("stress cpu burner");
+      volatile double sink = 1.0;
+      while (!done.load(std::memory_order_relaxed)) {
+        sink = sink * 1.0000001 + 1e-9;
+      }
+    });
+  }
+  std::atomic<size_t> gil_holds{0};
+  for (size_t i = 0; i < settings.gil_holders; i++) {
+    threads.emplace_back([&]() {
+      Tracer::instance().setThreadName("stress gil holder");
+      while (!done.load(std::memory_order_relaxed)) {
+        const auto begin = Clock::now();
+        {
+          TracedGilAcquire acquire("stress");
+          TraceScope hold_scope("stress", "hold_gil");
+          _spinUntil(Clock::now() + _duration(settings.gil_hold_time));
+        }
+        gil_holds++;
+        _sleepUntil(begin + _duration(settings.gil_period), done);
+      }
+    });
+  }
+  if (tick_group) {
+    threads.emplace_back([&]() {
+      Tracer::instance().setThreadName("stress consumer");
+      uint64_t sequence = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        if (!tick_group->wait(0.01)) continue;
+        TraceScope read_scope("stress", "read_block");
+        const uint64_t next = tick_group->read().sequence;
+        if (sequence > 0 && next > sequence + 1) {
+          result.blocks_dropped += next - sequence - 1;
+        }
+        sequence = next;
+        result.blocks_read++;
+      }
+    });
+  }
+  std::vector<double> producer_latencies;
+  if (settings.burst_size > 0 &&
+      (settings.producer || !settings.setpoints.empty())) {
+    threads.emplace_back([&]() {
+      Tracer::instance().setThreadName("stress producer");
+      TickGroup::RowMatrixXd setpoints;
+      if (!settings.setpoints.empty()) {
+        setpoints = Eigen::Map<const TickGroup::RowMatrixXd>(
+            settings.setpoints.data(),
+            settings.setpoints.size() / settings.setpoint_size,
+            settings.setpoint_size);
+      }
+      auto next = Clock::now();
+      while (!done.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < settings.burst_size; i++) {
+          const auto begin = Clock::now();
+          try {
+            TraceScope produce_scope("stress", "produce");
+            if (setpoints.size() > 0) tick_group->setSetpoints(setpoints);
+            if (settings.producer) settings.producer();
+          } catch (const std::exception &e) {
+            fail(std::string("Producer failed: ") + e.what());
+            return;
+          }
+          producer_latencies.push_back(_seconds(Clock::now() - begin));
+        }
+        next += _duration(settings.burst_interval);
+        _sleepUntil(next, done);
+      }
+    });
+  }
+
+  std::vector<double> wakeup, callback, response;
+  wakeup.reserve(num_ticks);
+  callback.reserve(num_ticks);
+  response.reserve(num_ticks);
+  std::thread loop([&]() {
+    Tracer::instance().setThreadName("control (stress)");
+    Tracer::instance().prepareRealTimeThread();
+    if (settings.realtime) result.realtime = _setRealtime();
+    if (settings.cpu >= 0 && !_pin(settings.cpu)) {
+      fail("Failed to pin the loop to CPU " + std::to_string(settings.cpu) +
+           ".");
+      return;
+    }
+    std::mt19937 random(settings.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const auto period = _duration(StressSettings::kControlPeriod);
+    const double delay = settings.delay;
+    franka::RobotState state = initial;
+    size_t misses = 0;
+    double worst = -1.0;
+    const auto start = Clock::now() + period;
+    for (size_t k = 0; k < num_ticks; k++) {
+      const auto nominal = start + static_cast<int64_t>(k) * period;
+      std::this_thread::sleep_until(nominal);
+      const auto begin = Clock::now();
+      const bool delayed =
+          delay > 0.0 && uniform(random) < settings.delay_probability;
+      if (delayed) {
+        TraceScope delay_scope("stress", "injected_delay");
+        _spinUntil(begin + _duration(delay));
+        result.injected_delays++;
+      }
+      bool finished;
+      try {
+        finished = tick(state, franka::Duration(k == 0 ? 0 : 1));
+      } catch (const std::exception &e) {
+        fail(e.what());
+        break;
+      }
+      const auto end = Clock::now();
+      result.ticks++;
+
+      wakeup.push_back(_seconds(begin - nominal));
+      callback.push_back(_seconds(end - begin));
+      response.push_back(_seconds(end - nominal));
+      if (callback.back() - (delayed ? delay : 0.0) >
+          settings.blocking_threshold) {
+        result.blocked_ticks++;
+      }
+      if (response.back() > settings.deadline) {
+        result.deadline_misses++;
+        result.max_consecutive_misses =
+            std::max(result.max_consecutive_misses, ++misses);
+        Tracer::instance().instant("stress", "deadline_miss");
+      } else {
+        misses = 0;
+      }
+      if (response.back() > worst) {
+        worst = response.back();
+        result.worst_tick_time = k * StressSettings::kControlPeriod;
+      }
+      if (finished) break;
+      advance(state);
+    }
+  });
+  loop.join();
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  panda_->_setTickGroup(nullptr);
+
+  result.wakeup = LatencyStats::of(std::move(wakeup));
+  result.callback = LatencyStats::of(std::move(callback));
+  result.response = LatencyStats::of(std::move(response));
+  result.producer_calls = producer_latencies.size();
+  result.producer = LatencyStats::of(std::move(producer_latencies));
+  result.gil_holds = gil_holds;
+  return result;
+}
@@ -0,0 +1,246 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "trace.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+// Pool and worker index of the current thread, used to push tasks posted
+// from within a task to the worker's own deque.
+thread_local ThreadPool *tl_pool = nullptr;
+thread_local size_t tl_index = 0;
+
+std::vector<int> _allowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
+}  // namespace
+
+ThreadPool &ThreadPool::instance() {
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool(size_t num_threads,
+                       const std::vector<int> &excluded_cpus) {
+  std::lock_guard<std::mutex> lock(config_mux_);
+  _start(num_threads, excluded_cpus);
+}
+
+ThreadPool::~ThreadPool() {
+  std::lock_guard<std::mutex> lock(config_mux_);
+  _stop();
+}
+
+void ThreadPool::configure(size_t num_threads,
+                           const std::vector<int> &excluded_cpus) {
+  if (tl_pool == this) {
+    throw std::runtime_error(
+        "The thread pool can't be reconfigured from one of its tasks.");
+  }
+  std::lock_guard<std::mutex> lock(config_mux_);
+  _stop();
+  _start(num_threads, excluded_cpus);
+}
+
+size_t ThreadPool::getNumThreads() const { return num_threads_; }
+
+std::vector<int> ThreadPool::getExcludedCpus() const {
+  std::lock_guard<std::mutex> lock(config_mux_);
+  return excluded_cpus_;
+}
+
+std::vector<int> ThreadPool::getCpus() const {
+  std::lock_guard<std::mutex> lock(config_mux_);
+  return cpus_;
+}
+
+void ThreadPool::_start(size_t num_threads,
+                        const std::vector<int> &excluded_cpus) {
+  const std::vector<int> allowed = _allowedCpus();
+  excluded_cpus_ = excluded_cpus;
+  // Keep a CPU free of workers for the control thread unless the caller
+  // reserved one explicitly
+  if (excluded_cpus_.empty() && allowed.size() > 1) {
+    excluded_cpus_.push_back(allowed.back());
+  }
+  cpus_.clear();
+  for (int cpu : allowed) {
+    if (std::find(excluded_cpus_.begin(), excluded_cpus_.end(), cpu) ==
+        excluded_cpus_.end()) {
+      cpus_.push_back(cpu);
+    }
+  }
+  if (num_threads == 0) {
+    size_t available = cpus_.size();
+    if (allowed.empty()) {
+      // Affinity unknown, leave one core to the control thread
+      available = std::thread::hardware_concurrency();
+      if (available > 1) available--;
+    }
+    num_threads = std::max<size_t>(1, available);
+  }
+  stopping_ = false;
+  workers_.clear();
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(new Worker());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(&ThreadPool::_run, this, i);
+    _pin(threads_.back());
+  }
+  num_threads_ = num_threads;
+}
+
+void ThreadPool::_stop() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mux_);
+    stopping_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto &thread : threads_) {
+    if (thread.joinable()) thread.join();
+  }
+  threads_.clear();
+}
+
+void ThreadPool::_pin(std::thread &thread) {
+#ifdef __linux__
+  if (cpus_.empty() || excluded_cpus_.empty()) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus_) CPU_SET(cpu, &set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
+
+void ThreadPool::post(Task task, Priority priority) {
+  const size_t p = static_cast<size_t>(priority);
+  // Count the task before it can be popped, so pending_ never underflows
+  auto count = [this]() {
+    std::lock_guard<std::mutex> lock(sleep_mux_);
+    pending_++;
+  };
+  if (tl_pool == this) {
+    // Posted from a worker, keep it local
+    Worker &worker = *workers_[tl_index];
+    count();
+    std::lock_guard<std::mutex> lock(worker.mux);
+    worker.tasks[p].push_back(std::move(task));
+  } else {
+    std::lock_guard<std::mutex> config_lock(config_mux_);
+    Worker &worker = *workers_[next_worker_++ % workers_.size()];
+    count();
+    std::lock_guard<std::mutex> lock(worker.mux);
+    worker.tasks[p].push_back(std::move(task));
+  }
+  sleep_cv_.notify_one();
+}
+
+bool ThreadPool::_pop(size_t index, Task &task) {
+  const size_t n = workers_.size();
+  for (size_t p = 0; p < kNumPriorities; p++) {
+    // Own deque first, newest task for cache locality
+    {
+      Worker &own = *workers_[index];
+      std::lock_guard<std::mutex> lock(own.mux);
+      if (!own.tasks[p].empty()) {
+        task = std::move(own.tasks[p].back());
+        own.tasks[p].pop_back();
+        return true;
+      }
+    }
+    // Steal the oldest task of another worker
+    for (size_t k = 1; k < n; k++) {
+      Worker &victim = *workers_[(index + k) % n];
+      std::lock_guard<std::mutex> lock(victim.mux);
+      if (!victim.tasks[p].empty()) {
+        task = std::move(victim.tasks[p].front());
+        victim.tasks[p].pop_front();
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ThreadPool::_run(size_t index) {
+  tl_pool = this;
+  tl_index = index;
+  Tracer::instance().setThreadName("worker " + std::to_string(index));
+  Task task;
+  while (true) {
+    if (_pop(index, task)) {
+      pending_--;
+      TraceScope scope("pool", "task");
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mux_);
+    if (stopping_ && pending_ == 0) break;
+    sleep_cv_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+    if (stopping_ && pending_ == 0) break;
+  }
+  tl_pool = nullptr;
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)> &f,
+                             Priority priority) {
+  if (n == 0) return;
+  struct State {
+    std::atomic<size_t> next{0}, done{0};
+    std::atomic<bool> failed{false};
+    size_t n;
+    const std::function<void(size_t)> *f;
+    std::exception_ptr error;
+    std::mutex mux;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<State>();
+  state->n = n;
+  state->f = &f;
+
+  auto run = [](const std::shared_ptr<State> &s) {
+    for (size_t i = s->next++; i < s->n; i = s->next++) {
+      if (!s->failed) {
+        try {
+          (*s->f)(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(s->mux);
+          if (!s->failed.exchange(true)) s->error = std::current_exception();
+        }
+      }
+      if (++s->done == s->n) {
+        { std::lock_guard<std::mutex> lock(s->mux); }
+        s->cv.notify_all();
+      }
+    }
+  };
+
+  const size_t num_helpers = std::min(n - 1, getNumThreads());
+  for (size_t i = 0; i < num_helpers; i++) {
+    post([state, run]() { run(state); }, priority);
+  }
+  run(state);
+
+  std::unique_lock<std::mutex> lock(state->mux);
+  state->cv.wait(lock, [&] { return state->done == n; });
+  if (state->error) std::rethrow_exception(state->error);
+}
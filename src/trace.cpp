@@ -0,0 +1,261 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+uint32_t _threadId() {
+#ifdef __linux__
+  return static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+  static std::atomic<uint32_t> next_tid{1};
+  return next_tid++;
+#endif
+}
+
+uint32_t _processId() {
+#ifdef __linux__
+  return static_cast<uint32_t>(getpid());
+#else
+  return 0;
+#endif
+}
+
+// Buffer of the current thread, handed back to the tracer on thread exit
+struct ThreadState {
+  uint32_t tid = _threadId();
+  uint64_t generation = 0;
+  std::shared_ptr<void> buffer;
+  std::atomic<bool> *owned = nullptr;
+  bool realtime = false;
+
+  ~ThreadState() {
+    if (owned) owned->store(false, std::memory_order_release);
+  }
+};
+thread_local ThreadState tl_state;
+
+void _escape(std::ostream &os, const char *text) {
+  for (const char *c = text; *c; c++) {
+    if (*c == '"' || *c == '\\') {
+      os << '\\' << *c;
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      char code[7];
+      std::snprintf(code, sizeof(code), "\\u%04x",
+                    static_cast<unsigned char>(*c));
+      os << code;
+    } else {
+      os << *c;
+    }
+  }
+}
+}  // namespace
+
+Tracer &Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+int64_t Tracer::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::enable(size_t buffer_size) {
+  if (buffer_size == 0) {
+    throw std::invalid_argument("Trace buffers must hold at least one event.");
+  }
+  std::lock_guard<std::mutex> lock(mux_);
+  buffer_size_ = buffer_size;
+  buffers_.clear();
+  generation_++;
+  enabled_ = true;
+}
+
+void Tracer::disable() { enabled_ = false; }
+
+size_t Tracer::getBufferSize() const {
+  std::lock_guard<std::mutex> lock(mux_);
+  return buffer_size_;
+}
+
+void Tracer::clear() {
+  std::lock_guard<std::mutex> lock(mux_);
+  buffers_.clear();
+  generation_++;
+}
+
+Tracer::Stats Tracer::getStats() const {
+  std::lock_guard<std::mutex> lock(mux_);
+  Stats stats;
+  stats.buffers = buffers_.size();
+  for (const auto &buffer : buffers_) {
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t size = buffer->events.size();
+    stats.events += std::min(head, size);
+    stats.overwritten += head > size ? head - size : 0;
+  }
+  return stats;
+}
+
+Tracer::Buffer *Tracer::_buffer() {
+  ThreadState &state = tl_state;
+  const uint64_t generation = generation_.load(std::memory_order_acquire);
+  if (state.generation == generation) {
+    return static_cast<Buffer *>(state.buffer.get());
+  }
+  // Acquiring may allocate and wait for the lock
+  if (state.realtime) return nullptr;
+  return _acquire();
+}
+
+Tracer::Buffer *Tracer::_acquire() {
+  ThreadState &state = tl_state;
+  if (state.owned) state.owned->store(false, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(mux_);
+  // Take over the buffer of a finished thread before allocating a new one
+  std::shared_ptr<Buffer> buffer;
+  for (const auto &candidate : buffers_) {
+    bool owned = false;
+    if (candidate->owned.compare_exchange_strong(owned, true)) {
+      buffer = candidate;
+      break;
+    }
+  }
+  if (!buffer) {
+    buffer = std::make_shared<Buffer>(buffer_size_);
+    buffers_.push_back(buffer);
+  }
+  state.buffer = buffer;
+  state.owned = &buffer->owned;
+  state.generation = generation_.load(std::memory_order_relaxed);
+  return buffer.get();
+}
+
+void Tracer::_write(const char *category, const char *name, int64_t start,
+                    int64_t duration) {
+  Buffer *buffer = _buffer();
+  if (!buffer) return;
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  buffer->events[head % buffer->events.size()] = {category, name, start,
+                                                  duration, tl_state.tid};
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::record(const char *category, const char *name, int64_t start,
+                    int64_t end) {
+  if (!isEnabled()) return;
+  _write(category, name, start, end - start);
+}
+
+void Tracer::instant(const char *category, const char *name) {
+  if (!isEnabled()) return;
+  _write(category, name, now(), -1);
+}
+
+void Tracer::setThreadName(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mux_);
+  thread_names_[tl_state.tid] = name;
+}
+
+void Tracer::prepareRealTimeThread() {
+  tl_state.realtime = true;
+  if (isEnabled() &&
+      tl_state.generation != generation_.load(std::memory_order_acquire)) {
+    _acquire();
+  }
+}
+
+const char *Tracer::intern(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mux_);
+  return names_.insert(name).first->c_str();
+}
+
+std::string Tracer::exportJson() const {
+  std::ostringstream os;
+  _export(os);
+  return os.str();
+}
+
+size_t Tracer::save(const std::string &path) const {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Can't open " + path + " for writing.");
+  }
+  const size_t count = _export(file);
+  if (!file) {
+    throw std::runtime_error("Failed to write the trace to " + path + ".");
+  }
+  return count;
+}
+
+size_t Tracer::_export(std::ostream &os) const {
+  std::vector<Event> events;
+  std::map<uint32_t, std::string> thread_names;
+  {
+    std::lock_guard<std::mutex> lock(mux_);
+    thread_names = thread_names_;
+    for (const auto &buffer : buffers_) {
+      const uint64_t size = buffer->events.size();
+      auto first = [size](uint64_t head) {
+        return head > size ? head - size : 0;
+      };
+      const uint64_t head = buffer->head.load(std::memory_order_acquire);
+      std::vector<Event> copy;
+      for (uint64_t i = first(head); i < head; i++) {
+        copy.push_back(buffer->events[i % size]);
+      }
+      // The owning thread may have overwritten the oldest events while they
+      // were copied, those are dropped
+      const uint64_t end = buffer->head.load(std::memory_order_acquire);
+      const uint64_t valid = std::min(head, std::max(first(head), first(end)));
+      events.insert(events.end(), copy.begin() + (valid - first(head)),
+                    copy.end());
+    }
+  }
+  // Enclosing events first, as some viewers expect
+  std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+    return a.start < b.start || (a.start == b.start && a.duration > b.duration);
+  });
+
+  const uint32_t pid = _processId();
+  const int64_t origin = events.empty() ? 0 : events.front().start;
+  const auto flags = os.flags();
+  const auto precision = os.precision(3);
+  os << std::fixed << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  os << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+     << ",\"tid\":0,\"args\":{\"name\":\"panda-py\"}}";
+  for (const auto &entry : thread_names) {
+    os << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+       << ",\"tid\":" << entry.first << ",\"args\":{\"name\":\"";
+    _escape(os, entry.second.c_str());
+    os << "\"}}";
+  }
+  for (const auto &event : events) {
+    os << ",\n{\"name\":\"";
+    _escape(os, event.name);
+    os << "\",\"cat\":\"";
+    _escape(os, event.category);
+    os << "\",\"pid\":" << pid << ",\"tid\":" << event.tid
+       << ",\"ts\":" << (event.start - origin) * 1e-3;
+    if (event.duration < 0) {
+      os << ",\"ph\":\"i\",\"s\":\"t\"}";
+    } else {
+      os << ",\"ph\":\"X\",\"dur\":" << event.duration * 1e-3 << "}";
+    }
+  }
+  os << "\n]}\n";
+  os.flags(flags);
+  os.precision(precision);
+  return events.size();
+}